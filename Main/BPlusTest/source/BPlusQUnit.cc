@@ -11,10 +11,54 @@
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_BPlusTreeReaderWriter.h"
+#include "MyDB_ConcurrentBPlusTree.h"
 #include "MyDB_Schema.h"
 #include "QUnit.h"
 #include "Sorting.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <new>
+#include <thread>
+#include <time.h>
+
+// every allocation in the program goes through here, so that the tests can count how many allocations an
+// operation does.  Every form of new and delete is replaced, so that all of them go to malloc () and free (); they
+// are not inlined, since the compiler would then see free () called on what new returned, and warn about it
+static atomic <long> numAllocs (0);
+
+__attribute__ ((noinline)) void *operator new (size_t size) {
+	numAllocs++;
+	void *returnVal = malloc (size == 0 ? 1 : size);
+	if (returnVal == nullptr)
+		throw bad_alloc ();
+	return returnVal;
+}
+
+void *operator new [] (size_t size) {
+	return operator new (size);
+}
+
+__attribute__ ((noinline)) void operator delete (void *deleteMe) noexcept {
+	free (deleteMe);
+}
+
+void operator delete [] (void *deleteMe) noexcept {
+	operator delete (deleteMe);
+}
+
+void operator delete (void *deleteMe, size_t) noexcept {
+	operator delete (deleteMe);
+}
+
+void operator delete [] (void *deleteMe, size_t) noexcept {
+	operator delete (deleteMe);
+}
 
 int main () {
 
@@ -82,15 +126,725 @@ int main () {
 				else
 					myIter = supplierTable.getSortedRangeIteratorAlt (low, high);
 		
-				// verify we got exactly the correct count back
+				// verify we got exactly the correct count back (and that the sorted iterator is sorted)
 				int counter = 0;
+				int lastKey = -1;
+				bool sorted = true;
        		         	while (myIter->advance ()) {
        		                	myIter->getCurrent (temp);
+					if (i % 2 == 1 && temp->getAtt (0)->toInt () < lastKey)
+						sorted = false;
+					lastKey = temp->getAtt (0)->toInt ();
 					counter++;
        	         		}
+				QUNIT_IS_TRUE (sorted);
 	
        	         		QUNIT_IS_EQUAL (counter, 32 * (highBound - lowBound + 1));
+
+				// and a batch at a time should get the same records
+				if (i % 2 == 0) 
+					myIter = supplierTable.getRangeIteratorAlt (low, high);
+				else
+					myIter = supplierTable.getSortedRangeIteratorAlt (low, high);
+				MyDB_RecordBatch batch (myTable->getSchema (), {"suppkey"}, 100);
+				int batchCounter = 0;
+				bool inRange = true;
+				while (myIter->getNextBatch (batch)) {
+					const int64_t *keys = batch.getInts (0);
+					for (size_t j = 0; j < batch.size (); j++, batchCounter++) {
+						if (keys[j] < lowBound || keys[j] > highBound)
+							inRange = false;
+					}
+				}
+				QUNIT_IS_EQUAL (batchCounter, counter);
+				QUNIT_IS_TRUE (inRange);
+			}
+		}
+
+		// time some sorted range queries, each over 100 keys (3200 records)
+		clock_t start = clock ();
+		size_t total = 0;
+		srand48 (42);
+		for (int i = 0; i < 500; i++) {
+			int lowBound = 1 + lrand48 () % 9900;
+			MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+			low->set (lowBound);
+			MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+			high->set (lowBound + 99);
+			myIter = supplierTable.getSortedRangeIteratorAlt (low, high);
+			while (myIter->advance ()) {
+				myIter->getCurrent (temp);
+				total++;
+			}
+		}
+		cout << "500 sorted range queries: " << (double) (clock () - start) / CLOCKS_PER_SEC << "s\n";
+		QUNIT_IS_EQUAL (total, 500 * 32 * 100);
+
+		// point lookups, with the keys picked uniformly, and from a Zipfian distribution (where a few keys get
+		// most of the lookups); going down the tree once and reading the 32 matches off of the leaf is compared
+		// with asking for a range that only has the one key
+		{
+			// the i^th most popular key is looked up with probability proportional to 1 / i^0.99, and the popular
+			// keys are scattered through the tree
+			vector <double> cdf;
+			double sum = 0;
+			vector <int> keyOfRank;
+			for (int i = 0; i < 10000; i++) {
+				sum += 1.0 / pow (i + 1, 0.99);
+				cdf.push_back (sum);
+				keyOfRank.push_back (i);
+			}
+			srand48 (44);
+			for (int i = 9999; i > 0; i--)
+				swap (keyOfRank[i], keyOfRank[lrand48 () % (i + 1)]);
+
+			MyDB_IntAttValPtr key = make_shared <MyDB_IntAttVal> ();
+			vector <MyDB_RecordPtr> found;
+			for (string dist : {"uniform", "Zipfian"}) {
+				vector <int> keys;
+				for (int i = 0; i < 20000; i++) {
+					if (dist == "uniform")
+						keys.push_back (lrand48 () % 10000);
+					else
+						keys.push_back (keyOfRank[lower_bound (cdf.begin (), cdf.end (), drand48 () * sum) - cdf.begin ()]);
+				}
+
+				clock_t start = clock ();
+				size_t rangeTotal = 0;
+				for (int k : keys) {
+					key->set (k);
+					myIter = supplierTable.getRangeIteratorAlt (key, key);
+					while (myIter->advance ()) {
+						myIter->getCurrent (temp);
+						rangeTotal++;
+					}
+				}
+				myIter = nullptr;
+				double rangeTime = (double) (clock () - start) / CLOCKS_PER_SEC;
+
+				start = clock ();
+				long before = numAllocs;
+				size_t lookupTotal = 0;
+				bool allMatch = true;
+				for (int k : keys) {
+					key->set (k);
+					size_t numFound = supplierTable.lookup (key, found);
+					for (size_t i = 0; i < numFound; i++)
+						allMatch = allMatch && found[i]->getAtt (0)->toInt () == k;
+					lookupTotal += numFound;
+				}
+				cout << "20000 " << dist << " point lookups: " << (double) (clock () - start) / CLOCKS_PER_SEC << "s (" <<
+					rangeTime << "s as ranges), " << (double) (numAllocs - before) / keys.size () << " allocations per lookup\n";
+				QUNIT_IS_EQUAL (lookupTotal, 20000 * 32);
+				QUNIT_IS_EQUAL (rangeTotal, lookupTotal);
+				QUNIT_IS_TRUE (allMatch);
+			}
+
+			key->set (4321);
+			QUNIT_IS_TRUE (supplierTable.contains (key));
+			QUNIT_IS_TRUE (supplierTable.lookup (key, temp));
+			QUNIT_IS_EQUAL (temp->getAtt (0)->toInt (), 4321);
+			for (int missing : {-1, 10000}) {
+				key->set (missing);
+				QUNIT_IS_TRUE (!supplierTable.contains (key));
+				QUNIT_IS_TRUE (!supplierTable.lookup (key, temp));
+				QUNIT_IS_EQUAL (supplierTable.lookup (key, found), 0);
+			}
+		}
+
+		// a range over the whole tree streams from leaf to leaf: lots of them can be open at once, each one only
+		// pins the leaf that it is on (and the next one, when reading ahead), and the first record comes right away
+		{
+			MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+			low->set (0);
+			MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+			high->set (20000);
+			size_t numUnpinned = myMgr->getNumUnpinnedPages ();
+			clock_t start = clock ();
+			vector <MyDB_RecordIteratorAltPtr> iters;
+			bool allStarted = true;
+			for (int i = 0; i < 50; i++) {
+				iters.push_back (supplierTable.getRangeIteratorAlt (low, high));
+				iters.back ()->setReadAhead (true);
+				allStarted = allStarted && iters.back ()->advance ();
+			}
+			cout << "first record from 50 full-range iterators: " << (double) (clock () - start) / CLOCKS_PER_SEC << "s\n";
+			QUNIT_IS_TRUE (allStarted);
+			QUNIT_IS_TRUE (numUnpinned - myMgr->getNumUnpinnedPages () <= 100);
+
+			// and one of them goes all the way through, in order
+			int counter = 1;
+			int lastKey = -1;
+			bool sorted = true;
+			do {
+				iters[0]->getCurrent (temp);
+				if (temp->getAtt (0)->toInt () < lastKey)
+					sorted = false;
+				lastKey = temp->getAtt (0)->toInt ();
+			} while (iters[0]->advance () && ++counter);
+			QUNIT_IS_EQUAL (counter, 320000);
+			QUNIT_IS_TRUE (sorted);
+			iters.clear ();
+			QUNIT_IS_EQUAL (myMgr->getNumUnpinnedPages (), numUnpinned);
+		}
+
+		// building a copy of the tree out of its own records (which come out sorted) packs the pages full
+		{
+			MyDB_IntAttValPtr low = make_shared <MyDB_IntAttVal> ();
+			low->set (0);
+			MyDB_IntAttValPtr high = make_shared <MyDB_IntAttVal> ();
+			high->set (20000);
+			MyDB_TablePtr copyTable = make_shared <MyDB_Table> ("supplierCopy", "supplierCopy.bin", mySchema);
+			MyDB_BPlusTreeReaderWriter supplierCopy ("suppkey", copyTable, myMgr);
+			clock_t start = clock ();
+			supplierCopy.bulkLoad (supplierTable.getRangeIteratorAlt (low, high));
+			cout << "bulk load of " << supplierTable.getNumPages () << " page tree: " << supplierCopy.getNumPages () <<
+				" pages, " << (double) (clock () - start) / CLOCKS_PER_SEC << "s\n";
+			QUNIT_IS_TRUE (supplierCopy.getNumPages () < supplierTable.getNumPages ());
+
+			int counter = 0;
+			int lastKey = -1;
+			bool sorted = true;
+			myIter = supplierCopy.getRangeIteratorAlt (low, high);
+			while (myIter->advance ()) {
+				myIter->getCurrent (temp);
+				if (temp->getAtt (0)->toInt () < lastKey)
+					sorted = false;
+				lastKey = temp->getAtt (0)->toInt ();
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, 320000);
+			QUNIT_IS_TRUE (sorted);
+
+			low->set (4321);
+			high->set (4330);
+			counter = 0;
+			myIter = supplierCopy.getRangeIteratorAlt (low, high);
+			while (myIter->advance ())
+				counter++;
+			QUNIT_IS_EQUAL (counter, 320);
+			myIter = nullptr;
+		}
+	}
+
+	{
+		// a tree on small pages (so that it has a few levels of directory pages) over keys of each type, inserted in
+		// random order; every range query is checked against looking through all of the records
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (2048, 16, "tempFile");
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		// get all of the records, and shuffle them
+		vector <string> lines;
+		ifstream myFile ("supplier.tbl");
+		string line;
+		while (getline (myFile, line))
+			lines.push_back (line);
+		srand48 (41);
+		for (size_t i = lines.size () - 1; i > 0; i--)
+			swap (lines[i], lines[lrand48 () % (i + 1)]);
+
+		// the same records in a plain table, for bulk loading
+		MyDB_TablePtr shuffledTable = make_shared <MyDB_Table> ("supplierShuffled", "supplierShuffled.bin", mySchema);
+		MyDB_TableReaderWriter shuffled (shuffledTable, myMgr);
+		shuffledTable->setLastPage (0);
+		shuffled[0].clear ();
+		MyDB_RecordPtr shuffledRec = shuffled.getEmptyRecord ();
+		for (string &line : lines) {
+			shuffledRec->fromString (line);
+			shuffled.append (shuffledRec);
+		}
+
+		// each tree is built three ways: by inserting the records one at a time, by bulk loading them with room
+		// left on each page (and then inserting some more, which should fit without many splits), and by bulk
+		// loading them with the pages packed full
+		int insertedPages = 0;
+		for (string attName : {"address", "acctbal", "nationkey"}) for (int build = 0; build < 3; build++) {
+
+			MyDB_TablePtr myTable = make_shared <MyDB_Table> ("supplierTree", "supplierTree.bin", mySchema);
+			MyDB_BPlusTreeReaderWriter supplierTree (attName, myTable, myMgr);
+			int whichAtt = mySchema->getAttByName (attName).first;
+			MyDB_RecordPtr temp = supplierTree.getEmptyRecord ();
+			vector <MyDB_RecordPtr> allRecs;
+			if (build > 0)
+				supplierTree.bulkLoad (shuffled, build == 1 ? 0.7 : 1.0);
+			for (size_t i = 0; i < lines.size (); i++) {
+				if (build == 0 || (build == 1 && i < 500)) {
+					temp->fromString (lines[i]);
+					supplierTree.append (temp);
+					allRecs.push_back (supplierTree.getEmptyRecord ());
+					allRecs.back ()->fromString (lines[i]);
+				}
+				if (build > 0) {
+					allRecs.push_back (supplierTree.getEmptyRecord ());
+					allRecs.back ()->fromString (lines[i]);
+				}
+			}
+
+			// compares two values of the attribute
+			auto compare = [] (const MyDB_Value &lhs, const MyDB_Value &rhs) {
+				if (lhs.type == MyDB_ValueType :: StringVal)
+					return lhs.compareString (rhs);
+				return (lhs.toDouble () > rhs.toDouble ()) - (lhs.toDouble () < rhs.toDouble ());
+			};
+
+			bool allCorrect = true;
+			for (int i = 0; i < 100; i++) {
+
+				// use the keys of two random records as the bounds
+				MyDB_AttValPtr low = allRecs[lrand48 () % allRecs.size ()]->getAtt (whichAtt)->getCopy ();
+				MyDB_AttValPtr high = (i % 4 == 0) ? low : allRecs[lrand48 () % allRecs.size ()]->getAtt (whichAtt)->getCopy ();
+				MyDB_RecordPtr lowRec = supplierTree.getEmptyRecord (), highRec = supplierTree.getEmptyRecord ();
+				lowRec->getAtt (whichAtt)->set (low);
+				highRec->getAtt (whichAtt)->set (high);
+				if (compare (lowRec->getValue (whichAtt), highRec->getValue (whichAtt)) > 0) {
+					swap (low, high);
+					swap (lowRec, highRec);
+				}
+
+				int expected = 0;
+				for (MyDB_RecordPtr rec : allRecs) {
+					if (compare (rec->getValue (whichAtt), lowRec->getValue (whichAtt)) >= 0 &&
+						compare (rec->getValue (whichAtt), highRec->getValue (whichAtt)) <= 0)
+						expected++;
+				}
+
+				for (int sorted = 0; sorted < 2; sorted++) {
+					MyDB_RecordIteratorAltPtr myIter = sorted ? supplierTree.getSortedRangeIteratorAlt (low, high) :
+						supplierTree.getRangeIteratorAlt (low, high);
+					MyDB_RecordPtr last = supplierTree.getEmptyRecord ();
+					int counter = 0;
+					while (myIter->advance ()) {
+						myIter->getCurrent (temp);
+						if (sorted && counter > 0 && compare (last->getValue (whichAtt), temp->getValue (whichAtt)) > 0)
+							allCorrect = false;
+						myIter->getCurrent (last);
+						counter++;
+					}
+					if (counter != expected)
+						allCorrect = false;
+				}
+			}
+			cout << "small page tree on " << attName << (build == 0 ? " (inserted)" : build == 1 ? " (70% full, then inserts)" :
+				" (packed)") << ": " << supplierTree.getNumPages () << " pages\n";
+			QUNIT_IS_TRUE (allCorrect);
+			if (build == 0)
+				insertedPages = supplierTree.getNumPages ();
+			if (build == 2)
+				QUNIT_IS_TRUE (supplierTree.getNumPages () < insertedPages);
+
+			// there are only 25 different nation keys, and the records with each one fill up leaves one at a
+			// time, so inserting them one at a time packs them almost as tightly as bulk loading
+			if (build == 2 && attName == "nationkey")
+				QUNIT_IS_TRUE (insertedPages < supplierTree.getNumPages () * 11 / 10);
+		}
+
+		// on a string attribute, the keys in the directory are cut down to the shortest prefix that separates two
+		// leaves, so more of them fit on a directory page, and the tree is not as tall
+		for (string attName : {"name", "address", "phone", "comment"}) {
+			int height[2], numPages[2];
+			bool allFound = true;
+			int whichAtt = mySchema->getAttByName (attName).first;
+			for (int truncate = 0; truncate < 2; truncate++) {
+				MyDB_TablePtr myTable = make_shared <MyDB_Table> ("supplierTree", "supplierTree.bin", mySchema);
+				MyDB_BPlusTreeReaderWriter supplierTree (attName, myTable, myMgr);
+				supplierTree.setSuffixTruncation (truncate);
+				MyDB_RecordPtr temp = supplierTree.getEmptyRecord ();
+				for (string &line : lines) {
+					temp->fromString (line);
+					supplierTree.append (temp);
+				}
+				height[truncate] = supplierTree.getHeight ();
+				numPages[truncate] = supplierTree.getNumPages ();
+
+				// and every record can still be found
+				vector <MyDB_RecordPtr> found;
+				for (string &line : lines) {
+					temp->fromString (line);
+					size_t numFound = supplierTree.lookup (temp->getAtt (whichAtt), found);
+					allFound = allFound && numFound > 0;
+					for (size_t i = 0; i < numFound; i++)
+						allFound = allFound && found[i]->getAtt (whichAtt)->toString () == temp->getAtt (whichAtt)->toString ();
+				}
+			}
+			cout << "small page tree on " << attName << ": " << height[0] << " levels (" << numPages[0] << " pages) with whole keys, " <<
+				height[1] << " levels (" << numPages[1] << " pages) with shortened keys\n";
+			QUNIT_IS_TRUE (allFound);
+			QUNIT_IS_TRUE (height[1] <= height[0]);
+		}
+	}
+
+	{
+		// once a tree is in the buffer, inserting a record allocates nothing, unless it splits a page
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (8192, 1024, "tempFile");
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		for (string attName : {"suppkey", "name"}) {
+
+			MyDB_TablePtr myTable = make_shared <MyDB_Table> ("supplierTree", "supplierTree.bin", mySchema);
+			MyDB_BPlusTreeReaderWriter supplierTree (attName, myTable, myMgr);
+
+			// the records are set up (and serialized) ahead of time, so that only the inserts are counted
+			vector <MyDB_RecordPtr> recs;
+			ifstream myFile ("supplier.tbl");
+			string line;
+			while (getline (myFile, line)) {
+				recs.push_back (supplierTree.getEmptyRecord ());
+				recs.back ()->fromString (line);
+				recs.back ()->getBinarySize ();
+			}
+			srand48 (43);
+			for (size_t i = recs.size () - 1; i > 0; i--)
+				swap (recs[i], recs[lrand48 () % (i + 1)]);
+
+			// the first time through builds the tree; the second time through, every page is already there
+			for (MyDB_RecordPtr rec : recs)
+				supplierTree.append (rec);
+			long allocs = 0;
+			int numSplits = 0, numAllocating = 0;
+			clock_t start = clock ();
+			for (MyDB_RecordPtr rec : recs) {
+				int numPages = supplierTree.getNumPages ();
+				long before = numAllocs;
+				supplierTree.append (rec);
+				allocs += numAllocs - before;
+				if (supplierTree.getNumPages () != numPages)
+					numSplits++;
+				else if (numAllocs != before)
+					numAllocating++;
+			}
+			cout << recs.size () << " inserts on " << attName << ": " << (double) (clock () - start) / CLOCKS_PER_SEC <<
+				"s, " << (double) allocs / recs.size () << " allocations per insert (" << numSplits << " split a page)\n";
+			QUNIT_IS_EQUAL (numAllocating, 0);
+			QUNIT_IS_TRUE (numSplits < (int) recs.size () / 10);
+
+			// and looking up a key does not allocate either; every record is there twice
+			int whichAtt = mySchema->getAttByName (attName).first;
+			vector <MyDB_RecordPtr> found;
+			bool allFound = true;
+			supplierTree.lookup (recs[0]->getAtt (whichAtt), found);
+			long before = numAllocs;
+			start = clock ();
+			for (MyDB_RecordPtr rec : recs)
+				allFound = allFound && supplierTree.lookup (rec->getAtt (whichAtt), found) == 2;
+			double lookupTime = (double) (clock () - start) / CLOCKS_PER_SEC;
+			QUNIT_IS_TRUE (allFound);
+			QUNIT_IS_EQUAL (numAllocs - before, 0);
+
+			// compared with asking for a range with just the one key
+			start = clock ();
+			size_t rangeTotal = 0;
+			for (MyDB_RecordPtr rec : recs) {
+				MyDB_RecordIteratorAltPtr myIter = supplierTree.getRangeIteratorAlt (rec->getAtt (whichAtt),
+					rec->getAtt (whichAtt));
+				while (myIter->advance ()) {
+					myIter->getCurrent (found[0]);
+					rangeTotal++;
+				}
+			}
+			cout << recs.size () << " point lookups on " << attName << ": " << lookupTime << "s (" <<
+				(double) (clock () - start) / CLOCKS_PER_SEC << "s as ranges)\n";
+			QUNIT_IS_EQUAL (rangeTotal, 2 * recs.size ());
+		}
+	}
+
+	{
+		// a concurrent tree: threads look records up while other threads append them, and a record is always found
+		// once its append is done; this is done with small pages, so that there are lots of splits
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (2048, 4096, "tempFile");
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		for (string attName : {"suppkey", "name"}) {
+
+			MyDB_TablePtr myTable = make_shared <MyDB_Table> ("supplierTree", "supplierTree.bin", mySchema);
+			MyDB_ConcurrentBPlusTree supplierTree (attName, myTable, myMgr);
+			int whichAtt = mySchema->getAttByName (attName).first;
+
+			// every record has a different key; the first half go in before the threads start
+			vector <MyDB_RecordPtr> recs;
+			ifstream myFile ("supplier.tbl");
+			string line;
+			while (getline (myFile, line)) {
+				recs.push_back (supplierTree.getEmptyRecord ());
+				recs.back ()->fromString (line);
+				recs.back ()->getBinarySize ();
+			}
+			srand48 (49);
+			for (size_t i = recs.size () - 1; i > 0; i--)
+				swap (recs[i], recs[lrand48 () % (i + 1)]);
+			vector <atomic <bool>> appended (recs.size ());
+			for (size_t i = 0; i < recs.size () / 2; i++) {
+				supplierTree.append (recs[i]);
+				appended[i] = true;
+			}
+
+			// each writer appends every fourth one of the rest, while the readers look up random records; one that
+			// was appended before the lookup started has to be found, and anything that is found has to be right
+			atomic <int> numWriting (4), numLookups (0), numBad (0);
+			vector <thread> threads;
+			for (int t = 0; t < 4; t++) {
+				threads.push_back (thread ([&, t] {
+					for (size_t i = recs.size () / 2 + t; i < recs.size (); i += 4) {
+						supplierTree.append (recs[i]);
+						appended[i] = true;
+					}
+					numWriting--;
+				}));
+				threads.push_back (thread ([&, t] {
+					vector <MyDB_RecordPtr> found;
+					unsigned short seed[3] = {49, 0, (unsigned short) t};
+					while (numWriting > 0) {
+						size_t i = nrand48 (seed) % recs.size ();
+						bool wasAppended = appended[i];
+						size_t numFound = supplierTree.lookup (recs[i]->getAtt (whichAtt), found);
+						if (numFound > 1 || (wasAppended && numFound == 0) || (wasAppended &&
+							!supplierTree.contains (recs[i]->getAtt (whichAtt))))
+							numBad++;
+						else if (numFound == 1 && (found[0]->getAtt (0)->toInt () != recs[i]->getAtt (0)->toInt () ||
+							found[0]->getAtt (6)->toString () != recs[i]->getAtt (6)->toString ()))
+							numBad++;
+						numLookups++;
+					}
+				}));
+			}
+			for (thread &t : threads)
+				t.join ();
+			cout << "concurrent appends on " << attName << ": " << numLookups << " lookups while appending " <<
+				recs.size () / 2 << " records\n";
+			QUNIT_IS_EQUAL (numBad, 0);
+
+			// and now everything is there once, in order
+			bool allFound = true;
+			MyDB_RecordPtr temp = supplierTree.getEmptyRecord ();
+			for (MyDB_RecordPtr rec : recs)
+				allFound = allFound && supplierTree.lookup (rec->getAtt (whichAtt), temp) &&
+					temp->getAtt (0)->toInt () == rec->getAtt (0)->toInt ();
+			QUNIT_IS_TRUE (allFound);
+			MyDB_AttValPtr low, high;
+			if (attName == "suppkey") {
+				MyDB_IntAttValPtr lowInt = make_shared <MyDB_IntAttVal> (), highInt = make_shared <MyDB_IntAttVal> ();
+				lowInt->set (-1);
+				highInt->set (1000000);
+				low = lowInt;
+				high = highInt;
+			} else {
+				MyDB_StringAttValPtr lowString = make_shared <MyDB_StringAttVal> ();
+				MyDB_StringAttValPtr highString = make_shared <MyDB_StringAttVal> ();
+				lowString->set ("");
+				highString->set ("~");
+				low = lowString;
+				high = highString;
+			}
+			MyDB_RecordIteratorAltPtr myIter = supplierTree.getSortedRangeIteratorAlt (low, high);
+			MyDB_RecordPtr last = supplierTree.getEmptyRecord ();
+			int counter = 0;
+			bool sorted = true;
+			while (myIter->advance ()) {
+				myIter->getCurrent (temp);
+				if (counter++ > 0 && (attName == "suppkey" ? temp->getAtt (0)->toInt () <= last->getAtt (0)->toInt () :
+					temp->getAtt (1)->toString () <= last->getAtt (1)->toString ()))
+					sorted = false;
+				myIter->getCurrent (last);
+			}
+			QUNIT_IS_EQUAL (counter, (int) recs.size ());
+			QUNIT_IS_TRUE (sorted);
+		}
+	}
+
+	{
+		// throughput of a concurrent tree on a mix of point lookups and inserts, like the YCSB workloads: C is
+		// all lookups, B is 95% lookups, and A is half and half (with inserts rather than updates, which the tree
+		// does not have).  The keys that are looked up are Zipfian, and the inserts have new keys
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (4096, 8192, "tempFile");
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("key", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("value", make_shared <MyDB_StringAttType> ()));
+
+		// the i^th most popular key is looked up with probability proportional to 1 / i^0.99
+		int numKeys = 100000, numOps = 100000;
+		string value ("a value of twenty-odd bytes");
+		vector <double> cdf;
+		double sum = 0;
+		vector <int> keyOfRank;
+		for (int i = 0; i < numKeys; i++) {
+			sum += 1.0 / pow (i + 1, 0.99);
+			cdf.push_back (sum);
+			keyOfRank.push_back (i);
+		}
+		srand48 (49);
+		for (int i = numKeys - 1; i > 0; i--)
+			swap (keyOfRank[i], keyOfRank[lrand48 () % (i + 1)]);
+
+		for (int percentLookups : {100, 95, 50}) {
+
+			MyDB_TablePtr myTable = make_shared <MyDB_Table> ("ycsb", "ycsb.bin", mySchema);
+			MyDB_ConcurrentBPlusTree ycsbTree ("key", myTable, myMgr);
+			MyDB_RecordPtr rec = ycsbTree.getEmptyRecord ();
+			rec->getAtt (1)->fromString (value);
+			for (int i = 0; i < numKeys; i++) {
+				rec->getAtt (0)->fromInt (keyOfRank[i]);
+				rec->recordContentHasChanged ();
+				ycsbTree.append (rec);
+			}
+
+			atomic <int> nextKey (numKeys), numFound (0), numLookups (0);
+			for (int numThreads : {1, 2, 4}) {
+				vector <thread> threads;
+				auto start = chrono :: steady_clock :: now ();
+				for (int t = 0; t < numThreads; t++) {
+					threads.push_back (thread ([&, t] {
+						MyDB_RecordPtr myRec = ycsbTree.getEmptyRecord ();
+						string myValue = value;
+						myRec->getAtt (1)->fromString (myValue);
+						MyDB_IntAttValPtr key = make_shared <MyDB_IntAttVal> ();
+						unsigned short seed[3] = {49, (unsigned short) numThreads, (unsigned short) t};
+						for (int i = 0; i < numOps / numThreads; i++) {
+							if ((int) (nrand48 (seed) % 100) < percentLookups) {
+								double pick = erand48 (seed) * sum;
+								key->set (keyOfRank[lower_bound (cdf.begin (), cdf.end (), pick) - cdf.begin ()]);
+								numFound += ycsbTree.contains (key);
+								numLookups++;
+							} else {
+								myRec->getAtt (0)->fromInt (nextKey++);
+								myRec->recordContentHasChanged ();
+								ycsbTree.append (myRec);
+							}
+						}
+					}));
+				}
+				for (thread &t : threads)
+					t.join ();
+				double seconds = chrono :: duration <double> (chrono :: steady_clock :: now () - start).count ();
+				cout << percentLookups << "% lookups, " << numThreads << " thread(s): " << (int) (numOps / seconds) <<
+					" ops/s\n";
+			}
+			QUNIT_IS_EQUAL (numFound, numLookups);
+		}
+	}
+
+	{
+		// appending records in batches gives the same tree as appending them one at a time, in about as many pages;
+		// one big batch into an empty tree packs the leaves, since it all goes onto the end of the last leaf
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (2048, 1024, "tempFile");
+		MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+		mySchema->appendAtt (make_pair ("suppkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("name", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("address", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("nationkey", make_shared <MyDB_IntAttType> ()));
+		mySchema->appendAtt (make_pair ("phone", make_shared <MyDB_StringAttType> ()));
+		mySchema->appendAtt (make_pair ("acctbal", make_shared <MyDB_DoubleAttType> ()));
+		mySchema->appendAtt (make_pair ("comment", make_shared <MyDB_StringAttType> ()));
+
+		vector <string> lines;
+		ifstream myFile ("supplier.tbl");
+		string line;
+		while (getline (myFile, line))
+			lines.push_back (line);
+		srand48 (50);
+		for (size_t i = lines.size () - 1; i > 0; i--)
+			swap (lines[i], lines[lrand48 () % (i + 1)]);
+
+		auto compare = [] (const MyDB_Value &lhs, const MyDB_Value &rhs) {
+			if (lhs.type == MyDB_ValueType :: StringVal)
+				return lhs.compareString (rhs);
+			return (lhs.toDouble () > rhs.toDouble ()) - (lhs.toDouble () < rhs.toDouble ());
+		};
+
+		for (string attName : {"suppkey", "name", "nationkey"}) {
+
+			int whichAtt = mySchema->getAttByName (attName).first;
+			int numPages[3];
+			double seconds[3];
+			for (int build = 0; build < 3; build++) {
+
+				MyDB_TablePtr myTable = make_shared <MyDB_Table> ("supplierTree", "supplierTree.bin", mySchema);
+				MyDB_BPlusTreeReaderWriter supplierTree (attName, myTable, myMgr);
+				vector <MyDB_RecordPtr> recs;
+				map <string, int> numWithKey;
+				for (string &line : lines) {
+					recs.push_back (supplierTree.getEmptyRecord ());
+					recs.back ()->fromString (line);
+					recs.back ()->getBinarySize ();
+					numWithKey[recs.back ()->getAtt (whichAtt)->toString ()]++;
+				}
+
+				// one at a time, in batches of 500, and all at once
+				clock_t start = clock ();
+				if (build == 0) {
+					for (MyDB_RecordPtr rec : recs)
+						supplierTree.append (rec);
+				} else if (build == 1) {
+					for (size_t i = 0; i < recs.size (); i += 500) {
+						vector <MyDB_RecordPtr> batch (recs.begin () + i, recs.begin () + min (i + 500, recs.size ()));
+						supplierTree.appendBatch (batch);
+					}
+				} else {
+					supplierTree.appendBatch (recs);
+				}
+				seconds[build] = (double) (clock () - start) / CLOCKS_PER_SEC;
+				numPages[build] = supplierTree.getNumPages ();
+
+				// every record is found with the others that have its key
+				bool allCorrect = true;
+				vector <MyDB_RecordPtr> found;
+				for (MyDB_RecordPtr rec : recs) {
+					size_t numFound = supplierTree.lookup (rec->getAtt (whichAtt), found);
+					allCorrect = allCorrect && (int) numFound == numWithKey[rec->getAtt (whichAtt)->toString ()];
+					for (size_t i = 0; i < numFound; i++)
+						allCorrect = allCorrect && compare (found[i]->getValue (whichAtt), rec->getValue (whichAtt)) == 0;
+				}
+
+				// and a range over all of them has them all, in order
+				MyDB_RecordPtr low = recs[0], high = recs[0];
+				for (MyDB_RecordPtr rec : recs) {
+					if (compare (rec->getValue (whichAtt), low->getValue (whichAtt)) < 0)
+						low = rec;
+					if (compare (rec->getValue (whichAtt), high->getValue (whichAtt)) > 0)
+						high = rec;
+				}
+				MyDB_RecordIteratorAltPtr myIter = supplierTree.getRangeIteratorAlt (low->getAtt (whichAtt)->getCopy (),
+					high->getAtt (whichAtt)->getCopy ());
+				MyDB_RecordPtr temp = supplierTree.getEmptyRecord (), last = supplierTree.getEmptyRecord ();
+				int counter = 0;
+				while (myIter->advance ()) {
+					myIter->getCurrent (temp);
+					if (counter++ > 0 && compare (last->getValue (whichAtt), temp->getValue (whichAtt)) > 0)
+						allCorrect = false;
+					myIter->getCurrent (last);
+				}
+				QUNIT_IS_EQUAL (counter, (int) recs.size ());
+				QUNIT_IS_TRUE (allCorrect);
 			}
+			cout << "appends on " << attName << ": " << numPages[0] << " pages (" << seconds[0] << "s) one at a time, " <<
+				numPages[1] << " pages (" << seconds[1] << "s) in batches of 500, " << numPages[2] << " pages (" <<
+				seconds[2] << "s) in one batch\n";
+			QUNIT_IS_TRUE (numPages[1] < numPages[0] * 11 / 10);
+			QUNIT_IS_TRUE (numPages[2] < numPages[0]);
 		}
 	}
 }
@@ -13,22 +13,34 @@
 #ifndef BUFFER_MGR_H
 #define BUFFER_MGR_H
 
-#include "CheckLRU.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include "MyDB_Page.h"
 #include "MyDB_PageHandle.h"
 #include "MyDB_Table.h"
 #include "PageCompare.h"
+#include <mutex>
 #include <queue>
 #include "TableCompare.h"
 #include <set>
+#include <thread>
 
 using namespace std;
 
 class MyDB_BufferManager;
 typedef shared_ptr <MyDB_BufferManager> MyDB_BufferManagerPtr;
 
+// the most pages that flush () keeps pinned at once, while they are written back in the background
+#define MAX_FLUSHING 2
+
+// all of the methods here (and on the pages and page handles) can be called by several threads at
+// the same time.  But note that if a page is not pinned, its bytes can be kicked out of RAM by another
+// thread at any time, so threads that share a buffer manager should only touch the bytes of pinned pages
 class MyDB_BufferManager {
 
 public:
@@ -55,13 +67,46 @@ public:
 	// gets a temporary page, like getPage (), except that this one is pinned
 	MyDB_PageHandle getPinnedPage ();
 
-	// un-pins the specified page
+	// pins a page that we already have a handle to, reading it into RAM if need be
+	void pin (MyDB_PageHandle pinMe);
+
+	// un-pins the specified page... pins nest, so a page that has been pinned more than
+	// once (by getPinnedPage or pin) stays pinned until it has been un-pinned as many times
 	void unpin (MyDB_PageHandle unpinMe);
 
+	// starts reading the page into RAM in the background, and pins it, so that it is there when it
+	// is needed; anyone who wants the page's bytes before the read is done waits for it.  The caller
+	// has to un-pin the page once it is done with it.  Returns false (and does nothing) if there is no
+	// RAM for the page or asynchronous I/O is turned off
+	bool prefetch (MyDB_PageHandle readMe);
+
+	// if the page is dirty, starts writing it back in the background, so that it is already clean by
+	// the time that it is kicked out of RAM (it stays pinned until the write is done).  If MAX_FLUSHING
+	// pages are already being written, this does nothing, and the page is written when it is kicked out
+	void flush (MyDB_PageHandle writeMe);
+
+	// turns prefetch () and flush () on or off; they are on by default
+	void setAsyncIO (bool useIt);
+	bool getAsyncIO ();
+
+	// the number of times that prefetch () has pinned a page (whether or not it had to read it in)
+	size_t getNumPrefetched ();
+
+	// the total time, in seconds, that callers have spent waiting on the disk: either reading and
+	// writing pages themselves, or waiting for a read started by prefetch () to finish (the I/O done
+	// in the background does not count)
+	double getIOStallTime ();
+	void resetIOStallTime ();
+
 	// creates an LRU buffer manager... params are as follows:
 	// 1) the size of each page is pageSize 
 	// 2) the number of pages managed by the buffer manager is numPages;
 	// 3) temporary pages are written to the file tempFile
+	//
+	// the LRU order is approximate: a page that is used again while it is still among the numPages / 2 most
+	// recently brought in or moved pages is not moved to the most recently used end of the list (which is what
+	// lets getBytes () skip the lock for such a page).  So an unpinned page that is used over and over can be
+	// kicked out ahead of pages that were last used before its most recent use; pin a page to keep it around
 	MyDB_BufferManager (size_t pageSize, size_t numPages, string tempFile);
 	
 	// when the buffer manager is destroyed, all of the dirty pages need to be
@@ -70,11 +115,19 @@ public:
 
 	// returns the page size
 	size_t getPageSize ();
+
+	// returns the number of pages in the buffer
+	size_t getNumPages ();
+
+	// returns the number of pages in the buffer that are not pinned (that is, the number of pages
+	// that could be pinned right now)
+	size_t getNumUnpinnedPages ();
 	
 private:
 
-	// tells us the LRU number of each of the pages
-	set <MyDB_PageHandle, CheckLRU> lastUsed;
+	// the pages that are in RAM and not pinned, from the least recently used one to the most recently used
+	// one; each page knows where it is in the list, so moving a page to the end does not allocate anything
+	list <MyDB_PageHandle> lastUsed;
 
 	// list of ALL of the page objects that are currently in existence
 	map <pair <MyDB_TablePtr, size_t>, MyDB_PagePtr, PageCompare> allPages;
@@ -92,7 +145,7 @@ private:
 	size_t pageSize;
 
 	// the time tick associated with the MRU page
-	long lastTimeTick;
+	atomic <long> lastTimeTick;
 
 	// the last position in the temporary file
 	size_t lastTempPos;
@@ -103,6 +156,28 @@ private:
 	// the number of buffer pages
 	size_t numPages;
 
+	// this is held during every operation on the buffer; it is recursive, since creating and
+	// destroying handles (which the buffer manager does itself) goes through the lock as well
+	recursive_mutex myLock;
+
+	// the thread that does the background I/O (it is started the first time that it is needed), and
+	// the reads and writes that it has to do
+	thread ioThread;
+	deque <function <void ()>> ioTasks;
+	mutex ioTaskLock;
+	condition_variable ioTaskReady;
+	bool ioStop;
+	bool useAsyncIO;
+
+	// signalled (with myLock held) each time that a background read or write finishes, and the number
+	// of writes that are going on (their pages are pinned until they are done)
+	condition_variable_any ioFinished;
+	int numWriting;
+
+	// the total time spent waiting on the disk, in nanoseconds, and the number of pages prefetched
+	atomic <long long> stallNanos;
+	size_t numPrefetched;
+
 	// so that the page can access these private methods
 	friend class MyDB_Page;
 
@@ -112,9 +187,30 @@ private:
 	// process an access to the given page
 	void access (MyDB_Page &updateMe);
 
+	// puts the page at the most recently used end of the LRU list
+	void addToLRU (MyDB_PageHandle addMe);
+
+	// takes the page out of the LRU list, if it is there; the list's handle to the page is returned (or nullptr
+	// if it was not there), so that the page is not killed while the caller is still working on it
+	MyDB_PageHandle removeFromLRU (MyDB_Page &removeMe);
+
 	// removes all traces of the page from the buffer manager
 	void killPage (MyDB_Page &killMe);
 
+	// reads or writes a page's worth of bytes at the given position in the file; if isStall is true,
+	// the time is added to the stall time
+	void readBytes (int fd, size_t pos, void *bytes, bool isStall);
+	void writeBytes (int fd, size_t pos, void *bytes, bool isStall);
+
+	// if the page is being read in the background, waits for it; myLock must be held (once)
+	void waitForRead (MyDB_Page &waitForMe);
+
+	// waits for one of the background I/Os to finish; myLock must be held (once)
+	void waitForIO ();
+
+	// has the I/O thread run the function
+	void runInBackground (function <void ()> runMe);
+
 };
 
 #endif
@@ -12,6 +12,8 @@
 #ifndef PAGE_H
 #define PAGE_H
 
+#include <atomic>
+#include <list>
 #include <memory>
 #include "MyDB_Table.h"
 #include <string>
@@ -23,6 +25,7 @@ typedef shared_ptr <MyDB_Page> MyDB_PagePtr;
 
 // forward deifnition to handle circular dependencies
 class MyDB_BufferManager;
+class MyDB_PageHandleBase;
 
 class MyDB_Page {
 
@@ -60,10 +63,10 @@ private:
 
 	friend class MyDB_BufferManager;
 	friend class PageComp;
-	friend class CheckLRU;
 
-	// a pointer to the raw bytes
-	void *bytes;
+	// a pointer to the raw bytes... this, the time tick, and the pin count are atomic so that
+	// getBytes () can look at them without taking the buffer manager's lock
+	atomic <void *> bytes;
 
 	// the number of raw bytes available
 	size_t numBytes;
@@ -71,6 +74,9 @@ private:
 	// tells us if this page needs to be written back
 	bool isDirty;	
 
+	// true while the page is being read in the background (see MyDB_BufferManager :: prefetch)
+	bool isReading;
+
 	// pointer to the parent buffer manager
 	MyDB_BufferManager& parent;		
 
@@ -82,10 +88,17 @@ private:
 	size_t pos;
 
 	// this is the last time that the page had been accessed
-	long timeTick;
+	atomic <long> timeTick;
 
 	// the number of references
 	int refCount;
+
+	// the number of times the page has been pinned (and not un-pinned)
+	atomic <int> pinCount;
+
+	// true if the page is in the buffer manager's LRU list, and if so, where
+	bool inLRU;
+	list <shared_ptr <MyDB_PageHandleBase>> :: iterator lruPos;
 };
 
 #endif
@@ -64,7 +64,6 @@ private:
 		return page->getParent ();
 	}
 
-	friend class CheckLRU;
 	friend class MyDB_BufferManager;
 	MyDB_PagePtr page;
 };
@@ -13,6 +13,7 @@
 #ifndef BUFFER_MGR_C
 #define BUFFER_MGR_C
 
+#include <chrono>
 #include <fcntl.h>
 #include <iostream>
 #include "MyDB_BufferManager.h"
@@ -28,7 +29,18 @@ size_t MyDB_BufferManager :: getPageSize () {
 	return pageSize;
 }
 
+size_t MyDB_BufferManager :: getNumPages () {
+	return numPages;
+}
+
+size_t MyDB_BufferManager :: getNumUnpinnedPages () {
+	lock_guard <recursive_mutex> guard (myLock);
+	return availableRam.size () + lastUsed.size ();
+}
+
 MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i) {
+
+	lock_guard <recursive_mutex> guard (myLock);
 		
 	// open the file, if it is not open
 	if (fds.count (whichTable) == 0) {
@@ -58,6 +70,8 @@ MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i)
 
 MyDB_PageHandle MyDB_BufferManager :: getPage () {
 
+	lock_guard <recursive_mutex> guard (myLock);
+
 	// open the file, if it is not open
 	if (fds.count (nullptr) == 0) {
 		int fd = open (tempFile.c_str (), O_TRUNC | O_CREAT | O_RDWR, 0666);
@@ -80,20 +94,27 @@ MyDB_PageHandle MyDB_BufferManager :: getPage () {
 }
 
 void MyDB_BufferManager :: kickOutPage () {
+
+	// if every page is pinned, but some are only pinned while they are written in the background,
+	// wait for them
+	while (lastUsed.empty () && numWriting > 0)
+		waitForIO ();
 	
+	// if every page is pinned, there is nothing we can do
+	if (lastUsed.empty ())
+		return;
+
 	// find the oldest page
-	auto it = lastUsed.begin();
-	auto page = *it;
+	auto page = lastUsed.front ();
 
 	// write it back if necessary
 	if (page->page->isDirty) {
-		lseek (fds[page->page->myTable], page->page->pos * pageSize, SEEK_SET);
-		write (fds[page->page->myTable], page->page->bytes, pageSize);
+		writeBytes (fds[page->page->myTable], page->page->pos, page->page->bytes, true);
 		page->page->isDirty = false;
 	}
 
 	// remove it
-	lastUsed.erase (page);
+	removeFromLRU (*page->page);
 
 	// and remember its RAM
 	availableRam.push_back (page->page->bytes);
@@ -113,22 +134,17 @@ void MyDB_BufferManager :: killPage (MyDB_Page &killMe) {
 	// find the page
 	pair <MyDB_TablePtr, long> whichPage = make_pair (killMe.myTable, killMe.pos);
 	if (allPages.count (whichPage) != 0) {
-		auto myPtr = allPages[whichPage];
-
 		// special case is when there are no refs left to this page, but he is pinned
-		// in this case... we just unpin him
-		MyDB_PageHandle temp = make_shared <MyDB_PageHandleBase> (myPtr);
-		if (killMe.bytes != nullptr && lastUsed.count (temp) == 0) {
-			temp->page->incRefCount ();
-			unpin (temp);	
+		// in this case... we just unpin him (the LRU list's handle is his only reference)
+		if (killMe.bytes != nullptr && !killMe.inLRU) {
+			killMe.pinCount = 0;
+			killMe.refCount = 0;
+			addToLRU (make_shared <MyDB_PageHandleBase> (allPages[whichPage]));
 			return;
 		}
 
 		// kill from the LRU list, if needed
-		if (lastUsed.count (temp) != 0) {
-			auto page = *(lastUsed.find (temp));
-		       	lastUsed.erase (page);
-		}
+		removeFromLRU (killMe);
 
 		// kill from the list of all pages
 		auto page = allPages.find (whichPage);
@@ -137,8 +153,7 @@ void MyDB_BufferManager :: killPage (MyDB_Page &killMe) {
 
 	// if it is dirty, write it
 	if (killMe.isDirty) {
-		lseek (fds[killMe.myTable], killMe.pos * pageSize, SEEK_SET);
-		write (fds[killMe.myTable], killMe.bytes, pageSize);
+		writeBytes (fds[killMe.myTable], killMe.pos, killMe.bytes, true);
 		killMe.isDirty = false;
 	}
 
@@ -150,25 +165,26 @@ void MyDB_BufferManager :: killPage (MyDB_Page &killMe) {
 }
 
 void MyDB_BufferManager :: access (MyDB_Page &updateMeIn) {
+
+	// if the page is on its way in, wait for it
+	waitForRead (updateMeIn);
 	
 	// if this page was just accessed, get outta here
-	if (updateMeIn.timeTick > lastTimeTick - (numPages / 2) && updateMeIn.bytes != nullptr) {
+	if (updateMeIn.timeTick > lastTimeTick - (long) (numPages / 2) && updateMeIn.bytes != nullptr) {
 		return;
 	}
 
-	// get the page 
-	pair <MyDB_TablePtr, long> findMe = make_pair (updateMeIn.myTable, updateMeIn.pos);
-	auto updateMe = allPages [findMe];
-
-	// first, see if it is currently in the LRU list; if so, just remove it
-	MyDB_PageHandle temp = make_shared <MyDB_PageHandleBase> (updateMe);
-	if (lastUsed.count (temp) == 1) {
-		lastUsed.erase (temp);
-		updateMe->timeTick = ++lastTimeTick;
-		lastUsed.insert (temp);
+	// first, see if it is currently in the LRU list; if so, just move it to the end
+	if (updateMeIn.inLRU) {
+		lastUsed.splice (lastUsed.end (), lastUsed, updateMeIn.lruPos);
+		updateMeIn.timeTick = ++lastTimeTick;
 
 	// verify that we are not pinned
-	} else if (updateMe->bytes == nullptr) {
+	} else if (updateMeIn.bytes == nullptr) {
+
+		// get the page 
+		pair <MyDB_TablePtr, long> findMe = make_pair (updateMeIn.myTable, updateMeIn.pos);
+		auto updateMe = allPages [findMe];
 		
 		// not in the LRU list means that we don't have its contents buffered
 		// see if there is space
@@ -187,17 +203,31 @@ void MyDB_BufferManager :: access (MyDB_Page &updateMeIn) {
 		availableRam.pop_back ();
 
 		// and read it
-		lseek (fds[updateMe->myTable], updateMe->pos * pageSize, SEEK_SET);
-		read (fds[updateMe->myTable], updateMe->bytes, pageSize);
-
-		updateMe->timeTick = ++lastTimeTick;
-		lastUsed.insert (temp);
+		readBytes (fds[updateMe->myTable], updateMe->pos, updateMe->bytes, true);
+		addToLRU (make_shared <MyDB_PageHandleBase> (updateMe));
 	}
 
 }
 
+void MyDB_BufferManager :: addToLRU (MyDB_PageHandle addMe) {
+	addMe->page->timeTick = ++lastTimeTick;
+	addMe->page->lruPos = lastUsed.insert (lastUsed.end (), addMe);
+	addMe->page->inLRU = true;
+}
+
+MyDB_PageHandle MyDB_BufferManager :: removeFromLRU (MyDB_Page &removeMe) {
+	if (!removeMe.inLRU)
+		return nullptr;
+	MyDB_PageHandle returnVal = *removeMe.lruPos;
+	lastUsed.erase (removeMe.lruPos);
+	removeMe.inLRU = false;
+	return returnVal;
+}
+
 MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, long i) {
 
+	lock_guard <recursive_mutex> guard (myLock);
+
 	// open the file, if it is not open
 	if (fds.count (whichTable) == 0) {
 		int fd = open (whichTable->getStorageLoc ().c_str (), O_CREAT | O_RDWR, 0666);
@@ -215,25 +245,26 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, l
 	MyDB_PagePtr returnVal;
 
 	// see if we already know him
+	MyDB_PageHandle returnHandle;
 	if (allPages.count (whichPage) == 0) {
 
 		// in this case, we do not
 		returnVal = make_shared <MyDB_Page> (whichTable, i, *this);
 		allPages [whichPage] = returnVal;
+		returnHandle = make_shared <MyDB_PageHandleBase> (returnVal);
 
 	// in this case, we do
 	} else {
 
-		// get him out of the LRU list if he is there
+		// get him out of the LRU list if he is there; the handle that we return has to exist first, since
+		// otherwise the one in the LRU list might be his last reference, and he would be killed (and unpinned)
 		returnVal = allPages [whichPage];
-		auto temp = make_shared <MyDB_PageHandleBase> (returnVal);
-		if (lastUsed.count (temp) != 0) {
-			auto page = *(lastUsed.find (temp));
-	       		lastUsed.erase (page);
-		}
+		returnHandle = make_shared <MyDB_PageHandleBase> (returnVal);
+		removeFromLRU (*returnVal);
 	}
 
 	// see if we need to get his data
+	waitForRead (*returnVal);
 	if (returnVal->bytes == nullptr) {
 
 		// see if there is space to make a pinned page
@@ -251,17 +282,19 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, l
 		allPages [whichPage] = returnVal;
 
 		// and read it
-		lseek (fds[returnVal->myTable], returnVal->pos * pageSize, SEEK_SET);
-		read (fds[returnVal->myTable], returnVal->bytes, pageSize);
+		readBytes (fds[returnVal->myTable], returnVal->pos, returnVal->bytes, true);
 
 	}	
 
 	// get outta here
-	return make_shared <MyDB_PageHandleBase> (returnVal);
+	returnVal->pinCount++;
+	return returnHandle;
 }
 
 MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
 
+	lock_guard <recursive_mutex> guard (myLock);
+
 	// see if there is space to make a pinned page
 	if (availableRam.size () == 0)
 		kickOutPage ();
@@ -274,18 +307,181 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
 	MyDB_PageHandle returnVal = getPage ();
 	returnVal->page->bytes = availableRam[availableRam.size () - 1];
 	returnVal->page->numBytes = pageSize;
+	returnVal->page->pinCount = 1;
 	availableRam.pop_back ();
 
 	// and get outta here
 	return returnVal;
 }
 
+void MyDB_BufferManager :: pin (MyDB_PageHandle pinMe) {
+
+	lock_guard <recursive_mutex> guard (myLock);
+
+	// make sure that the page is in RAM, and then take it out of the LRU list
+	access (*pinMe->page);
+	removeFromLRU (*pinMe->page);
+	pinMe->page->pinCount++;
+}
+
 void MyDB_BufferManager :: unpin (MyDB_PageHandle unpinMe) {
-	if (lastUsed.count (unpinMe) != 1) {
-		lastUsed.erase (unpinMe);
-		unpinMe->page->timeTick = ++lastTimeTick;
-		lastUsed.insert (unpinMe);
+
+	lock_guard <recursive_mutex> guard (myLock);
+
+	// see if someone else still has it pinned
+	if (unpinMe->page->pinCount > 1) {
+		unpinMe->page->pinCount--;
+		return;
 	}
+	unpinMe->page->pinCount = 0;
+
+	if (!unpinMe->page->inLRU)
+		addToLRU (unpinMe);
+}
+
+bool MyDB_BufferManager :: prefetch (MyDB_PageHandle readMe) {
+
+	lock_guard <recursive_mutex> guard (myLock);
+	if (!useAsyncIO)
+		return false;
+
+	// if the page is already in RAM (or on its way), we just need to pin it
+	MyDB_Page &page = *readMe->page;
+	if (page.bytes != nullptr || page.isReading) {
+		removeFromLRU (page);
+		page.pinCount++;
+		numPrefetched++;
+		return true;
+	}
+
+	// get some RAM for it
+	if (availableRam.size () == 0)
+		kickOutPage ();
+	if (availableRam.size () == 0)
+		return false;
+	void *ram = availableRam[availableRam.size () - 1];
+	availableRam.pop_back ();
+
+	// and read it in the background; the page does not get its RAM until the read is done,
+	// so anyone who wants it in the meantime goes through access (), which waits
+	page.isReading = true;
+	page.pinCount++;
+	numPrefetched++;
+	int fd = fds[page.myTable];
+	size_t pos = page.pos;
+	runInBackground ([this, readMe, fd, pos, ram] () {
+		readBytes (fd, pos, ram, false);
+		lock_guard <recursive_mutex> guard (myLock);
+		readMe->page->bytes = ram;
+		readMe->page->numBytes = pageSize;
+		readMe->page->isReading = false;
+		ioFinished.notify_all ();
+	});
+	return true;
+}
+
+void MyDB_BufferManager :: flush (MyDB_PageHandle writeMe) {
+
+	lock_guard <recursive_mutex> guard (myLock);
+	MyDB_Page &page = *writeMe->page;
+	if (!useAsyncIO || !page.isDirty || page.bytes == nullptr || numWriting >= MAX_FLUSHING)
+		return;
+
+	// pin the page so that its RAM stays put until the write is done; if it is written to again
+	// in the meantime, it just becomes dirty again
+	removeFromLRU (page);
+	page.pinCount++;
+	page.isDirty = false;
+	numWriting++;
+	int fd = fds[page.myTable];
+	size_t pos = page.pos;
+	void *ram = page.bytes;
+	runInBackground ([this, writeMe, fd, pos, ram] () {
+		writeBytes (fd, pos, ram, false);
+		lock_guard <recursive_mutex> guard (myLock);
+		unpin (writeMe);
+		numWriting--;
+		ioFinished.notify_all ();
+	});
+}
+
+void MyDB_BufferManager :: setAsyncIO (bool useIt) {
+	lock_guard <recursive_mutex> guard (myLock);
+	useAsyncIO = useIt;
+}
+
+bool MyDB_BufferManager :: getAsyncIO () {
+	lock_guard <recursive_mutex> guard (myLock);
+	return useAsyncIO;
+}
+
+size_t MyDB_BufferManager :: getNumPrefetched () {
+	lock_guard <recursive_mutex> guard (myLock);
+	return numPrefetched;
+}
+
+double MyDB_BufferManager :: getIOStallTime () {
+	return stallNanos / 1e9;
+}
+
+void MyDB_BufferManager :: resetIOStallTime () {
+	stallNanos = 0;
+}
+
+void MyDB_BufferManager :: readBytes (int fd, size_t pos, void *bytes, bool isStall) {
+	auto start = chrono :: steady_clock :: now ();
+	pread (fd, bytes, pageSize, pos * pageSize);
+	if (isStall)
+		stallNanos += chrono :: duration_cast <chrono :: nanoseconds> (chrono :: steady_clock :: now () - start).count ();
+}
+
+void MyDB_BufferManager :: writeBytes (int fd, size_t pos, void *bytes, bool isStall) {
+	auto start = chrono :: steady_clock :: now ();
+	pwrite (fd, bytes, pageSize, pos * pageSize);
+	if (isStall)
+		stallNanos += chrono :: duration_cast <chrono :: nanoseconds> (chrono :: steady_clock :: now () - start).count ();
+}
+
+void MyDB_BufferManager :: waitForRead (MyDB_Page &waitForMe) {
+
+	if (!waitForMe.isReading)
+		return;
+
+	while (waitForMe.isReading)
+		waitForIO ();
+}
+
+void MyDB_BufferManager :: waitForIO () {
+
+	// this lets go of myLock while we wait, so that the I/O thread can finish up
+	auto start = chrono :: steady_clock :: now ();
+	ioFinished.wait (myLock);
+	stallNanos += chrono :: duration_cast <chrono :: nanoseconds> (chrono :: steady_clock :: now () - start).count ();
+}
+
+void MyDB_BufferManager :: runInBackground (function <void ()> runMe) {
+
+	lock_guard <mutex> guard (ioTaskLock);
+	ioTasks.push_back (runMe);
+	ioTaskReady.notify_one ();
+	if (ioThread.joinable ())
+		return;
+
+	// start up the I/O thread, which runs the tasks in order until it is told to stop
+	ioThread = thread ([this] () {
+		while (true) {
+			function <void ()> runMe;
+			{
+				unique_lock <mutex> guard (ioTaskLock);
+				ioTaskReady.wait (guard, [this] () {return ioStop || !ioTasks.empty ();});
+				if (ioTasks.empty ())
+					return;
+				runMe = ioTasks.front ();
+				ioTasks.pop_front ();
+			}
+			runMe ();
+		}
+	});
 }
 
 MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn, string tempFileIn) {
@@ -305,6 +501,13 @@ MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn,
 	// the number of pages
 	numPages = numPagesIn;
 
+	// no background I/O yet
+	ioStop = false;
+	useAsyncIO = true;
+	numWriting = 0;
+	stallNanos = 0;
+	numPrefetched = 0;
+
 	// create all of the RAM
 	for (size_t i = 0; i < numPages; i++) {
 		availableRam.push_back (malloc (pageSizeIn));
@@ -312,14 +515,23 @@ MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn,
 }
 
 MyDB_BufferManager :: ~MyDB_BufferManager () {
+
+	// let the background I/O finish up
+	if (ioThread.joinable ()) {
+		{
+			lock_guard <mutex> guard (ioTaskLock);
+			ioStop = true;
+		}
+		ioTaskReady.notify_one ();
+		ioThread.join ();
+	}
 	
 	// kill the list of all pages
 	map <pair <MyDB_TablePtr, size_t>, MyDB_PagePtr, PageCompare> empty;
 	allPages = empty;
 
 	// kill the LRU list	
-	set <MyDB_PageHandle, CheckLRU> emptyAgain;
-	lastUsed = emptyAgain;
+	lastUsed.clear ();
 
 	// delete the rest of the RAM
 	for (auto ram : availableRam) {
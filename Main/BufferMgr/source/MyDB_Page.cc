@@ -17,11 +17,20 @@
 #include "MyDB_Table.h"
 
 void *MyDB_Page :: getBytes () {
+
+	// if the page is pinned, or it was accessed so recently that the LRU list does not need to be
+	// updated (see MyDB_BufferManager :: access), then we can skip the lock
+	void *returnVal = bytes;
+	if (returnVal != nullptr && (pinCount > 0 || timeTick > parent.lastTimeTick - (long) (parent.numPages / 2)))
+		return returnVal;
+
+	lock_guard <recursive_mutex> guard (parent.myLock);
 	parent.access (*this);	
 	return bytes;
 }
 
 void MyDB_Page :: wroteBytes () {
+	lock_guard <recursive_mutex> guard (parent.myLock);
 	isDirty = true;
 }
 
@@ -31,11 +40,15 @@ MyDB_Page :: MyDB_Page (MyDB_TablePtr myTableIn, size_t iin, MyDB_BufferManager
 	parent (parentIn), myTable (myTableIn), pos (iin) { 
 	bytes = nullptr;
 	isDirty = false;	
+	isReading = false;
 	refCount = 0;
+	pinCount = 0;
 	timeTick = -1;
+	inLRU = false;
 }
 
 void MyDB_Page :: decRefCount () {
+	lock_guard <recursive_mutex> guard (parent.myLock);
 	refCount--;
 	if (refCount == 0) {
 		parent.killPage (*this);
@@ -43,6 +56,7 @@ void MyDB_Page :: decRefCount () {
 }
 
 void MyDB_Page :: incRefCount () {
+	lock_guard <recursive_mutex> guard (parent.myLock);
 	refCount++;
 }
 
@@ -9,6 +9,7 @@
 #include <cstring>
 #include <iostream>
 #include <time.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
@@ -21,6 +22,8 @@ int main (int numArgs, char **args) {
 	bool flag3 = true;
 	bool flag8 = true;
 	bool flag9 = true;
+	bool flag10 = true;
+	bool flag11 = true;
 	int which = 0;
 	if (numArgs == 2)
 		which = atoi (args[1]);
@@ -43,6 +46,10 @@ int main (int numArgs, char **args) {
 		goto Test7;
 	if (which == 8)
 		goto Test8;
+	if (which == 9)
+		goto Test9;
+	if (which == 10)
+		goto Test10;
 
 
 Test0:
@@ -303,6 +310,116 @@ Test8:
 	}
 	cout << "COMPLETE" << endl << flush;
 	QUNIT_IS_TRUE(flag9);
+
+Test9:
+	// several threads, and nested pins
+	cout << "TEST 10..." << flush;
+	{
+		cout << "create manager..." << flush;
+		MyDB_BufferManager myMgr(64, 16, "tempDSFSD");
+		MyDB_TablePtr table1 = make_shared <MyDB_Table>("table1", "file1");
+
+		cout << "write bytes..." << flush;
+		vector<thread> threads;
+		for (int t = 0; t < 4; t++) {
+			threads.emplace_back([&myMgr, table1, t] () {
+				for (int rep = 0; rep < 200; rep++) {
+					for (int i = t * 8; i < t * 8 + 8; i++) {
+						MyDB_PageHandle page = myMgr.getPage(table1, i);
+						myMgr.pin(page);
+						memset(page->getBytes(), (char)('A' + i), 64);
+						page->wroteBytes();
+						myMgr.unpin(page);
+					}
+				}
+			});
+		}
+		for (auto &t : threads)
+			t.join();
+
+		cout << "read bytes..." << flush;
+		for (int i = 0; i < 32; i++) {
+			char *bytes = (char *)myMgr.getPage(table1, i)->getBytes();
+			for (int j = 0; j < 64; j++) {
+				if (bytes[j] != (char)('A' + i)) flag10 = false;
+			}
+		}
+
+		cout << "pin twice..." << flush;
+		MyDB_PageHandle page = myMgr.getPinnedPage(table1, 0);
+		myMgr.pin(page);
+		myMgr.unpin(page);
+		char *bytes = (char *)page->getBytes();
+		vector<MyDB_PageHandle> others;
+		for (int i = 1; i < 32; i++) {
+			others.push_back(myMgr.getPage(table1, i));
+			others.back()->getBytes();
+		}
+		if (page->getBytes() != bytes || bytes[0] != 'A') flag10 = false;
+		cout << "shutdown manager..." << flush;
+	}
+	cout << "COMPLETE" << endl << flush;
+	QUNIT_IS_TRUE(flag10);
+
+Test10:
+	// background reads and writes
+	cout << "TEST 11..." << flush;
+	{
+		cout << "create manager..." << flush;
+		MyDB_BufferManager myMgr(64, 16, "tempDSFSD");
+		MyDB_TablePtr table1 = make_shared <MyDB_Table>("table1", "file1");
+
+		cout << "write and flush..." << flush;
+		for (int i = 0; i < 32; i++) {
+			MyDB_PageHandle page = myMgr.getPage(table1, i);
+			memset(page->getBytes(), (char)('a' + i), 64);
+			page->wroteBytes();
+			myMgr.flush(page);
+		}
+
+		cout << "prefetch..." << flush;
+		vector<MyDB_PageHandle> ahead;
+		vector<char *> where;
+		for (int i = 0; i < 8; i++) {
+			ahead.push_back(myMgr.getPage(table1, i));
+			if (!myMgr.prefetch(ahead.back())) flag11 = false;
+		}
+		for (int i = 0; i < 8; i++) {
+			char *bytes = (char *)ahead[i]->getBytes();
+			where.push_back(bytes);
+			for (int j = 0; j < 64; j++) {
+				if (bytes[j] != (char)('a' + i)) flag11 = false;
+			}
+		}
+
+		// the prefetched pages are pinned, so going through the other pages can't kick them out
+		for (int i = 8; i < 32; i++)
+			myMgr.getPage(table1, i)->getBytes();
+		for (int i = 0; i < 8; i++) {
+			if (ahead[i]->getBytes() != where[i]) flag11 = false;
+			myMgr.unpin(ahead[i]);
+		}
+
+		if (myMgr.getIOStallTime() < 0) flag11 = false;
+		myMgr.resetIOStallTime();
+		if (myMgr.getIOStallTime() != 0) flag11 = false;
+		myMgr.setAsyncIO(false);
+		if (myMgr.prefetch(ahead[0])) flag11 = false;
+		cout << "shutdown manager..." << flush;
+	}
+	{
+		cout << "read back..." << flush;
+		MyDB_BufferManager myMgr(64, 16, "tempDSFSD");
+		MyDB_TablePtr table1 = make_shared <MyDB_Table>("table1", "file1");
+		for (int i = 0; i < 32; i++) {
+			char *bytes = (char *)myMgr.getPage(table1, i)->getBytes();
+			for (int j = 0; j < 64; j++) {
+				if (bytes[j] != (char)('a' + i)) flag11 = false;
+			}
+		}
+	}
+	cout << "COMPLETE" << endl << flush;
+	QUNIT_IS_TRUE(flag11);
 }
 
 #endif
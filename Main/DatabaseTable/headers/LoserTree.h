@@ -0,0 +1,75 @@
+
+#ifndef LOSER_TREE_H
+#define LOSER_TREE_H
+
+#include <vector>
+
+using namespace std;
+
+// a tournament tree used to merge k sorted runs.  Each internal node remembers the run that lost the
+// game played there, and the overall winner is kept at the top.  Once the winner's run has moved on
+// to its next record, only the games on the path from that run's leaf to the top need to be replayed,
+// so getting the next record takes exactly log k comparisons (a heap needs about twice that).
+//
+// The runs are numbered 0 to k - 1, and lessThan (i, j) is true if the record at the head of run i
+// comes before the one at the head of run j; it is up to lessThan to make a run that is done lose
+// to everyone.  For example:
+//
+// LoserTree <decltype (cmp)> tree (numRuns, cmp);
+// while (!done[tree.top ()]) {
+//	size_t whichRun = tree.top ();
+//	... write out the head of whichRun and move to its next record ...
+//	tree.replay ();
+// }
+template <class LessThan>
+class LoserTree {
+
+public:
+
+	// sets up the tree, and plays all of the games
+	LoserTree (size_t numRunsIn, LessThan lessThanIn) : lessThan (lessThanIn) {
+		numRuns = numRunsIn;
+		tree.resize (numRuns == 0 ? 1 : numRuns, numRuns);
+		for (size_t i = 0; i < numRuns; i++)
+			play (i);
+	}
+
+	// the run whose head comes first
+	size_t top () {
+		return tree[0];
+	}
+
+	// call this after the run at the top has moved on to its next record
+	void replay () {
+		play (tree[0]);
+	}
+
+private:
+
+	// the leaf for run i is at numRuns + i, and its parent is at (numRuns + i) / 2, so the internal
+	// nodes are 1 to numRuns - 1; tree[0] is the winner
+	void play (size_t run) {
+		size_t winner = run;
+		for (size_t node = (run + numRuns) / 2; node > 0; node /= 2) {
+
+			// while building the tree, the first run to get to a node waits there for the other one
+			if (tree[node] == numRuns) {
+				tree[node] = winner;
+				return;
+			}
+
+			if (lessThan (tree[node], winner)) {
+				size_t temp = tree[node];
+				tree[node] = winner;
+				winner = temp;
+			}
+		}
+		tree[0] = winner;
+	}
+
+	size_t numRuns;
+	vector <size_t> tree;
+	LessThan lessThan;
+};
+
+#endif
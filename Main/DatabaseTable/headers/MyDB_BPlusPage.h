@@ -0,0 +1,127 @@
+
+#ifndef BPLUS_PAGE_H
+#define BPLUS_PAGE_H
+
+#include "MyDB_PageReaderWriter.h"
+#include "MyDB_Record.h"
+#include <stdint.h>
+
+using namespace std;
+
+// a page in a B+-Tree.  The records are written one after another from the start of the page, just like on
+// any other page (so getIteratorAlt () still works on it), but the end of the page holds an array of slots
+// that give the offset of each record, in key order:
+//
+// [type][bytes used][rec][rec]...[rec]        ...free space...        [slot 0][slot 1]...[slot n - 1][n][next page]
+//
+// so the records can be visited in order, and binary searched, without deserializing any of them, and putting
+// a record into the middle of the page only means moving the slots that come before it over by a few bytes.
+// Each page also knows the page to its right on the same level of the tree (the next page), so that a range
+// of leaves can be read by following the links.
+//
+// The bytes of the page are looked up once per call, so a pointer from getRec () is only good until some other
+// page is accessed (which might kick this one out of the buffer)
+class MyDB_BPlusPage {
+
+public:
+
+	// wraps up the page; the page is not changed
+	MyDB_BPlusPage (MyDB_PageReaderWriter pageIn);
+
+	// empties out the page, and sets its type; the page has no next page
+	void clear (MyDB_PageType toMe);
+
+	// the page to the right of this one on the same level of the tree, or -1 if this is the last one
+	int getNext ();
+	void setNext (int toMe);
+
+	// the underlying page (for pinning it, and so on)
+	MyDB_PageReaderWriter &getPage ();
+
+	// the type of the page
+	MyDB_PageType getType ();
+
+	// the number of records on the page
+	size_t getNumRecs ();
+
+	// the i^th record on the page, in key order
+	char *getRec (size_t i);
+
+	// for a reader that has not locked the page, so that another thread might be changing it (see
+	// MyDB_ConcurrentBPlusTree): the same as getNumRecs () and getRec (), except that they never look outside of
+	// the page, no matter what is on it.  getNumRecsChecked () is at most the number of slots that fit on the page,
+	// and getRecChecked () (which takes the number of records from getNumRecsChecked ()) returns nullptr if the
+	// slot does not point at a record that is all on the page.  Nothing that they return can be trusted until the
+	// reader has checked that the page did not change while it was reading it
+	size_t getNumRecsChecked ();
+	char *getRecChecked (size_t numRecs, size_t i);
+
+	// the number of bytes of the page that are in use, counting the records, their slots, and the stuff at the
+	// start and the end of the page
+	size_t getNumBytesUsed ();
+
+	// copies the record into the page, so that it becomes the i^th one in key order; returns false (and leaves
+	// the page alone) if there is not enough room on the page
+	bool insert (size_t i, MyDB_RecordPtr insertMe);
+	bool insertBinary (size_t i, void *insertMe);
+
+	// copies the record into the page after all of the others
+	bool append (MyDB_RecordPtr appendMe);
+	bool appendBinary (void *appendMe);
+
+	// the first of the first n records on the page whose key is not less than (lowerBound) or is greater than
+	// (upperBound) the one being searched for, or n if there is none.  compareTo (rec) must return a number that
+	// is less than, equal to, or greater than zero, as the key of the serialized record rec is less than, equal
+	// to, or greater than the one being searched for
+	template <class CompareTo>
+	size_t lowerBound (size_t n, CompareTo compareTo) {
+		return search (n, compareTo, 0);
+	}
+
+	template <class CompareTo>
+	size_t upperBound (size_t n, CompareTo compareTo) {
+		return search (n, compareTo, 1);
+	}
+
+private:
+
+	// what is at the very end of the page
+	struct MyDB_BPlusTrailer {
+		uint32_t numRecs;
+		int32_t nextPage;
+	};
+
+	inline MyDB_BPlusTrailer *getTrailer (char *bytes) {
+		return (MyDB_BPlusTrailer *) (bytes + pageSize - sizeof (MyDB_BPlusTrailer));
+	}
+
+	inline uint32_t *getSlots (char *bytes) {
+		MyDB_BPlusTrailer *trailer = getTrailer (bytes);
+		return ((uint32_t *) trailer) - trailer->numRecs;
+	}
+
+	// returns the first record where compareTo () returns a value of at least atLeast
+	template <class CompareTo>
+	size_t search (size_t n, CompareTo compareTo, int atLeast) {
+		char *bytes = (char *) page.getBytes ();
+		uint32_t *slots = getSlots (bytes);
+		size_t low = 0, high = n;
+		while (low < high) {
+			size_t mid = (low + high) / 2;
+			if (compareTo (bytes + slots[mid]) < atLeast)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	// makes room for a record of the given size, so that it is the i^th one; returns where to write it,
+	// or nullptr if there is no room
+	char *makeRoom (size_t i, size_t recSize);
+
+	MyDB_PageReaderWriter page;
+	size_t pageSize;
+};
+
+#endif
@@ -0,0 +1,80 @@
+
+#ifndef BPLUS_RANGE_ITER_ALT_H
+#define BPLUS_RANGE_ITER_ALT_H
+
+#include "MyDB_BPlusPage.h"
+#include "MyDB_INRecord.h"
+#include "MyDB_RecordIteratorAlt.h"
+#include "MyDB_PageReaderWriter.h"
+
+using namespace std;
+class MyDB_BPlusTreeReaderWriter;
+
+// iterates through the records in a B+-Tree that have keys in a range.  The leaves of the tree keep their
+// records in key order, so the records come out sorted, and only the first and the last record in the range
+// on each leaf have to be found (using a binary search); everything in between is just read off of the page.
+// The iterator starts at the leaf where the low key goes, and follows the links from each leaf to the next
+// one until it finds a key past the high one, so nothing is done up front, and only the leaf being read is
+// pinned (plus the next one, if it is being read ahead)
+class MyDB_BPlusRangeIteratorAlt : public MyDB_RecordIteratorAlt {
+
+public:
+
+        // load the current record into the parameter
+        void getCurrent (MyDB_RecordPtr intoMe) override;
+
+        // after a call to advance (), a call to getCurrentPointer () will get the address
+        // of the record.  At a later time, it is then possible to reconstitute the record
+        // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
+        // the record is located on has not been swapped out
+        void *getCurrentPointer () override;
+
+        // advance to the next record... returns true if there is a next record, and
+        // false if there are no more records to iterate over.  This does not need
+        // getCurrent () to have been called
+        bool advance () override;
+
+	// adds the remaining records in the range to the batch, until it is full
+	void appendToBatch (MyDB_RecordBatch &intoMe) override;
+
+	// keeps the next leaf being read in the background
+	void setReadAhead (bool readAhead) override;
+
+	// iterate through the records with keys in [low, high], starting with the given leaf of the tree
+	MyDB_BPlusRangeIteratorAlt (MyDB_BPlusTreeReaderWriter &treeIn, int firstLeaf, MyDB_INRecordPtr lowIn,
+		MyDB_INRecordPtr highIn);
+	~MyDB_BPlusRangeIteratorAlt ();
+
+private:
+
+	// moves on to the next leaf; returns false if there are no more
+	bool nextPage ();
+
+	// moves to the leaf (which the caller has pinned), and finds the records on it that are in the range
+	void startPage (MyDB_PageReaderWriter pinnedLeaf);
+
+	// starts reading the next leaf, if we should
+	void startReadAhead ();
+
+	MyDB_BPlusTreeReaderWriter &tree;
+
+	// the (pinned) leaf that we are on, and the one after it (-1 if there is none, or if the range ends on this leaf)
+	MyDB_BPlusPage page;
+	int nextLeaf;
+
+	// the bounds; the values are views into the records
+	MyDB_INRecordPtr lowRec, highRec;
+	MyDB_Value low, high;
+
+	// the record that we are on, and the range of records left on the leaf
+	size_t curSlot;
+	size_t nextSlot;
+	size_t endSlot;
+
+	// true if we read ahead, and the page that we have pinned to do it (nullptr if none)
+	bool readAhead;
+	MyDB_PageReaderWriterPtr aheadPage;
+	int aheadPageNum;
+};
+
+#endif
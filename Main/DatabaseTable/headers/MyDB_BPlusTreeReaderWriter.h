@@ -17,6 +17,7 @@
 // create a smart pointer for the catalog
 using namespace std;
 class MyDB_PageReaderWriter;
+class MyDB_BPlusPage;
 class MyDB_BPlusTreeReaderWriter;
 typedef shared_ptr <MyDB_BPlusTreeReaderWriter> MyDB_BPlusTreeReaderWriterPtr;
 
@@ -34,55 +35,205 @@ public:
 	
         // gets an instance of an alternate iterator over the table... this is an
         // iterator that has the alternate getCurrent ()/advance () interface... returned records must be sorted
-	// return all records with a key value in the range [low, high], inclusive
+	// return all records with a key value in the range [low, high], inclusive.  The leaves are always kept
+	// in key order, so this is now the same as getRangeIteratorAlt ()
         MyDB_RecordIteratorAltPtr getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high);
 	
-	// append a record to the B+-Tree
+	// returns true if there is a record with exactly the given key
+	bool contains (MyDB_AttValPtr key);
+
+	// finds the records with exactly the given key; they are loaded into the first n records in intoMe, and n is
+	// returned.  The vector is made bigger if need be, but never smaller, so that if the caller keeps using the
+	// same one, looking up a key allocates nothing.  Unlike a range iterator, this just goes down the tree once,
+	// and reads the matches right off of the leaf (and the ones after it, if the matches go past its end)
+	size_t lookup (MyDB_AttValPtr key, vector <MyDB_RecordPtr> &intoMe);
+
+	// the same, except only the first record with the key is loaded; returns false if there is none
+	bool lookup (MyDB_AttValPtr key, MyDB_RecordPtr intoMe);
+
+	// append a record to the B+-Tree; it goes into the leaves in key order.  Records with the same key are kept
+	// together, on as few leaves as possible, but not necessarily in the order that they were appended
 	void append (MyDB_RecordPtr appendMe);
 
+	// append a serialized record to the B+-Tree
+	void appendBinary (void *appendMe);
+
+	// append a batch of records to the B+-Tree.  They are sorted on the key first, and then go down the tree
+	// together, so that each page on the way is visited once for the whole batch, rather than once per record,
+	// and all of the records that go onto a leaf are put onto it at once.  If they do not fit, the leaf is split
+	// into as many pages as it takes, all at once (and so is a directory page that gets too many new entries)
+	void appendBatch (vector <MyDB_RecordPtr> &appendMe);
+
+	// builds the tree from scratch (anything that was in it is lost) out of records that are sorted on the key.
+	// Rather than inserting the records one at a time, the leaves are filled in order, and each level of directory
+	// pages is filled as the level below it gets new pages, so each page is written exactly once, in order.  Each
+	// page is filled until fillFactor of it is used: 1 packs the pages full, which is best for a tree that will only
+	// be read, while a smaller fill factor leaves room for inserts, so that they do not all cause splits
+	void bulkLoad (MyDB_RecordIteratorAltPtr sortedRecs, double fillFactor = 1.0);
+
+	// the same, except that the records come from the given table in any order, and are sorted first (using
+	// half of the buffer; see Sorting.h)
+	void bulkLoad (MyDB_TableReaderWriter &fromMe, double fillFactor = 1.0);
+
 	// print the contents of the tree to the screen
 	void printTree ();
 
+	// the number of levels in the tree, counting the leaves (0 if the tree is empty)
+	int getHeight ();
+
+	// when a leaf of a tree on a string attribute is split, the key that goes into the directory only has to
+	// fall between the largest key on the lower leaf and the smallest one on the upper leaf, so by default it
+	// is the shortest such string (ex: "Blan" for "Black Pine" and "Blanched Almond").  This keeps the directory
+	// entries short, so that more of them fit on a page, and the tree is not as tall.  This turns that off, so
+	// that the whole key is used, for pages that are split (or bulk loaded) from now on
+	void setSuffixTruncation (bool truncateKeys);
+
+	// access the i^th page in this file; this is just like the table's version, except that the tree hangs on
+	// to the object for each page, so that going through a page that has been seen before does not allocate
+	// anything (along with the buffer's LRU list, and the scratch space for splits, this means that an insert
+	// or a search that does not split a page or read one from disk does not allocate any memory at all)
+	MyDB_PageReaderWriter &operator [] (size_t i);
+
 private:
 
-	// gets a list of pages that might have data for an iterator... any leaf page that can possibly
-	// have a value in the range [low, high], inclusive should be returned from this call
-	bool discoverPages (int whichPage, vector <MyDB_PageReaderWriter> &list,
-        	MyDB_AttValPtr low, MyDB_AttValPtr high);
+	friend class MyDB_BPlusRangeIteratorAlt;
+	friend class MyDB_ConcurrentBPlusTree;
 
-	// appends a record to the named page; if there is a split, then an MyDB_INRecordPtr is returned that
-	// points to the record holding the (key, ptr) pair pointing to the new page.  Note that the new page
-	// always holds the lower 1/2 of the records on the page; the upper 1/2 remains in the original page
-	MyDB_RecordPtr append (int whichPage, MyDB_RecordPtr appendMe);
+	// finds the leaf where a record with the given key would go (if there are records with the key on several
+	// leaves, this is the first of them)
+	int findLeaf (const MyDB_Value &key);
+
+	// gets the key that is being looked up into the same type as the ones in the tree; a string is copied into
+	// scratch, since it might be a view into one of the records that the matches are loaded into
+	MyDB_Value getSearchKey (MyDB_AttValPtr key, string &scratch);
 
-	// splits the given page (plus the record andMe) around the median.  A MyDB_INRecordPtr is returned that
+	// calls forEach (rec) on each serialized record with exactly the given key, in order, until it returns false;
+	// rec is only good until forEach returns
+	template <class ForEach>
+	void forEachMatch (MyDB_AttValPtr key, ForEach forEach);
+
+	// does the work for bulkLoad (): forEachRec (addRec) has to call addRec on each serialized record, in order
+	void bulkLoad (function <void (function <void (void *)>)> forEachRec, double fillFactor);
+
+	// sets up the smallest B+-Tree there is, which has a root with one entry, pointing at an empty leaf
+	void makeEmpty ();
+
+	// when the root splits, a new root goes above it, with an entry for the old root (which now has the lower
+	// half of its records, and res has the key for them) and an entry for the new page
+	void newRoot (MyDB_INRecordPtr res);
+
+	// appends a record to the named page; if there is a split, then an MyDB_INRecordPtr is returned that
 	// points to the record holding the (key, ptr) pair pointing to the new page.  Note that the new page
-	// always holds the lower 1/2 of the records on the page; the upper 1/2 remains in the original page
-	MyDB_RecordPtr split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe);
+	// holds the upper part of the records on the page, and the key falls between them and the lower part
+	// (which remains in the original page); see split () for where the page is split, and what the key is
+	MyDB_INRecordPtr append (int whichPage, MyDB_RecordPtr appendMe);
+
+	// appends the n records (which are sorted on the key) to the subtree under the named page.  If the page
+	// has to be split into several pages, the entry for each of them but the last goes into newEntries, in
+	// order, and the last one (which is returned) takes over the page's entry in its parent
+	int appendBatch (int whichPage, MyDB_RecordPtr *recs, size_t n, vector <MyDB_INRecordPtr> &newEntries);
+
+	// puts each of the entries into the directory page, before the entry in the slot that goes with it (the
+	// entries for the same slot stay in order); returns the same thing as appendBatch ()
+	int addEntries (int whichPage, vector <pair <size_t, MyDB_INRecordPtr>> &toAdd,
+		vector <MyDB_INRecordPtr> &newEntries);
+
+	// spreads the serialized records in splitPositions (which are in order) over the named page and as many new
+	// pages after it as it takes; the pages are filled evenly, or if packFull is set, each one is filled up
+	// before going on to the next.  Returns the same thing as appendBatch ()
+	int spread (int whichPage, bool packFull, vector <MyDB_INRecordPtr> &newEntries);
+
+	// the slot of the subtree on the directory page that a record with the given key goes into
+	size_t findSubtree (MyDB_BPlusPage &dirPage, const MyDB_Value &key);
+
+	// splits the given page (plus the record andMe, which goes into whichSlot), and returns the same thing as
+	// append ().  A directory page is split around the median, and the key is the largest one that stays on
+	// the original page.  A leaf is split where pickLeafSplit () says, so that records with the same key stay
+	// together, and the key is set by setSeparator (): it is no smaller than the largest key on the original
+	// page, and no larger than the smallest one on the new page.  The new page goes after the original one in
+	// the list of pages on its level
+	MyDB_INRecordPtr split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe, size_t whichSlot);
 
 	// constructs and returns an empty internal node record for this particular tree
 	MyDB_INRecordPtr getINRecord ();
 
-	// gets the search key from a LN record
-	MyDB_AttValPtr getKey (MyDB_RecordPtr fromMe);
+	// decides where to split a leaf: the records that it had, plus the new one (which goes into whichSlot), are
+	// in splitPositions, and the first n stay on the old page, where n is returned.  room is the number of bytes
+	// on an empty page that records (and their slots) can go into
+	size_t pickLeafSplit (size_t whichSlot, bool isLastLeaf, size_t room);
+
+	// sets the key of the internal node record to the one to use for a leaf whose largest key is low, when the
+	// smallest key on the next leaf is high (see setSuffixTruncation ())
+	void setSeparator (MyDB_INRecordPtr toMe, const MyDB_Value &low, const MyDB_Value &high);
 
 	// recurive helper for printing the file
 	void printTree (int whichPage, int depth);
 
-	// constructs an returns a comparator for the two records given... both must either be IN records for this particular
-	// tree, or they must be LN records for this tree, or a combination.  The resulting comparator returns true if and
-	// only if the first record has a key value less than the second record
-	function <bool ()> buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
-
 	// the location (page number) of the root in the tree
 	int rootLocation;
 
+	// true if the keys in the directory are shortened (see setSuffixTruncation ())
+	bool truncateKeys;
+
+	// the objects for the pages that have been accessed, by page number (see operator [])
+	vector <shared_ptr <MyDB_PageReaderWriter>> pages;
+
+	// scratch space for the key being looked up, when the tree is on a string attribute
+	string keyScratch;
+
+	// scratch space for split (): a copy of the page being split, the records in order, and the record that is
+	// returned (which is only good until the next split; the caller always uses it up before then)
+	vector <char> splitBytes;
+	vector <void *> splitPositions;
+	MyDB_INRecordPtr splitRec;
+
+	// scratch space for appendBatch (): the batch, sorted on the key
+	vector <MyDB_RecordPtr> batch;
+
 	// the type of the attribute that we are ordering on
 	MyDB_AttTypePtr orderingAttType;
 
 	// the number of the attribute that we are ordering on, in the data records
 	int whichAttIsOrdering;
 
+	// and its type
+	MyDB_ValueType keyType;
+
+	// compares two keys; returns a number that is less than, equal to, or greater than zero, just like memcmp
+	inline int compareKeys (const MyDB_Value &lhs, const MyDB_Value &rhs) {
+		switch (keyType) {
+			case MyDB_ValueType :: IntVal: return (lhs.intVal > rhs.intVal) - (lhs.intVal < rhs.intVal);
+			case MyDB_ValueType :: DoubleVal: return (lhs.doubleVal > rhs.doubleVal) - (lhs.doubleVal < rhs.doubleVal);
+			default: return lhs.compareString (rhs);
+		}
+	}
+
+	// get the key and the page number out of a serialized internal node record, without deserializing it
+	inline MyDB_Value getINKey (char *rec) {
+		return MyDB_Value :: fromBinary (keyType, rec + sizeof (short));
+	}
+
+	// the same, for the key of a serialized data record
+	inline MyDB_Value getDataKey (char *rec) {
+		char *att = rec + sizeof (short);
+		for (int i = 0; i < whichAttIsOrdering; i++)
+			att += *((short *) att);
+		return MyDB_Value :: fromBinary (keyType, att);
+	}
+
+	inline int getINPtr (char *rec) {
+		char *ptrAtt = rec + sizeof (short);
+		ptrAtt += *((short *) ptrAtt);
+		return *((int *) (ptrAtt + sizeof (short)));
+	}
+
+	// changes the page number in a serialized internal node record (the caller has to call wroteBytes ())
+	inline void setINPtr (char *rec, int toMe) {
+		char *ptrAtt = rec + sizeof (short);
+		ptrAtt += *((short *) ptrAtt);
+		*((int *) (ptrAtt + sizeof (short))) = toMe;
+	}
+
 };
 
 #endif
@@ -0,0 +1,160 @@
+
+#ifndef CONCURRENT_BPLUS_H
+#define CONCURRENT_BPLUS_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "MyDB_BPlusPage.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
+
+using namespace std;
+class MyDB_ConcurrentBPlusTree;
+typedef shared_ptr <MyDB_ConcurrentBPlusTree> MyDB_ConcurrentBPlusTreePtr;
+
+// a B+-Tree that any number of threads can look keys up in (with contains () and lookup ()) while other threads
+// are appending records to it.  It uses optimistic lock coupling: each page has a version number, which a writer
+// bumps when it is done changing the page.  Readers never lock anything; a reader notes the version of each page
+// when it gets to it, and checks that the version has not changed before it believes anything that it read off of
+// the page (and before it leaves a directory page for the child, so that the child is still the right one).  If it
+// has changed, the reader starts over at the root.  Writers lock only the pages that they change: an append that
+// fits on its leaf only locks the leaf, and one that does not locks the pages that split, plus the page above them
+// that gets the new entry.
+//
+// Since a reader might be reading a page while it is changed, the bytes of the pages cannot move, so every page in
+// the tree is pinned for as long as this object is around, and the whole tree has to fit in the buffer (along with
+// anything else that is using it).  Also, splits share the tree's scratch space, and the counter for new pages, so
+// only one happens at a time; appends that do not split, and lookups, do not wait on them (unless they are on the
+// pages that are being split).
+//
+// Everything else (range iterators, appendBatch (), bulkLoad (), printTree (), and so on) works just like it does
+// for any other tree, but only while no other thread is using the tree
+class MyDB_ConcurrentBPlusTree : public MyDB_BPlusTreeReaderWriter {
+
+public:
+
+	// create the tree; if the table is empty, the tree starts out empty
+	MyDB_ConcurrentBPlusTree (string nameOfAttToOrderOn, MyDB_TablePtr forMe, MyDB_BufferManagerPtr myBuffer);
+
+	// un-pins all of the pages
+	~MyDB_ConcurrentBPlusTree ();
+
+	// these are the same as for MyDB_BPlusTreeReaderWriter, except that they can be called by any number of
+	// threads at once (the vector or record that the matches go into cannot be shared by two threads, of course)
+	bool contains (MyDB_AttValPtr key);
+	size_t lookup (MyDB_AttValPtr key, vector <MyDB_RecordPtr> &intoMe);
+	bool lookup (MyDB_AttValPtr key, MyDB_RecordPtr intoMe);
+	void append (MyDB_RecordPtr appendMe);
+
+	// the same as for MyDB_BPlusTreeReaderWriter; no other thread can use the tree while these are running
+	void appendBatch (vector <MyDB_RecordPtr> &appendMe);
+	void bulkLoad (MyDB_RecordIteratorAltPtr sortedRecs, double fillFactor = 1.0);
+	void bulkLoad (MyDB_TableReaderWriter &fromMe, double fillFactor = 1.0);
+
+private:
+
+	// a page on the way down the tree, with the version that it had when we got to it, and (for a directory
+	// page) the number of bytes that are free on it, as of that version
+	struct MyDB_PathStep {
+		int whichPage;
+		uint64_t version;
+		size_t bytesFree;
+	};
+
+	// goes down the tree to the leaf where a record with the given key goes (forAppend is true), or the first one
+	// that can have records with the key (forAppend is false), just like MyDB_BPlusTreeReaderWriter does.  The pages
+	// on the way are put into path, with the leaf last.  Returns false if a page changed while we were on it, in
+	// which case the caller has to start over
+	bool descend (const MyDB_Value &key, bool forAppend, vector <MyDB_PathStep> &path);
+
+	// copies the serialized records with exactly the given key into matches, one after another (or just the first
+	// of them, if firstOnly is set), and returns the number of them; starts over as often as it has to
+	size_t findMatches (MyDB_AttValPtr key, bool firstOnly, vector <char> &matches);
+
+	// one try at findMatches (); returns false if a page changed while we were reading it
+	bool findMatches (const MyDB_Value &key, bool firstOnly, vector <char> &matches, size_t &numFound);
+
+	// one try at append (); returns false (without changing anything) if a page that has to be locked changed
+	// after we read it
+	bool append (MyDB_RecordPtr appendMe, const MyDB_Value &key, vector <MyDB_PathStep> &path);
+
+	// the first of the first n of the numRecs records on the page with a key of at least (atLeast = 0), or more
+	// than (atLeast = 1), the given one, for a page that is not locked (see getRecChecked ()); sets bad if one
+	// of the records did not make sense
+	size_t search (MyDB_BPlusPage &page, size_t numRecs, size_t n, bool isLeaf, const MyDB_Value &key,
+		int atLeast, bool &bad);
+
+	// gets the key of the i^th of the numRecs records on a page that is not locked; returns false if the record
+	// does not make sense
+	bool getKeyChecked (MyDB_BPlusPage &page, size_t numRecs, size_t i, bool isLeaf, MyDB_Value &key);
+
+	// the same, for the page number in the i^th record on a directory page that is not locked
+	bool getINPtrChecked (MyDB_BPlusPage &page, size_t numRecs, size_t i, int &ptr);
+
+	// the whichAtt^th attribute of a serialized record that came from getRecChecked (), if it is all in the record
+	// and has at least minSize bytes, or else nullptr
+	char *getAttChecked (char *rec, int whichAtt, size_t minSize);
+
+	// pins the given page, and adds it to the tree, so that readers can get to it
+	void addNode (int whichPage);
+
+	// adds any pages that are not in the tree yet, and sets the root and maxEntrySize
+	void addNodes ();
+
+	// the page with the given number, or nullptr if it is not in the tree (a reader might get a bad page number
+	// off of a page that is being changed)
+	inline MyDB_BPlusPage *getNode (int whichPage) {
+		if (whichPage < 0 || whichPage >= (int) nodes.size ())
+			return nullptr;
+		return nodes[whichPage].load (memory_order_acquire);
+	}
+
+	// waits until the page is not locked, and returns its version
+	inline uint64_t readLock (int whichPage) {
+		uint64_t version;
+		while ((version = versions[whichPage].load (memory_order_acquire)) & 1)
+			this_thread :: yield ();
+		return version;
+	}
+
+	// true if the page still has the given version, so everything that was read off of it since then is good
+	inline bool stillValid (int whichPage, uint64_t version) {
+		atomic_thread_fence (memory_order_acquire);
+		return versions[whichPage].load (memory_order_relaxed) == version;
+	}
+
+	// locks the page, if it still has the given version
+	inline bool tryLock (int whichPage, uint64_t version) {
+		return versions[whichPage].compare_exchange_strong (version, version + 1);
+	}
+
+	// unlocks the page, which gives it a new version
+	inline void unlock (int whichPage) {
+		versions[whichPage].fetch_add (1, memory_order_release);
+	}
+
+	// the version of each page, by page number; the low bit is set while the page is locked
+	vector <atomic <uint64_t>> versions;
+
+	// each page in the tree, by page number (nullptr for one that is not in the tree yet), and the objects that
+	// they point to, whose pages are all pinned
+	vector <atomic <MyDB_BPlusPage *>> nodes;
+	vector <unique_ptr <MyDB_BPlusPage>> pinnedNodes;
+
+	// the location of the root; when the root splits, this changes while the old root is locked
+	atomic <int> root;
+
+	// held while a page is split (after the pages that it changes are locked)
+	mutex splitLock;
+
+	// the most bytes that an entry that a split puts into a directory page can need (along with its slot): it is
+	// no bigger than the largest record that has been in the tree, plus the bytes for a page number.  A directory
+	// page with this much room can take one more entry without splitting
+	atomic <size_t> maxEntrySize;
+
+	// the bytes that a directory entry needs on top of the ones that its key needs
+	size_t entryOverhead;
+};
+
+#endif
@@ -35,10 +35,18 @@ public:
         void *getCurrentPointer () override;
 
         // advance to the next record... returns true if there is a next record, and
-        // false if there are no more records to iterate over.  Not that this cannot
-        // be called until after getCurrent () has been called
+        // false if there are no more records to iterate over.  This does not need
+        // getCurrent () to have been called
         bool advance () override;
 
+	// adds the remaining records on the pages to the batch, until it is full
+	void appendToBatch (MyDB_RecordBatch &intoMe) override;
+
+	// keeps the next page being read in the background; while it does, the current page is kept pinned
+	// too, so that the record from getCurrentPointer () stays put while lots of other pages go through
+	// the buffer (so this uses two pinned pages in all)
+	void setReadAhead (bool readAhead) override;
+
 	// destructor and contructor
 	MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUs);
 	~MyDB_PageListIteratorAlt ();
@@ -48,6 +56,18 @@ private:
 	MyDB_RecordIteratorAltPtr myIter;
 	vector <MyDB_PageReaderWriter> forUs;
 	int curPage;
+
+	// true if we read ahead, the page that we have pinned to do it (-1 if none), and whether we have the
+	// current page pinned
+	bool readAhead;
+	int aheadPage;
+	bool curPinned;
+
+	// moves on to the next page
+	void nextPage ();
+
+	// starts reading the page after the current one, if we should
+	void startReadAhead ();
 };
 
 #endif
@@ -17,6 +17,7 @@
 #include "MyDB_PageType.h"
 #include "MyDB_RecordIterator.h"
 #include "MyDB_RecordIteratorAlt.h"
+#include "MyDB_SortKey.h"
 #include "MyDB_TableReaderWriter.h"
 
 using namespace std;
@@ -36,6 +37,18 @@ public:
 	// constructor for an anonymous page
 	MyDB_PageReaderWriter (MyDB_BufferManager &parent);
 
+	// constructor for an anonymous page that can be pinned, if desired
+	MyDB_PageReaderWriter (bool pinned, MyDB_BufferManager &parent);
+
+	// pins and un-pins the page (see MyDB_BufferManager :: pin and unpin)
+	void pin ();
+	void unpin ();
+
+	// starts reading the page in (and pins it), or writing it back, in the background (see
+	// MyDB_BufferManager :: prefetch and flush)
+	bool prefetch ();
+	void flush ();
+
 	// empties out the contents of this page, so that it has no records in it
 	// the type of the page is set to MyDB_PageType :: RegularPage
 	void clear ();	
@@ -61,6 +74,10 @@ public:
 	// a nullptr
 	void *appendAndReturnLocation (MyDB_RecordPtr appendMe);
 
+	// appends a serialized record (such as one on another page) to this page by copying its
+	// bytes... return false if the append fails because there is not enough space on the page
+	bool appendBinary (void *appendMe);
+
 	// gets the type of this page... this is just a value from an ennumeration
 	// that is stored within the page
 	MyDB_PageType getType ();
@@ -71,18 +88,31 @@ public:
 	// sorts the contents of the page... the boolean lambda that is sent into
 	// this function must check to see if the contents of the record pointed to
 	// by lhs are less than the contens of the record pointed to by rhs... typically,
-	// this lambda would have been created via a call to buildRecordComparator
+	// this lambda would have been created via a call to buildRecordComparator (the
+	// version that takes a list of keys can sort on several attributes at once)
 	MyDB_PageReaderWriterPtr sort (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs);
 
 	// like the above, except that the sorting is done in place, on the page
 	void sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs);
 
+	// like the above two, except that the records are sorted on a normalized key; this is
+	// a lot faster, since the records are never deserialized (they are just copied)
+	MyDB_PageReaderWriterPtr sort (MyDB_SortKeyPtr key);
+	void sortInPlace (MyDB_SortKeyPtr key);
+
+	// appends the location of each of the records on the page to the list, in order; these
+	// are only good for as long as the page stays in RAM (that is, while it is pinned)
+	void getRecords (vector <void *> &appendToMe);
+
 	// returns the page size
 	size_t getPageSize ();
 
 	// returns the actual bytes
 	void *getBytes ();
 
+	// call this after changing the bytes returned by getBytes (), so that they get written back
+	void wroteBytes ();
+
 private:
 
 	// this is the page that we are messing with
@@ -31,10 +31,13 @@ public:
         void *getCurrentPointer ();
 
         // advance to the next record... returns true if there is a next record, and
-        // false if there are no more records to iterate over.  Not that this cannot
-        // be called until after getCurrent () has been called
+        // false if there are no more records to iterate over.  This does not need
+        // getCurrent () to have been called
         bool advance () override;
 
+	// adds the remaining records on the page to the batch, until it is full
+	void appendToBatch (MyDB_RecordBatch &intoMe) override;
+
 	// destructor and contructor
 	MyDB_PageRecIteratorAlt (MyDB_PageHandle myPageIn); 
 	~MyDB_PageRecIteratorAlt ();
@@ -4,6 +4,7 @@
 
 #include <memory>
 #include "MyDB_Record.h"
+#include "MyDB_RecordBatch.h"
 using namespace std;
 
 // This pure virtual class is used to iterate through the records in a page or file
@@ -27,10 +28,37 @@ public:
         virtual void *getCurrentPointer () = 0;
 	
 	// advance to the next record... returns true if there is a next record, and 
-	// false if there are no more records to iterate over.  Not that this cannot
-	// be called until after getCurrent () has been called
+	// false if there are no more records to iterate over.  This does not need
+	// getCurrent () to have been called, so a caller that just wants the bytes of
+	// each record can use advance () and getCurrentPointer ()
 	virtual bool advance () = 0;
 
+	// empties out the batch, and then fills it with as many of the remaining records as will
+	// fit, copying them straight off of the pages; returns false if there were no records left.
+	// The batch starts with the record after the one that advance () last moved to (or with the
+	// first record, if advance () has not been called), and after this, advance () moves to the
+	// record just past the end of the batch.  Typical use:
+	//
+	// MyDB_RecordBatch batch (myTable->getSchema (), {"suppkey", "acctbal"});
+	// while (myIter->getNextBatch (batch)) {
+	// 	const int64_t *keys = batch.getInts (0);
+	// 	...
+	// }
+	bool getNextBatch (MyDB_RecordBatch &intoMe) {
+		intoMe.clear ();
+		appendToBatch (intoMe);
+		return intoMe.size () > 0;
+	}
+
+	// like getNextBatch, except that the records are added to the end of the batch (until it
+	// is full), without emptying it out first
+	virtual void appendToBatch (MyDB_RecordBatch &intoMe) = 0;
+
+	// asks the iterator to keep the page after the current one being read in the background, so that
+	// the iterator does not have to wait for the disk when it gets there; this keeps one more page
+	// pinned.  Iterators over a single page (or that can't do this) just ignore it
+	virtual void setReadAhead (bool readAhead) {};
+
 	// destructor and contructor
 	MyDB_RecordIteratorAlt () {};
 	virtual ~MyDB_RecordIteratorAlt () {};
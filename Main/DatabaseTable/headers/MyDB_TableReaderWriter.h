@@ -39,6 +39,9 @@ public:
 	// append a record to the table
 	virtual void append (MyDB_RecordPtr appendMe);
 
+	// append a serialized record to the table by copying its bytes
+	virtual void appendBinary (void *appendMe);
+
 	// return an itrator over this table... each time returnVal->next () is
 	// called, the resulting record will be placed into the record pointed to
 	// by iterateIntoMe
@@ -71,6 +74,10 @@ public:
 	// get the number of pages in the file
 	int getNumPages ();
 
+	// makes whichPage the last page in the file, so that appends go onto it; this is for code that
+	// has written the pages after the last one itself (each of them has to have been cleared first)
+	void setLastPage (int whichPage);
+
 	// get access to the buffer manager	
 	MyDB_BufferManagerPtr getBufferMgr ();
 
@@ -17,6 +17,7 @@
 #include "MyDB_Record.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Table.h"
+#include <memory>
 
 class MyDB_TableRecIteratorAlt : public MyDB_RecordIteratorAlt {
 
@@ -32,10 +33,16 @@ public:
         void *getCurrentPointer ();
 
         // advance to the next record... returns true if there is a next record, and
-        // false if there are no more records to iterate over.  Not that this cannot
-        // be called until after getCurrent () has been called
+        // false if there are no more records to iterate over.  This does not need
+        // getCurrent () to have been called
         bool advance () override;
 
+	// adds the remaining records in the table to the batch, until it is full
+	void appendToBatch (MyDB_RecordBatch &intoMe) override;
+
+	// keeps the next page being read in the background
+	void setReadAhead (bool readAhead) override;
+
 	// destructor and contructor
 	MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn);
 	~MyDB_TableRecIteratorAlt ();
@@ -48,6 +55,17 @@ private:
 	int highPage;	
 	MyDB_TableReaderWriter &myParent;
 	MyDB_TablePtr myTable;
+
+	// true if we read ahead, and the page that we have pinned to do it (null if none)
+	bool readAhead;
+	shared_ptr <MyDB_PageReaderWriter> aheadPage;
+	int aheadPageNum;
+
+	// moves on to the next page
+	void nextPage ();
+
+	// starts reading the page after the current one, if we should
+	void startReadAhead ();
 };
 
 #endif
@@ -3,13 +3,19 @@
 #define SORTING_H
 
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_SortKey.h"
 #include "MyDB_TableRecIterator.h"
 #include "MyDB_TableRecIteratorAlt.h"
 #include "MyDB_TableReaderWriter.h"
 
 // performs a TPMMS of the table sortMe.  The results are written to sortIntoMe.  The run 
 // size for the first phase of the TPMMS is given by runSize.  Comarisons are performed 
-// using comparator, lhs, rhs
+// using comparator, lhs, rhs (to sort on several attributes, build comparator by passing a
+// list of keys to buildRecordComparator, rather than nesting the computations).  If the
+// whole table fits into the buffer (along with a few pages for the output), then there is
+// no TPMMS: all of the pages are pinned, pointers to the records are sorted, and the records
+// are written straight into sortIntoMe.  The sorts on keys below (except for the one using
+// several threads) do the same
 void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe,
         function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
 
@@ -27,4 +33,68 @@ vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB
 void mergeIntoFile (MyDB_TableReaderWriter &sortIntoMe, vector <MyDB_RecordIteratorAltPtr> &mergeUs,
         function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs);
 
+// these are the same as the above three, except that the records are ordered using a normalized sort
+// key (see MyDB_SortKey), rather than a comparator.  This is much faster, since the records never need
+// to be deserialized: each record's key is computed once when it is at the head of a run, the keys
+// are compared using memcmp, and the records are moved by copying their bytes.  Also, rather than
+// sorting each page and then merging, all of the runSize pages in a run are pinned and sorted at
+// once using MyDB_SortKey :: sort (), so there must be room for them in the buffer
+void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key);
+
+vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB_RecordIteratorAltPtr leftIter,
+        MyDB_RecordIteratorAltPtr rightIter, MyDB_SortKeyPtr key);
+
+
+// while it merges, this keeps the next page of each run being read in the background (if the buffer
+// has room for it; see MyDB_RecordIteratorAlt :: setReadAhead), and each page of sortIntoMe is written
+// back in the background as soon as it is full, so the merge rarely has to wait on the disk.  The time
+// that it does spend waiting is added to the buffer manager's stall time (MyDB_BufferManager ::
+// getIOStallTime)
+void mergeIntoFile (MyDB_TableReaderWriter &sortIntoMe, vector <MyDB_RecordIteratorAltPtr> &mergeUs, MyDB_SortKeyPtr key);
+
+// like the sort above, except that the work is done by up to numThreads threads.  The runs are sorted
+// and written by the threads at the same time, and then the final merge is split up by key range: keys
+// are sampled from each run to pick splitters, and each thread merges the records between two splitters
+// straight into its own pages of sortIntoMe.  The threads first count the records in their ranges (using
+// counts kept for each page of the runs), so that each one can be given enough pages, right after the
+// pages of the threads before it; a thread's last few pages may not be full.  Since the threads share
+// the buffer manager, every page that a thread is using has to be pinned (a run's worth of pages while
+// sorting, and one page per run while merging), so fewer threads are used if the buffer is too small
+void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key,
+	int numThreads);
+
+// sorts sortMe into sortIntoMe without the caller having to pick a run size: the sort uses at most
+// numFrames pages of the buffer (if sortMe fits in fewer than that, it is sorted all at once).  The
+// runs are made using replacement selection, which gives runs that are about twice as big as the
+// memory on random input (and much longer runs on input that is already partly sorted).  The runs
+// are then merged (numFrames - 1 - MAX_FLUSHING) / 2 at a time: each run gets a frame for the page
+// being read and one for the page being read ahead, and the rest of the frames are for the output,
+// and the output pages being written back in the background (if background I/O is turned off, there
+// is no read-ahead, so twice as many runs are merged at a time).  If there are more runs than that,
+// the smallest runs are merged first, using as many passes as needed
+void sort (MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key, int numFrames);
+
+// the same, using half of the buffer
+void sort (MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key);
+
+// the same as the sort using numFrames pages, except that the records are not written anywhere: each
+// one is handed to writeMe (in key order) as soon as the final merge gets to it, so that the caller
+// can do something else with them, such as building an index.  The record passed to writeMe is only
+// good until writeMe returns, and writeMe can use the pages of the buffer that the sort is not using
+void sort (MyDB_TableReaderWriter &sortMe, MyDB_SortKeyPtr key, int numFrames, function <void (void *)> writeMe);
+
+// the first phase of the above: uses replacement selection to write the records in sortMe into
+// sorted runs (each a list of anonymous pages), holding at most numFrames - 3 pages' worth of records.
+// The records are copied out of the buffer while they are held, and the memory used for their keys
+// and for keeping track of them counts against the budget too
+vector <vector <MyDB_PageReaderWriter>> makeRuns (MyDB_TableReaderWriter &sortMe, MyDB_SortKeyPtr key, int numFrames);
+
+// for ORDER BY ... LIMIT k: appends the first k records from topOfMe (in key order) to intoMe, in order.
+// Rather than sorting everything, this keeps the best k records seen so far in a heap, so each record
+// costs computing its key and (usually) one comparison against the worst of the k.  The k records are
+// held in RAM and nothing is written until the end, so this is for when k records fit in memory; for
+// anything bigger, sort and then take the first k.  Records with the same key come out in the order
+// that they were seen
+void topK (size_t k, MyDB_RecordIteratorAltPtr topOfMe, MyDB_TableReaderWriter &intoMe, MyDB_SortKeyPtr key);
+
 #endif
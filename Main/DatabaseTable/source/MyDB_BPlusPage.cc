@@ -0,0 +1,118 @@
+
+#ifndef BPLUS_PAGE_C
+#define BPLUS_PAGE_C
+
+#include "MyDB_BPlusPage.h"
+#include <string.h>
+
+#define PAGE_TYPE(bytes) *((MyDB_PageType *) (bytes))
+#define NUM_BYTES_USED(bytes) *((size_t *) ((bytes) + sizeof (size_t)))
+
+MyDB_BPlusPage :: MyDB_BPlusPage (MyDB_PageReaderWriter pageIn) : page (pageIn) {
+	pageSize = page.getPageSize ();
+}
+
+void MyDB_BPlusPage :: clear (MyDB_PageType toMe) {
+	page.clear ();
+	page.setType (toMe);
+	MyDB_BPlusTrailer *trailer = getTrailer ((char *) page.getBytes ());
+	trailer->numRecs = 0;
+	trailer->nextPage = -1;
+}
+
+int MyDB_BPlusPage :: getNext () {
+	return getTrailer ((char *) page.getBytes ())->nextPage;
+}
+
+void MyDB_BPlusPage :: setNext (int toMe) {
+	getTrailer ((char *) page.getBytes ())->nextPage = toMe;
+	page.wroteBytes ();
+}
+
+MyDB_PageReaderWriter &MyDB_BPlusPage :: getPage () {
+	return page;
+}
+
+MyDB_PageType MyDB_BPlusPage :: getType () {
+	return PAGE_TYPE ((char *) page.getBytes ());
+}
+
+size_t MyDB_BPlusPage :: getNumRecs () {
+	return getTrailer ((char *) page.getBytes ())->numRecs;
+}
+
+char *MyDB_BPlusPage :: getRec (size_t i) {
+	char *bytes = (char *) page.getBytes ();
+	return bytes + getSlots (bytes)[i];
+}
+
+size_t MyDB_BPlusPage :: getNumRecsChecked () {
+	size_t numRecs = getTrailer ((char *) page.getBytes ())->numRecs;
+	size_t maxRecs = (pageSize - 2 * sizeof (size_t) - sizeof (MyDB_BPlusTrailer)) / sizeof (uint32_t);
+	return numRecs < maxRecs ? numRecs : maxRecs;
+}
+
+char *MyDB_BPlusPage :: getRecChecked (size_t numRecs, size_t i) {
+
+	// the records all come after the type and the number of bytes used, and each starts with its size
+	char *bytes = (char *) page.getBytes ();
+	size_t offset = (((uint32_t *) getTrailer (bytes)) - numRecs)[i];
+	if (offset < 2 * sizeof (size_t) || offset + sizeof (short) > pageSize)
+		return nullptr;
+	size_t recSize = *((unsigned short *) (bytes + offset));
+	if (recSize < sizeof (short) || offset + recSize > pageSize)
+		return nullptr;
+	return bytes + offset;
+}
+
+size_t MyDB_BPlusPage :: getNumBytesUsed () {
+	char *bytes = (char *) page.getBytes ();
+	return NUM_BYTES_USED (bytes) + (bytes + pageSize - (char *) getSlots (bytes));
+}
+
+char *MyDB_BPlusPage :: makeRoom (size_t i, size_t recSize) {
+
+	char *bytes = (char *) page.getBytes ();
+	MyDB_BPlusTrailer *trailer = getTrailer (bytes);
+	uint32_t *slots = getSlots (bytes);
+
+	// see if there is room for the record and its slot
+	size_t used = NUM_BYTES_USED (bytes);
+	if (used + recSize + sizeof (uint32_t) > (size_t) (((char *) slots) - bytes))
+		return nullptr;
+
+	// the slots before the new one move down to make room for it
+	memmove (slots - 1, slots, i * sizeof (uint32_t));
+	slots[i - 1] = (uint32_t) used;
+	trailer->numRecs++;
+	NUM_BYTES_USED (bytes) = used + recSize;
+	page.wroteBytes ();
+	return bytes + used;
+}
+
+bool MyDB_BPlusPage :: insert (size_t i, MyDB_RecordPtr insertMe) {
+	char *where = makeRoom (i, insertMe->getBinarySize ());
+	if (where == nullptr)
+		return false;
+	insertMe->toBinary (where);
+	return true;
+}
+
+bool MyDB_BPlusPage :: insertBinary (size_t i, void *insertMe) {
+	size_t recSize = *((short *) insertMe);
+	char *where = makeRoom (i, recSize);
+	if (where == nullptr)
+		return false;
+	memcpy (where, insertMe, recSize);
+	return true;
+}
+
+bool MyDB_BPlusPage :: append (MyDB_RecordPtr appendMe) {
+	return insert (getNumRecs (), appendMe);
+}
+
+bool MyDB_BPlusPage :: appendBinary (void *appendMe) {
+	return insertBinary (getNumRecs (), appendMe);
+}
+
+#endif
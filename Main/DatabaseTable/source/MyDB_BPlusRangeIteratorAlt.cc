@@ -0,0 +1,93 @@
+
+#ifndef BPLUS_RANGE_ITER_ALT_C
+#define BPLUS_RANGE_ITER_ALT_C
+
+#include "MyDB_BPlusRangeIteratorAlt.h"
+#include "MyDB_BPlusTreeReaderWriter.h"
+
+void MyDB_BPlusRangeIteratorAlt :: getCurrent (MyDB_RecordPtr intoMe) {
+	intoMe->fromBinary (getCurrentPointer ());
+}
+
+void *MyDB_BPlusRangeIteratorAlt :: getCurrentPointer () {
+	return page.getRec (curSlot);
+}
+
+bool MyDB_BPlusRangeIteratorAlt :: advance () {
+	while (nextSlot == endSlot) {
+		if (!nextPage ())
+			return false;
+	}
+	curSlot = nextSlot++;
+	return true;
+}
+
+void MyDB_BPlusRangeIteratorAlt :: appendToBatch (MyDB_RecordBatch &intoMe) {
+	while (!intoMe.isFull () && advance ())
+		intoMe.appendBinary (getCurrentPointer ());
+}
+
+bool MyDB_BPlusRangeIteratorAlt :: nextPage () {
+
+	if (nextLeaf == -1)
+		return false;
+
+	// if we read the next leaf ahead, it is already pinned
+	page.getPage ().unpin ();
+	if (aheadPage != nullptr && aheadPageNum == nextLeaf) {
+		startPage (*aheadPage);
+		aheadPage = nullptr;
+	} else {
+		startPage (tree.getPinned (nextLeaf));
+	}
+	startReadAhead ();
+	return true;
+}
+
+void MyDB_BPlusRangeIteratorAlt :: startPage (MyDB_PageReaderWriter pinnedLeaf) {
+
+	page = MyDB_BPlusPage (pinnedLeaf);
+	size_t numRecs = page.getNumRecs ();
+	nextSlot = page.lowerBound (numRecs, [this] (char *rec) {return tree.compareKeys (tree.getDataKey (rec), low);});
+	endSlot = page.upperBound (numRecs, [this] (char *rec) {return tree.compareKeys (tree.getDataKey (rec), high);});
+	if (endSlot < nextSlot)
+		endSlot = nextSlot;
+
+	// if there is a record past the high key on this leaf, then this is the last one
+	nextLeaf = (endSlot < numRecs) ? -1 : page.getNext ();
+}
+
+void MyDB_BPlusRangeIteratorAlt :: startReadAhead () {
+	if (!readAhead || aheadPage != nullptr || nextLeaf == -1)
+		return;
+	aheadPage = make_shared <MyDB_PageReaderWriter> (tree, nextLeaf);
+	aheadPageNum = nextLeaf;
+	if (!aheadPage->prefetch ())
+		aheadPage = nullptr;
+}
+
+void MyDB_BPlusRangeIteratorAlt :: setReadAhead (bool readAheadIn) {
+	readAhead = readAheadIn;
+	startReadAhead ();
+}
+
+MyDB_BPlusRangeIteratorAlt :: MyDB_BPlusRangeIteratorAlt (MyDB_BPlusTreeReaderWriter &treeIn, int firstLeaf,
+	MyDB_INRecordPtr lowIn, MyDB_INRecordPtr highIn) : tree (treeIn), page (treeIn.getPinned (firstLeaf)) {
+
+	lowRec = lowIn;
+	highRec = highIn;
+	low = lowRec->getValue (0);
+	high = highRec->getValue (0);
+	readAhead = false;
+	aheadPage = nullptr;
+	curSlot = 0;
+	startPage (page.getPage ());
+}
+
+MyDB_BPlusRangeIteratorAlt :: ~MyDB_BPlusRangeIteratorAlt () {
+	page.getPage ().unpin ();
+	if (aheadPage != nullptr)
+		aheadPage->unpin ();
+}
+
+#endif
@@ -3,10 +3,12 @@
 #define BPLUS_C
 
 #include "MyDB_INRecord.h"
+#include "MyDB_BPlusPage.h"
+#include "MyDB_BPlusRangeIteratorAlt.h"
 #include "MyDB_BPlusTreeReaderWriter.h"
 #include "MyDB_PageReaderWriter.h"
-#include "MyDB_PageListIteratorSelfSortingAlt.h"
-#include "RecordComparator.h"
+#include "MyDB_SortKey.h"
+#include "Sorting.h"
 #include <algorithm>
 
 MyDB_BPlusTreeReaderWriter :: MyDB_BPlusTreeReaderWriter (string orderOnAttName, MyDB_TablePtr forMe, 
@@ -18,313 +20,730 @@ MyDB_BPlusTreeReaderWriter :: MyDB_BPlusTreeReaderWriter (string orderOnAttName,
 	// remember information about the ordering attribute
 	orderingAttType = res.second;
 	whichAttIsOrdering = res.first;
-}
-
-MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
-	// this is the list of pages that we need to iterate over
-	vector <MyDB_PageReaderWriter> list;
-
-	// fill up this list of pages
-	discoverPages (rootLocation, list, low, high);
+	keyType = orderingAttType->createAtt ()->getValueType ();
+	splitRec = getINRecord ();
+	truncateKeys = true;
+}
 
-	// for various comparisons
-	MyDB_RecordPtr lhs = getEmptyRecord ();
-	MyDB_RecordPtr rhs = getEmptyRecord ();
-	MyDB_RecordPtr myRec = getEmptyRecord ();
-	MyDB_INRecordPtr llow = getINRecord ();
-	llow->setKey (low);
-	MyDB_INRecordPtr hhigh = getINRecord ();
-	hhigh->setKey (high);
+MyDB_PageReaderWriter &MyDB_BPlusTreeReaderWriter :: operator [] (size_t i) {
+	if (i >= pages.size ())
+		pages.resize (i + 1);
+	if (pages[i] == nullptr)
+		pages[i] = make_shared <MyDB_PageReaderWriter> (MyDB_TableReaderWriter :: operator [] (i));
+	return *pages[i];
+}
 
-	// build the comparison functions
-	function <bool ()> comparator = buildComparator (lhs, rhs);
-	function <bool ()> lowComparator = buildComparator (myRec, llow);	
-	function <bool ()> highComparator = buildComparator (hhigh, myRec);	
+MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getSortedRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
-	// and build the iterator
-	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, lowComparator, highComparator, true);	
+	// the leaves are kept in order, so this is the same as the other one
+	return getRangeIteratorAlt (low, high);
 }
 
 MyDB_RecordIteratorAltPtr MyDB_BPlusTreeReaderWriter :: getRangeIteratorAlt (MyDB_AttValPtr low, MyDB_AttValPtr high) {
 
-	// this is the list of pages that we need to iterate over
-	vector <MyDB_PageReaderWriter> list;
-
-	// fill up this list of pages
-	discoverPages (rootLocation, list, low, high);
-
 	// for various comparisons
-	MyDB_RecordPtr lhs = getEmptyRecord ();
-	MyDB_RecordPtr rhs = getEmptyRecord ();
-	MyDB_RecordPtr myRec = getEmptyRecord ();
 	MyDB_INRecordPtr llow = getINRecord ();
 	llow->setKey (low);
 	MyDB_INRecordPtr hhigh = getINRecord ();
 	hhigh->setKey (high);
 
-	// build the comparison functions
-	function <bool ()> comparator = buildComparator (lhs, rhs);
-	function <bool ()> lowComparator = buildComparator (myRec, llow);	
-	function <bool ()> highComparator = buildComparator (hhigh, myRec);	
-
-	// and build the iterator
-	return make_shared <MyDB_PageListIteratorSelfSortingAlt> (list, lhs, rhs, comparator, myRec, lowComparator, highComparator, false);	
+	// the iterator starts at the leaf where the low key would go, and follows the links from there
+	return make_shared <MyDB_BPlusRangeIteratorAlt> (*this, findLeaf (llow->getValue (0)), llow, hhigh);
 }
 
+MyDB_Value MyDB_BPlusTreeReaderWriter :: getSearchKey (MyDB_AttValPtr keyIn, string &scratch) {
+	MyDB_Value key = keyIn->toValue ();
+	if (keyType == MyDB_ValueType :: IntVal)
+		return MyDB_Value :: makeInt (key.toInt ());
+	if (keyType == MyDB_ValueType :: DoubleVal)
+		return MyDB_Value :: makeDouble (key.toDouble ());
+	scratch.clear ();
+	key.appendTo (scratch);
+	return MyDB_Value :: makeString (scratch.data (), scratch.size ());
+}
 
-bool MyDB_BPlusTreeReaderWriter :: discoverPages (int whichPage, vector <MyDB_PageReaderWriter> &list,
-	MyDB_AttValPtr low, MyDB_AttValPtr high) {
-
-	// figure out the page to search
-	MyDB_PageReaderWriter pageToSearch = (*this)[whichPage];
+template <class ForEach>
+void MyDB_BPlusTreeReaderWriter :: forEachMatch (MyDB_AttValPtr keyIn, ForEach forEach) {
+
+	// the tree is empty
+	if (getNumPages () <= 1)
+		return;
+
+	MyDB_Value key = getSearchKey (keyIn, keyScratch);
+
+	// the matches start on the leaf where the key would go, and may run off of the end of it onto the next ones
+	int whichPage = findLeaf (key);
+	while (whichPage != -1) {
+		MyDB_BPlusPage leaf ((*this)[whichPage]);
+		size_t numRecs = leaf.getNumRecs ();
+		size_t first = leaf.lowerBound (numRecs, [&] (char *rec) {
+			return compareKeys (getDataKey (rec), key);
+		});
+		for (size_t i = first; i < numRecs; i++) {
+			char *rec = leaf.getRec (i);
+			if (compareKeys (getDataKey (rec), key) != 0 || !forEach (rec))
+				return;
+		}
+		whichPage = leaf.getNext ();
+	}
+}
 
-	// it is a regular page (data page)
-	if (pageToSearch.getType () == MyDB_PageType :: RegularPage) {
+bool MyDB_BPlusTreeReaderWriter :: contains (MyDB_AttValPtr key) {
+	bool found = false;
+	forEachMatch (key, [&] (char *) {
+		found = true;
+		return false;
+	});
+	return found;
+}
 
-		list.push_back (pageToSearch);
+size_t MyDB_BPlusTreeReaderWriter :: lookup (MyDB_AttValPtr key, vector <MyDB_RecordPtr> &intoMe) {
+	size_t numFound = 0;
+	forEachMatch (key, [&] (char *rec) {
+		if (numFound == intoMe.size ())
+			intoMe.push_back (getEmptyRecord ());
+		intoMe[numFound++]->fromBinary (rec);
 		return true;
-		
-	// we have an internal node, so find the subtrees to seach
-	} else {
+	});
+	return numFound;
+}
 
-		// iterate through the various subtrees
-		MyDB_RecordIteratorAltPtr temp = pageToSearch.getIteratorAlt ();
-
-		// set up all of the comparisons that we need
-		MyDB_INRecordPtr otherRec = getINRecord ();
-		MyDB_INRecordPtr llow = getINRecord ();
-		llow->setKey (low);
-		MyDB_INRecordPtr hhigh = getINRecord ();
-		hhigh->setKey (high);
-		function <bool ()> comparatorLow = buildComparator (otherRec, llow);
-		function <bool ()> comparatorHigh = buildComparator (hhigh, otherRec);
-
-		// if the low bound and the high bound are both engaged, then we are discovering records
-		bool lowEngaged = false;
-		bool highEngaged = true;
-		bool foundLeaf = false;
-		while (temp->advance ()) {
-			
-			temp->getCurrent (otherRec);
+bool MyDB_BPlusTreeReaderWriter :: lookup (MyDB_AttValPtr key, MyDB_RecordPtr intoMe) {
+	bool found = false;
+	forEachMatch (key, [&] (char *rec) {
+		intoMe->fromBinary (rec);
+		found = true;
+		return false;
+	});
+	return found;
+}
 
-			if (!comparatorLow ()) 
-				lowEngaged = true;
+int MyDB_BPlusTreeReaderWriter :: findLeaf (const MyDB_Value &key) {
 
-			// see if the new key is less than the key in the directory record
-			if (lowEngaged && highEngaged) {
-				if (foundLeaf) {
-					list.push_back ((*this)[otherRec->getPtr ()]);
-				} else {
-					foundLeaf = discoverPages (otherRec->getPtr (), list, low, high);	
-				}
-			}
+	// at each level, go to the first subtree whose key is not less than the one we are looking for; the subtrees
+	// before it only have smaller keys (the last key is always the largest)
+	int whichPage = rootLocation;
+	while (true) {
+		MyDB_BPlusPage page ((*this)[whichPage]);
+		if (page.getType () == MyDB_PageType :: RegularPage)
+			return whichPage;
 
-			if (comparatorHigh ())
-				highEngaged = false;
-		}
-		return false;
+		size_t whichSlot = page.lowerBound (page.getNumRecs () - 1, [&] (char *rec) {
+			return compareKeys (getINKey (rec), key);
+		});
+		whichPage = getINPtr (page.getRec (whichSlot));
 	}
-
-	// note, we should never get here
-	return false;
 }
 
 void MyDB_BPlusTreeReaderWriter :: append (MyDB_RecordPtr appendMe) {
 
 	// this file has never had any data in it, because the smallest B+-Tree has two pages
-	if (getNumPages () <= 1) {
-		
-		// the root is at page location zero
-		MyDB_PageReaderWriter root = (*this)[0];
-		rootLocation = 0;
-
-		// get an internal node record that has a pointer to page 1
-		MyDB_INRecordPtr internalNodeRec = getINRecord ();	
-		internalNodeRec->setPtr (1);
-		getTable ()->setLastPage (1);
-
-		// add that internal node record in
-		root.clear ();
-		root.append (internalNodeRec);
-		root.setType (MyDB_PageType :: DirectoryPage);
-		
-		// and add the new record to the leaf
-		MyDB_PageReaderWriter leaf = (*this)[1];
-		leaf.clear ();
-		leaf.setType (MyDB_PageType :: RegularPage);
-		leaf.append (appendMe);
+	if (getNumPages () <= 1)
+		makeEmpty ();
 
-	// this is a valid B+-Tree, so we can process the insert
-	} else {
+	// append the record into the tree, and see if the root split
+	auto res = append (rootLocation, appendMe);
+	if (res != nullptr)
+		newRoot (res);
+}
 
-		// append the record into the tree
-		auto res = append (rootLocation, appendMe);
+void MyDB_BPlusTreeReaderWriter :: makeEmpty () {
 		
-		// see if the root split
-		if (res != nullptr) {
+	// the root is at page location zero
+	MyDB_PageReaderWriter root = (*this)[0];
+	rootLocation = 0;
+
+	// get an internal node record that has a pointer to page 1
+	MyDB_INRecordPtr internalNodeRec = getINRecord ();	
+	internalNodeRec->setPtr (1);
+	getTable ()->setLastPage (1);
+
+	// add that internal node record in
+	MyDB_BPlusPage rootPage (root);
+	rootPage.clear (MyDB_PageType :: DirectoryPage);
+	rootPage.append (internalNodeRec);
+	
+	// and the leaf starts out empty
+	MyDB_BPlusPage leaf ((*this)[1]);
+	leaf.clear (MyDB_PageType :: RegularPage);
+}
+
+void MyDB_BPlusTreeReaderWriter :: newRoot (MyDB_INRecordPtr res) {
+
+	// add another page to the file
+	int newRootLoc = getTable ()->lastPage () + 1;
+	getTable ()->setLastPage (newRootLoc);
+	MyDB_BPlusPage newRoot ((*this)[newRootLoc]);
+	newRoot.clear (MyDB_PageType :: DirectoryPage);
+
+	// add the two records; the first points to the old root (which has the lower half of its
+	// records), the second to the newly-created page
+	int newPageLoc = res->getPtr ();
+	res->setPtr (rootLocation);
+	newRoot.append (res);
+	MyDB_INRecordPtr newRec = getINRecord ();
+	newRec->setPtr (newPageLoc);
+	newRoot.append (newRec);
+
+	// and update the location of the root
+	rootLocation = newRootLoc;
+}
+
+void MyDB_BPlusTreeReaderWriter :: appendBinary (void *appendMe) {
+	MyDB_RecordPtr temp = getEmptyRecord ();
+	temp->fromBinary (appendMe);
+	append (temp);
+}
+
+void MyDB_BPlusTreeReaderWriter :: bulkLoad (MyDB_RecordIteratorAltPtr sortedRecs, double fillFactor) {
+	bulkLoad ([&sortedRecs] (function <void (void *)> addRec) {
+		while (sortedRecs->advance ())
+			addRec (sortedRecs->getCurrentPointer ());
+	}, fillFactor);
+}
+
+void MyDB_BPlusTreeReaderWriter :: bulkLoad (MyDB_TableReaderWriter &fromMe, double fillFactor) {
+	MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (vector <MyDB_SortAtt> {{whichAttIsOrdering, keyType, true}});
+	bulkLoad ([&] (function <void (void *)> addRec) {
+		sort (fromMe, key, fromMe.getBufferMgr ()->getNumPages () / 2, addRec);
+	}, fillFactor);
+}
 
-			// add another page to the file
-			int newRootLoc = getTable ()->lastPage () + 1;
-			getTable ()->setLastPage (newRootLoc);
-			MyDB_PageReaderWriter newRoot = (*this)[newRootLoc];
-			newRoot.clear ();
-			newRoot.setType (MyDB_PageType :: DirectoryPage);
-
-			// add the two records; the first points to the newly-created page, the second to the old root
-			newRoot.append (res);
-			MyDB_INRecordPtr newRec = getINRecord ();
-			newRec->setPtr (rootLocation);
-			newRoot.append (newRec);
-
-			// and update the location of the root
-			rootLocation = newRootLoc;
+void MyDB_BPlusTreeReaderWriter :: bulkLoad (function <void (function <void (void *)>)> forEachRec, double fillFactor) {
+
+	// the page being filled on each level of the tree (the leaves are level 0), and where it is; the top level
+	// only ever has one page, which is the root
+	vector <MyDB_BPlusPage> levels;
+	vector <int> pageNums;
+	size_t fillTo = (size_t) (fillFactor * getBufferMgr ()->getPageSize ());
+	int numPages = 0;
+
+	// starts a new page on the given level; the page that was being filled there is linked to it and written out
+	auto startPage = [&] (size_t level) {
+		int pageNum = numPages++;
+		getTable ()->setLastPage (pageNum);
+		MyDB_BPlusPage newPage ((*this)[pageNum]);
+		newPage.clear (level == 0 ? MyDB_PageType :: RegularPage : MyDB_PageType :: DirectoryPage);
+		if (level == levels.size ()) {
+			levels.push_back (newPage);
+			pageNums.push_back (pageNum);
+		} else {
+			levels[level].setNext (pageNum);
+			levels[level].getPage ().flush ();
+			levels[level] = newPage;
+			pageNums[level] = pageNum;
+		}
+	};
+
+	// true if a record of the given size should go on a new page, rather than the one being filled
+	auto isFull = [&] (MyDB_BPlusPage &page, size_t recSize) {
+		return page.getNumRecs () > 0 && page.getNumBytesUsed () + recSize + sizeof (uint32_t) > fillTo;
+	};
+
+	// the entry for the page being filled on the given level, which goes on the level above; its key is the
+	// largest one on the page (or for a leaf, something between that and the key of the record that is going
+	// on the next leaf; see setSeparator ())
+	auto entryFor = [&] (size_t level, char *nextRec) {
+		MyDB_INRecordPtr entry = getINRecord ();
+		char *lastRec = levels[level].getRec (levels[level].getNumRecs () - 1);
+		if (level == 0) {
+			setSeparator (entry, getDataKey (lastRec), getDataKey (nextRec));
+		} else {
+			entry->fromBinary (lastRec);
+		}
+		entry->setPtr (pageNums[level]);
+		return entry;
+	};
+
+	// when the page on a level is full, its entry goes up a level, and we start a new one; adding the entry
+	// might fill up the page on the level above as well, and so on
+	function <void (size_t, char *)> nextPage;
+	auto addEntry = [&] (size_t level, MyDB_INRecordPtr entry) {
+		if (level == levels.size ())
+			startPage (level);
+		if (isFull (levels[level], entry->getBinarySize ()) || !levels[level].append (entry)) {
+			nextPage (level, nullptr);
+			levels[level].append (entry);
 		}
+	};
+	nextPage = [&] (size_t level, char *nextRec) {
+		addEntry (level + 1, entryFor (level, nextRec));
+		startPage (level);
+	};
+
+	// fill the leaves; the record might be on a page that is not pinned, which starting a new page could kick out
+	// of the buffer, so it is copied first
+	startPage (0);
+	vector <char> copy;
+	forEachRec ([&] (void *rec) {
+		if (isFull (levels[0], *((unsigned short *) rec)) || !levels[0].appendBinary (rec)) {
+			copy.assign ((char *) rec, ((char *) rec) + *((unsigned short *) rec));
+			nextPage (0, copy.data ());
+			levels[0].appendBinary (copy.data ());
+		}
+	});
+
+	// and finish off the last page on each level; its entry on the level above gets the largest possible key,
+	// just like the last entry on any directory page on the right edge of the tree.  There is always at least
+	// one directory page, even if there is only one leaf
+	for (size_t level = 0; level == 0 || level + 1 < levels.size (); level++) {
+		MyDB_INRecordPtr entry = getINRecord ();
+		entry->setPtr (pageNums[level]);
+		addEntry (level + 1, entry);
+		levels[level].getPage ().flush ();
 	}
+	levels.back ().getPage ().flush ();
+	rootLocation = pageNums.back ();
 }
 
-#define NUM_BYTES_USED *((size_t *) (((char *) temp) + sizeof (size_t)))
-
-MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe) {
+MyDB_INRecordPtr MyDB_BPlusTreeReaderWriter :: split (MyDB_PageReaderWriter splitMe, MyDB_RecordPtr andMe, size_t whichSlot) {
 	
-	// get a new page for the lower one half
+	// get a new page for the upper one half
 	int newPageLoc = getTable ()->lastPage () + 1;
 	getTable ()->setLastPage (newPageLoc);
 	MyDB_PageReaderWriter newPage = (*this)[newPageLoc];
 
 	// remember the type of this page so we can re-create it after the clear
-	MyDB_PageType myType;
-
-	// get a couple of records and a comparator so that we can sort
-	MyDB_RecordPtr lhs, rhs;
-	if (splitMe.getType () == MyDB_PageType :: RegularPage) {
-		lhs = getEmptyRecord ();
-		rhs = getEmptyRecord ();
-		myType = MyDB_PageType :: RegularPage;
-	} else if (splitMe.getType () == MyDB_PageType :: DirectoryPage) {
-		lhs = getINRecord ();
-		rhs = getINRecord ();
-		myType = MyDB_PageType :: DirectoryPage;
-	}
-	function <bool ()> comparator = buildComparator (lhs, rhs);	
-
-	// temp memory to hold all of the records
-	void *temp = malloc (splitMe.getPageSize ());
-	memcpy (temp, splitMe.getBytes (), splitMe.getPageSize ());
-
-	// positions of the records
-	vector <void *> positions;
-
-	// compute where all of the records are located
-	int bytesConsumed = sizeof (size_t) * 2;
-	while (bytesConsumed != NUM_BYTES_USED) {
-		void *pos = bytesConsumed + (char *) temp;
-		positions.push_back (pos);
-		void *nextPos = lhs->fromBinary (pos);
-		bytesConsumed += ((char *) nextPos) - ((char *) pos);
-	}
-	
-	// and get a postition for the last guy
-	void *spaceForLastGuy = malloc (andMe->getBinarySize ());
+	MyDB_PageType myType = splitMe.getType ();
+
+	// copy all of the records into the scratch space, with the new guy after them; this has to happen
+	// before returnVal is touched, since the new guy might be the record returned by a split of a child
+	size_t pageSize = splitMe.getPageSize ();
+	size_t newSize = andMe->getBinarySize ();
+	if (splitBytes.size () < pageSize + newSize)
+		splitBytes.resize (pageSize + newSize);
+	char *temp = splitBytes.data ();
+	memcpy (temp, splitMe.getBytes (), pageSize);
+	void *spaceForLastGuy = temp + pageSize;
 	andMe->toBinary (spaceForLastGuy);
-	positions.push_back (spaceForLastGuy);
 
-	// now sort
-	RecordComparator myComparator (comparator, lhs, rhs);
-	std::sort (positions.begin (), positions.end (), myComparator);
+	// positions of the records, in order; the slots are already sorted, and the new guy goes into whichSlot
+	vector <void *> &positions = splitPositions;
+	positions.clear ();
+	MyDB_BPlusPage oldPage (splitMe);
+	char *bytes = (char *) splitMe.getBytes ();
+	for (size_t i = 0; i < oldPage.getNumRecs (); i++) {
+		if (i == whichSlot)
+			positions.push_back (spaceForLastGuy);
+		positions.push_back (temp + (oldPage.getRec (i) - bytes));
+	}
+	if (whichSlot == oldPage.getNumRecs ())
+		positions.push_back (spaceForLastGuy);
 
 	// get the record to return
-	MyDB_INRecordPtr returnVal = getINRecord ();
+	MyDB_INRecordPtr returnVal = splitRec;
 	returnVal->setPtr (newPageLoc);
 
-	// clear the pages
-	newPage.clear ();
-	splitMe.clear ();
-	newPage.setType (myType);
-	splitMe.setType (myType);
+	// clear the pages; the new page goes right after the old one
+	int nextPage = oldPage.getNext ();
+	MyDB_BPlusPage highPage (newPage);
+	highPage.clear (myType);
+	oldPage.clear (myType);
+	highPage.setNext (nextPage);
+	oldPage.setNext (newPageLoc);
+
+	// the number of records that stay in the old page; a directory page is split in the middle, but a leaf is
+	// split where it keeps records with the same key together
+	size_t numLow = positions.size () / 2 + 1;
+	if (myType == MyDB_PageType :: RegularPage)
+		numLow = pickLeafSplit (whichSlot, nextPage == -1, pageSize - oldPage.getNumBytesUsed ());
 
 	// and copy the data over
-	int counter = 0;
+	size_t counter = 0;
 	for (void *pos : positions) {
 
-		// low data goes into the new page
-		lhs->fromBinary (pos);
-		if (counter < positions.size () / 2) 
-			newPage.append (lhs);
+		// low data (and the median) stay in the old page, high data go into the new one
+		if (counter < numLow)
+			oldPage.appendBinary (pos);
+		else
+			highPage.appendBinary (pos);
+
+		// the median's key is the key for the old page; for a leaf, anything from there up to the next key works
+		if (counter == numLow - 1) {
+			if (myType == MyDB_PageType :: RegularPage) {
+				setSeparator (returnVal, getDataKey ((char *) pos), getDataKey ((char *) positions[counter + 1]));
+			} else {
+				returnVal->getKey ()->fromValue (getINKey ((char *) pos));
+				returnVal->recordContentHasChanged ();
+			}
+		}
 
-		// median goes into the old page
-		if (counter == positions.size () / 2) {
-			newPage.append (lhs);
-			returnVal->setKey (getKey (lhs));
+		counter++;
+	}
+
+	return returnVal;
+
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: pickLeafSplit (size_t whichSlot, bool isLastLeaf, size_t room) {
+
+	vector <void *> &positions = splitPositions;
+	size_t numRecs = positions.size ();
+	auto keyAt = [&] (size_t i) {
+		return getDataKey ((char *) positions[i]);
+	};
+
+	// if the new record goes at the end of a run of records with the same key, then more records with the key
+	// will likely follow it, and they all go after it; the same is true at the end of the last leaf, when the
+	// records are coming in key order.  So the old page stays full, and they go on the new one
+	if (whichSlot == numRecs - 1 && (isLastLeaf || compareKeys (keyAt (numRecs - 2), keyAt (numRecs - 1)) == 0))
+		return numRecs - 1;
+
+	// otherwise, split between two different keys, as close to the middle as possible, where both halves fit;
+	// if there is no such place, then a run of records with the same key has to be split up
+	size_t totalBytes = 0;
+	for (void *pos : positions)
+		totalBytes += *((unsigned short *) pos) + sizeof (uint32_t);
+
+	size_t middle = numRecs / 2 + 1, best = middle, bestDistance = numRecs;
+	size_t lowBytes = 0;
+	for (size_t numLow = 1; numLow < numRecs; numLow++) {
+		lowBytes += *((unsigned short *) positions[numLow - 1]) + sizeof (uint32_t);
+		size_t distance = (numLow > middle) ? numLow - middle : middle - numLow;
+		if (distance < bestDistance && lowBytes <= room && totalBytes - lowBytes <= room &&
+			compareKeys (keyAt (numLow - 1), keyAt (numLow)) != 0) {
+			best = numLow;
+			bestDistance = distance;
 		}
+	}
+	return best;
+}
 
-		// high data goes into the old page
-		if (counter > positions.size () / 2)
-			splitMe.append (lhs);
+void MyDB_BPlusTreeReaderWriter :: setSeparator (MyDB_INRecordPtr toMe, const MyDB_Value &low, const MyDB_Value &high) {
 
-		counter++;
+	if (!truncateKeys || keyType != MyDB_ValueType :: StringVal || compareKeys (low, high) == 0) {
+		toMe->getKey ()->fromValue (low);
+
+	// the shortest prefix of high that is greater than low goes one character past where they first differ
+	} else {
+		size_t len = 0;
+		while (len < low.strLen && len < high.strLen && low.strVal[len] == high.strVal[len])
+			len++;
+		toMe->getKey ()->fromValue (MyDB_Value :: makeString (high.strVal, len + 1));
 	}
+	toMe->recordContentHasChanged ();
+}
 
-	free (spaceForLastGuy);
-	free (temp);
+void MyDB_BPlusTreeReaderWriter :: setSuffixTruncation (bool truncateKeysIn) {
+	truncateKeys = truncateKeysIn;
+}
 
-	return returnVal;
+int MyDB_BPlusTreeReaderWriter :: getHeight () {
 
+	if (getNumPages () <= 1)
+		return 0;
+
+	// go down the left edge of the tree
+	int height = 1;
+	for (int whichPage = rootLocation; ; height++) {
+		MyDB_BPlusPage page ((*this)[whichPage]);
+		if (page.getType () == MyDB_PageType :: RegularPage)
+			return height;
+		whichPage = getINPtr (page.getRec (0));
+	}
 }
 
-MyDB_RecordPtr MyDB_BPlusTreeReaderWriter :: append (int whichPage, MyDB_RecordPtr appendMe) {
+MyDB_INRecordPtr MyDB_BPlusTreeReaderWriter :: append (int whichPage, MyDB_RecordPtr appendMe) {
 
 	// figure out the page to add to
 	MyDB_PageReaderWriter pageToAddTo = (*this)[whichPage];
 
-	// it is a regular page (data page)
+	// it is a regular page (data page); the new guy goes after all of the records with the same key or a smaller one
+	const MyDB_Value &key = appendMe->getValue (whichAttIsOrdering);
 	if (pageToAddTo.getType () == MyDB_PageType :: RegularPage) {
 
+		MyDB_BPlusPage leaf (pageToAddTo);
+		size_t whichSlot = leaf.upperBound (leaf.getNumRecs (), [&] (char *rec) {
+			return compareKeys (getDataKey (rec), key);
+		});
+
 		// if we can fit the new guy, we are good
-		if (pageToAddTo.append (appendMe)) {
+		if (leaf.insert (whichSlot, appendMe))
 			return nullptr;
-		}
 
 		// if we cannot, then split the page
-		return split (pageToAddTo, appendMe);	
+		return split (pageToAddTo, appendMe, whichSlot);	
 		
-	// we have an internal node, so find the subtree to insert into
+	// we have an internal node, so find the subtree to insert into: the last one whose key is the same as the new
+	// record's, or if there is none, the first one whose key is greater (the last key is always the largest).  A
+	// long run of records with the same key fills up one leaf after another this way (see pickLeafSplit ()),
+	// rather than leaving half-empty leaves behind it
 	} else {
 
-		// iterate through the various subtrees
-		MyDB_RecordIteratorAltPtr temp = pageToAddTo.getIteratorAlt ();
-		MyDB_INRecordPtr otherRec = getINRecord ();
-		function <bool ()> comparator = buildComparator (appendMe, otherRec);
-		while (temp->advance ()) {
-			
-			// see if the new key is less than the key in the directory record
-			temp->getCurrent (otherRec);
-			if (comparator ()) {
-
-				// recursively append
-				auto res = append (otherRec->getPtr (), appendMe);
-
-				// we got a child split
-				if (res != nullptr) {
-
-					// attempt to add the new one	
-					if (pageToAddTo.append (res)) {
-						MyDB_INRecordPtr otherRec = getINRecord ();
-						function <bool ()> comparator = buildComparator (res, otherRec);	
-						pageToAddTo.sortInPlace (comparator, res, otherRec);
-						return nullptr;
-					}
-
-					// could not fit the new one, so split it
-					return split (pageToAddTo, res);
-				}
+		MyDB_BPlusPage dirPage (pageToAddTo);
+		size_t whichSlot = findSubtree (dirPage, key);
+
+		// recursively append
+		int child = getINPtr (dirPage.getRec (whichSlot));
+		auto res = append (child, appendMe);
+
+		// we got a child split; the old child now has the lower half of its records (and res has the key for
+		// them), and the new child has the upper half, so it takes over the old child's entry
+		if (res != nullptr) {
+
+			setINPtr (dirPage.getRec (whichSlot), res->getPtr ());
+			dirPage.getPage ().wroteBytes ();
+			res->setPtr (child);
+
+			// attempt to add the new one	
+			if (dirPage.insert (whichSlot, res))
 				return nullptr;
+
+			// could not fit the new one, so split it
+			return split (pageToAddTo, res, whichSlot);
+		}
+		return nullptr;
+	}
+}
+
+size_t MyDB_BPlusTreeReaderWriter :: findSubtree (MyDB_BPlusPage &dirPage, const MyDB_Value &key) {
+	size_t whichSlot = dirPage.upperBound (dirPage.getNumRecs () - 1, [&] (char *rec) {
+		return compareKeys (getINKey (rec), key);
+	});
+	if (whichSlot > 0 && compareKeys (getINKey (dirPage.getRec (whichSlot - 1)), key) == 0)
+		whichSlot--;
+	return whichSlot;
+}
+
+void MyDB_BPlusTreeReaderWriter :: appendBatch (vector <MyDB_RecordPtr> &appendMe) {
+
+	if (appendMe.empty ())
+		return;
+	if (getNumPages () <= 1)
+		makeEmpty ();
+
+	// sort the batch on the key
+	batch = appendMe;
+	sort (batch.begin (), batch.end (), [&] (const MyDB_RecordPtr &lhs, const MyDB_RecordPtr &rhs) {
+		return compareKeys (lhs->getValue (whichAttIsOrdering), rhs->getValue (whichAttIsOrdering)) < 0;
+	});
+
+	// if the root is split, a new root goes above the pages that it was split into; it starts out with just
+	// the entry for the last of them (which has the largest possible key), and it might have to be split too
+	vector <MyDB_INRecordPtr> newEntries;
+	int lastPage = appendBatch (rootLocation, batch.data (), batch.size (), newEntries);
+	while (!newEntries.empty ()) {
+		int newRootLoc = getTable ()->lastPage () + 1;
+		getTable ()->setLastPage (newRootLoc);
+		MyDB_BPlusPage newRoot ((*this)[newRootLoc]);
+		newRoot.clear (MyDB_PageType :: DirectoryPage);
+		MyDB_INRecordPtr lastEntry = getINRecord ();
+		lastEntry->setPtr (lastPage);
+		newRoot.append (lastEntry);
+		rootLocation = newRootLoc;
+
+		vector <pair <size_t, MyDB_INRecordPtr>> toAdd;
+		for (MyDB_INRecordPtr &entry : newEntries)
+			toAdd.push_back (make_pair (0, entry));
+		newEntries.clear ();
+		lastPage = addEntries (newRootLoc, toAdd, newEntries);
+	}
+	batch.clear ();
+}
+
+int MyDB_BPlusTreeReaderWriter :: appendBatch (int whichPage, MyDB_RecordPtr *recs, size_t n,
+	vector <MyDB_INRecordPtr> &newEntries) {
+
+	MyDB_PageReaderWriter pageToAddTo = (*this)[whichPage];
+	MyDB_BPlusPage page (pageToAddTo);
+	size_t pageSize = pageToAddTo.getPageSize ();
+	size_t numRecs = page.getNumRecs ();
+
+	// a directory page: the records are sorted, so the ones that go into each subtree are next to each other,
+	// and each subtree gets all of them at once.  The new entries from the subtrees all go in at the end
+	if (pageToAddTo.getType () == MyDB_PageType :: DirectoryPage) {
+		vector <pair <size_t, MyDB_INRecordPtr>> toAdd;
+		vector <MyDB_INRecordPtr> childEntries;
+		for (size_t i = 0, j; i < n; i = j) {
+
+			// the ones after the first that go to the same subtree are found with a binary search
+			size_t whichSlot = findSubtree (page, recs[i]->getValue (whichAttIsOrdering));
+			size_t high = n;
+			for (j = i + 1; j < high; ) {
+				size_t mid = (j + high) / 2;
+				if (findSubtree (page, recs[mid]->getValue (whichAttIsOrdering)) == whichSlot)
+					j = mid + 1;
+				else
+					high = mid;
 			}
+
+			int child = getINPtr (page.getRec (whichSlot));
+			childEntries.clear ();
+			int lastPage = appendBatch (child, recs + i, j - i, childEntries);
+			if (lastPage != child) {
+				setINPtr (page.getRec (whichSlot), lastPage);
+				pageToAddTo.wroteBytes ();
+			}
+			for (MyDB_INRecordPtr &entry : childEntries)
+				toAdd.push_back (make_pair (whichSlot, entry));
+		}
+		return addEntries (whichPage, toAdd, newEntries);
+	}
+
+	// a leaf: if the records fit, they are just put in, each after the records with the same key or a smaller one
+	size_t numBytes = 0;
+	for (size_t i = 0; i < n; i++)
+		numBytes += recs[i]->getBinarySize () + sizeof (uint32_t);
+	if (page.getNumBytesUsed () + numBytes <= pageSize) {
+		for (size_t i = 0; i < n; i++) {
+			const MyDB_Value &key = recs[i]->getValue (whichAttIsOrdering);
+			page.insert (page.upperBound (page.getNumRecs (), [&] (char *rec) {
+				return compareKeys (getDataKey (rec), key);
+			}), recs[i]);
+		}
+		return whichPage;
+	}
+
+	// otherwise the records on the page are copied into the scratch space, followed by the new ones, and they
+	// are merged, to be spread over new pages
+	if (splitBytes.size () < pageSize + numBytes)
+		splitBytes.resize (pageSize + numBytes);
+	char *temp = splitBytes.data ();
+	char *bytes = (char *) pageToAddTo.getBytes ();
+	memcpy (temp, bytes, pageSize);
+	char *nextNew = temp + pageSize;
+
+	vector <void *> &positions = splitPositions;
+	positions.clear ();
+	size_t whichOld = 0;
+	for (size_t i = 0; i < n; i++) {
+		const MyDB_Value &key = recs[i]->getValue (whichAttIsOrdering);
+		for (; whichOld < numRecs && compareKeys (getDataKey (page.getRec (whichOld)), key) <= 0; whichOld++)
+			positions.push_back (temp + (page.getRec (whichOld) - bytes));
+		positions.push_back (nextNew);
+		nextNew = (char *) recs[i]->toBinary (nextNew);
+	}
+	for (; whichOld < numRecs; whichOld++)
+		positions.push_back (temp + (page.getRec (whichOld) - bytes));
+
+	// if the new records all go after the old ones, and this is the last leaf (or they start with the key that
+	// the old ones end with), then more are likely to come after them, so the pages are filled up, just like when
+	// a single record is appended there (see pickLeafSplit ())
+	int endsWith = (numRecs == 0) ? 1 :
+		compareKeys (recs[0]->getValue (whichAttIsOrdering), getDataKey (page.getRec (numRecs - 1)));
+	bool packFull = endsWith == 0 || (endsWith > 0 && page.getNext () == -1);
+	return spread (whichPage, packFull, newEntries);
+}
+
+int MyDB_BPlusTreeReaderWriter :: addEntries (int whichPage, vector <pair <size_t, MyDB_INRecordPtr>> &toAdd,
+	vector <MyDB_INRecordPtr> &newEntries) {
+
+	if (toAdd.empty ())
+		return whichPage;
+
+	// if the entries fit, they are just put in; each one that goes in moves the rest of the slots over by one
+	MyDB_PageReaderWriter pageToAddTo = (*this)[whichPage];
+	MyDB_BPlusPage dirPage (pageToAddTo);
+	size_t pageSize = pageToAddTo.getPageSize ();
+	size_t numBytes = 0;
+	for (auto &add : toAdd)
+		numBytes += add.second->getBinarySize () + sizeof (uint32_t);
+	if (dirPage.getNumBytesUsed () + numBytes <= pageSize) {
+		size_t numAdded = 0;
+		for (auto &add : toAdd)
+			dirPage.insert (add.first + numAdded++, add.second);
+		return whichPage;
+	}
+
+	// otherwise, just like a leaf, the entries are merged in the scratch space, and spread over new pages
+	if (splitBytes.size () < pageSize + numBytes)
+		splitBytes.resize (pageSize + numBytes);
+	char *temp = splitBytes.data ();
+	char *bytes = (char *) pageToAddTo.getBytes ();
+	memcpy (temp, bytes, pageSize);
+	char *nextNew = temp + pageSize;
+
+	vector <void *> &positions = splitPositions;
+	positions.clear ();
+	size_t whichAdd = 0;
+	for (size_t i = 0; i < dirPage.getNumRecs (); i++) {
+		for (; whichAdd < toAdd.size () && toAdd[whichAdd].first == i; whichAdd++) {
+			positions.push_back (nextNew);
+			nextNew = (char *) toAdd[whichAdd].second->toBinary (nextNew);
+		}
+		positions.push_back (temp + (dirPage.getRec (i) - bytes));
+	}
+	return spread (whichPage, false, newEntries);
+}
+
+int MyDB_BPlusTreeReaderWriter :: spread (int whichPage, bool packFull, vector <MyDB_INRecordPtr> &newEntries) {
+
+	vector <void *> &positions = splitPositions;
+	auto sizeOf = [&] (size_t i) {
+		return *((unsigned short *) positions[i]) + sizeof (uint32_t);
+	};
+
+	MyDB_BPlusPage page ((*this)[whichPage]);
+	MyDB_PageType myType = page.getPage ().getType ();
+	bool isLeaf = (myType == MyDB_PageType :: RegularPage);
+	int nextPage = page.getNext ();
+	page.clear (myType);
+	size_t room = page.getPage ().getPageSize () - page.getNumBytesUsed ();
+
+	// the number of pages that it takes when they are filled up, and how much goes on each one, to even them out
+	size_t numPages = 1, totalBytes = 0, pageBytes = 0;
+	for (size_t i = 0; i < positions.size (); i++) {
+		if (pageBytes > 0 && pageBytes + sizeOf (i) > room) {
+			numPages++;
+			pageBytes = 0;
 		}
+		pageBytes += sizeOf (i);
+		totalBytes += sizeOf (i);
 	}
+	size_t target = packFull ? room : (totalBytes + numPages - 1) / numPages;
+
+	for (size_t start = 0; ; ) {
+
+		// fill the page up to the target, or as much as fits
+		size_t end = start, numBytes = 0;
+		while (end < positions.size () && (end == start || numBytes + sizeOf (end) <= room) && numBytes < target)
+			numBytes += sizeOf (end++);
+
+		// a leaf is split between two different keys, if there is a place like that close by where the page
+		// is not too full (see pickLeafSplit ())
+		if (isLeaf && !packFull && end < positions.size ()) {
+			size_t best = end, bestDistance = positions.size ();
+			numBytes = 0;
+			for (size_t cut = start + 1; cut < positions.size () && numBytes + sizeOf (cut - 1) <= room; cut++) {
+				numBytes += sizeOf (cut - 1);
+				size_t distance = (cut > end) ? cut - end : end - cut;
+				if (distance < bestDistance && compareKeys (getDataKey ((char *) positions[cut - 1]),
+					getDataKey ((char *) positions[cut])) != 0) {
+					best = cut;
+					bestDistance = distance;
+				}
+			}
+			end = best;
+		}
 
-	// note, we should never get here
-	return nullptr;
+		for (size_t i = start; i < end; i++)
+			page.appendBinary (positions[i]);
+		if (end == positions.size ())
+			break;
+
+		// the entry for the page in its parent has the page's largest key (or for a leaf, something between that
+		// and the next key; see setSeparator ())
+		MyDB_INRecordPtr entry = getINRecord ();
+		if (isLeaf) {
+			setSeparator (entry, getDataKey ((char *) positions[end - 1]), getDataKey ((char *) positions[end]));
+		} else {
+			entry->getKey ()->fromValue (getINKey ((char *) positions[end - 1]));
+			entry->recordContentHasChanged ();
+		}
+		entry->setPtr (whichPage);
+		newEntries.push_back (entry);
+
+		// and the rest go on a new page after this one
+		whichPage = getTable ()->lastPage () + 1;
+		getTable ()->setLastPage (whichPage);
+		page.setNext (whichPage);
+		page = MyDB_BPlusPage ((*this)[whichPage]);
+		page.clear (myType);
+		start = end;
+	}
+	page.setNext (nextPage);
+	return whichPage;
 }
 
 MyDB_INRecordPtr MyDB_BPlusTreeReaderWriter :: getINRecord () {
@@ -342,10 +761,10 @@ void MyDB_BPlusTreeReaderWriter :: printTree (int whichPage, int depth) {
 	// print out a leaf page
 	if (pageToPrint.getType () == MyDB_PageType :: RegularPage) {
 		MyDB_RecordPtr myRec = getEmptyRecord ();
-		MyDB_RecordIteratorAltPtr temp = pageToPrint.getIteratorAlt ();
-		while (temp->advance ()) {
+		MyDB_BPlusPage leaf (pageToPrint);
+		for (size_t i = 0; i < leaf.getNumRecs (); i++) {
 			
-			temp->getCurrent (myRec);
+			myRec->fromBinary (leaf.getRec (i));
 			for (int i = 0; i < depth; i++)
 				cout << "\t";
 			cout << myRec << "\n";
@@ -355,10 +774,10 @@ void MyDB_BPlusTreeReaderWriter :: printTree (int whichPage, int depth) {
 	} else {
 
 		MyDB_INRecordPtr myRec = getINRecord ();
-		MyDB_RecordIteratorAltPtr temp = pageToPrint.getIteratorAlt ();
-		while (temp->advance ()) {
+		MyDB_BPlusPage dirPage (pageToPrint);
+		for (size_t i = 0; i < dirPage.getNumRecs (); i++) {
 			
-			temp->getCurrent (myRec);
+			myRec->fromBinary (dirPage.getRec (i));
 			printTree (myRec->getPtr (), depth + 1);
 			for (int i = 0; i < depth; i++)
 				cout << "\t";
@@ -367,53 +786,5 @@ void MyDB_BPlusTreeReaderWriter :: printTree (int whichPage, int depth) {
 	}
 }
 
-MyDB_AttValPtr MyDB_BPlusTreeReaderWriter :: getKey (MyDB_RecordPtr fromMe) {
-
-	MyDB_AttValPtr source;
-
-	// in this case, got an IN record
-	if (fromMe->getSchema () == nullptr) 
-		return fromMe->getAtt (0)->getCopy ();
-
-	// in this case, got a data record
-	else 
-		return fromMe->getAtt (whichAttIsOrdering)->getCopy ();
-}
-
-function <bool ()>  MyDB_BPlusTreeReaderWriter :: buildComparator (MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
-
-	MyDB_AttValPtr lhAtt, rhAtt;
-
-	// in this case, the LHS is an IN record
-	if (lhs->getSchema () == nullptr) {
-		lhAtt = lhs->getAtt (0);	
-
-	// here, it is a regular data record
-	} else {
-		lhAtt = lhs->getAtt (whichAttIsOrdering);
-	}
-
-	// in this case, the LHS is an IN record
-	if (rhs->getSchema () == nullptr) {
-		rhAtt = rhs->getAtt (0);	
-
-	// here, it is a regular data record
-	} else {
-		rhAtt = rhs->getAtt (whichAttIsOrdering);
-	}
-	
-	// now, build the comparison lambda and return
-	if (orderingAttType->promotableToInt ()) {
-		return [lhAtt, rhAtt] {return lhAtt->toInt () < rhAtt->toInt ();};
-	} else if (orderingAttType->promotableToDouble ()) {
-		return [lhAtt, rhAtt] {return lhAtt->toDouble () < rhAtt->toDouble ();};
-	} else if (orderingAttType->promotableToString ()) {
-		return [lhAtt, rhAtt] {return lhAtt->toString () < rhAtt->toString ();};
-	} else {
-		cout << "This is bad... cannot do anything with the >.\n";
-		exit (1);
-	}
-}
-
 
 #endif
@@ -0,0 +1,324 @@
+
+#ifndef CONCURRENT_BPLUS_C
+#define CONCURRENT_BPLUS_C
+
+#include "MyDB_ConcurrentBPlusTree.h"
+#include "MyDB_INRecord.h"
+#include "MyDB_PageReaderWriter.h"
+#include <iostream>
+#include <string.h>
+
+MyDB_ConcurrentBPlusTree :: MyDB_ConcurrentBPlusTree (string orderOnAttName, MyDB_TablePtr forMe,
+	MyDB_BufferManagerPtr myBuffer) : MyDB_BPlusTreeReaderWriter (orderOnAttName, forMe, myBuffer),
+	versions (myBuffer->getNumPages ()), nodes (myBuffer->getNumPages ()) {
+
+	// a directory entry is a key and a page number, and a data record has the key (and the rest of the record),
+	// so the entry is bigger than the record by at most the size of the page number, plus the slot
+	MyDB_INRecordPtr temp = getINRecord ();
+	vector <char> bytes (temp->getBinarySize ());
+	temp->toBinary (bytes.data ());
+	entryOverhead = bytes.size () - sizeof (short) - *((short *) (bytes.data () + sizeof (short))) + sizeof (uint32_t);
+	maxEntrySize = entryOverhead;
+
+	if (getNumPages () <= 1)
+		makeEmpty ();
+	addNodes ();
+}
+
+MyDB_ConcurrentBPlusTree :: ~MyDB_ConcurrentBPlusTree () {
+	for (auto &node : pinnedNodes)
+		node->getPage ().unpin ();
+}
+
+void MyDB_ConcurrentBPlusTree :: appendBatch (vector <MyDB_RecordPtr> &appendMe) {
+	MyDB_BPlusTreeReaderWriter :: appendBatch (appendMe);
+	addNodes ();
+}
+
+void MyDB_ConcurrentBPlusTree :: bulkLoad (MyDB_RecordIteratorAltPtr sortedRecs, double fillFactor) {
+	MyDB_BPlusTreeReaderWriter :: bulkLoad (sortedRecs, fillFactor);
+	addNodes ();
+}
+
+void MyDB_ConcurrentBPlusTree :: bulkLoad (MyDB_TableReaderWriter &fromMe, double fillFactor) {
+	MyDB_BPlusTreeReaderWriter :: bulkLoad (fromMe, fillFactor);
+	addNodes ();
+}
+
+void MyDB_ConcurrentBPlusTree :: addNode (int whichPage) {
+	if (whichPage >= (int) nodes.size ()) {
+		cout << "A concurrent B+-Tree has to fit in the buffer, and " << getTable ()->getName () << " does not.\n";
+		exit (1);
+	}
+	pinnedNodes.emplace_back (new MyDB_BPlusPage (getPinned (whichPage)));
+	nodes[whichPage].store (pinnedNodes.back ().get (), memory_order_release);
+}
+
+void MyDB_ConcurrentBPlusTree :: addNodes () {
+	for (int i = 0; i < getNumPages (); i++) {
+		if (getNode (i) == nullptr)
+			addNode (i);
+	}
+
+	// the entries that splits make come from the records that are in the tree now (or are appended later)
+	size_t maxRecSize = 0;
+	for (auto &node : pinnedNodes) {
+		for (size_t i = 0; i < node->getNumRecs (); i++)
+			maxRecSize = max (maxRecSize, (size_t) *((unsigned short *) node->getRec (i)));
+	}
+	maxEntrySize = max (maxEntrySize.load (), maxRecSize + entryOverhead);
+	root = rootLocation;
+}
+
+bool MyDB_ConcurrentBPlusTree :: contains (MyDB_AttValPtr key) {
+	static thread_local vector <char> matches;
+	return findMatches (key, true, matches) > 0;
+}
+
+size_t MyDB_ConcurrentBPlusTree :: lookup (MyDB_AttValPtr key, vector <MyDB_RecordPtr> &intoMe) {
+	static thread_local vector <char> matches;
+	size_t numFound = findMatches (key, false, matches);
+	char *rec = matches.data ();
+	for (size_t i = 0; i < numFound; i++) {
+		if (i == intoMe.size ())
+			intoMe.push_back (getEmptyRecord ());
+		intoMe[i]->fromBinary (rec);
+		rec += *((unsigned short *) rec);
+	}
+	return numFound;
+}
+
+bool MyDB_ConcurrentBPlusTree :: lookup (MyDB_AttValPtr key, MyDB_RecordPtr intoMe) {
+	static thread_local vector <char> matches;
+	if (findMatches (key, true, matches) == 0)
+		return false;
+	intoMe->fromBinary (matches.data ());
+	return true;
+}
+
+size_t MyDB_ConcurrentBPlusTree :: findMatches (MyDB_AttValPtr keyIn, bool firstOnly, vector <char> &matches) {
+	static thread_local string keyScratch;
+	MyDB_Value key = getSearchKey (keyIn, keyScratch);
+	size_t numFound;
+	while (!findMatches (key, firstOnly, matches, numFound));
+	return numFound;
+}
+
+bool MyDB_ConcurrentBPlusTree :: findMatches (const MyDB_Value &key, bool firstOnly, vector <char> &matches,
+	size_t &numFound) {
+
+	static thread_local vector <MyDB_PathStep> path;
+	if (!descend (key, false, path))
+		return false;
+
+	// the matches start on the leaf where the key would go, and may run off of the end of it onto the next ones;
+	// they are copied as they are found, since the page might be changed after we read them (in which case we
+	// find that out, and start over, before anyone sees them)
+	int whichPage = path.back ().whichPage;
+	uint64_t version = path.back ().version;
+	matches.clear ();
+	numFound = 0;
+	while (true) {
+		MyDB_BPlusPage &leaf = *getNode (whichPage);
+		size_t numRecs = leaf.getNumRecsChecked ();
+		bool bad = false;
+		size_t first = search (leaf, numRecs, numRecs, true, key, 0, bad);
+		bool done = false;
+		for (size_t i = first; i < numRecs && !done && !bad; i++) {
+			MyDB_Value recKey;
+			if (!getKeyChecked (leaf, numRecs, i, true, recKey)) {
+				bad = true;
+			} else if (compareKeys (recKey, key) != 0) {
+				done = true;
+			} else {
+				char *rec = leaf.getRecChecked (numRecs, i);
+				matches.insert (matches.end (), rec, rec + *((unsigned short *) rec));
+				numFound++;
+				done = firstOnly;
+			}
+		}
+		if (bad)
+			return false;
+
+		// go on to the next leaf, making sure that it really was the next one
+		int nextPage = leaf.getNext ();
+		if (done || nextPage == -1)
+			return stillValid (whichPage, version);
+		if (getNode (nextPage) == nullptr)
+			return false;
+		uint64_t nextVersion = readLock (nextPage);
+		if (!stillValid (whichPage, version))
+			return false;
+		whichPage = nextPage;
+		version = nextVersion;
+	}
+}
+
+bool MyDB_ConcurrentBPlusTree :: descend (const MyDB_Value &key, bool forAppend, vector <MyDB_PathStep> &path) {
+
+	// the root might have split before we got its version, so make sure that it is still the root
+	path.clear ();
+	int whichPage = root.load ();
+	uint64_t version = readLock (whichPage);
+	if (root.load () != whichPage)
+		return false;
+
+	while (true) {
+		MyDB_BPlusPage &page = *getNode (whichPage);
+		size_t numBytesUsed = page.getNumBytesUsed ();
+		size_t pageSize = page.getPage ().getPageSize ();
+		path.push_back ({whichPage, version, numBytesUsed < pageSize ? pageSize - numBytesUsed : 0});
+		MyDB_PageType type = page.getType ();
+		if (type == MyDB_PageType :: RegularPage)
+			return true;
+		if (type != MyDB_PageType :: DirectoryPage)
+			return false;
+
+		// the subtree to go to is found just like MyDB_BPlusTreeReaderWriter does (see findLeaf () and append ())
+		size_t numRecs = page.getNumRecsChecked ();
+		if (numRecs == 0)
+			return false;
+		bool bad = false;
+		size_t whichSlot = search (page, numRecs, numRecs - 1, false, key, forAppend ? 1 : 0, bad);
+		MyDB_Value prevKey;
+		if (forAppend && whichSlot > 0 && getKeyChecked (page, numRecs, whichSlot - 1, false, prevKey) &&
+			compareKeys (prevKey, key) == 0)
+			whichSlot--;
+
+		// and the child is only good if this page did not change while we were reading it
+		int child;
+		if (bad || !getINPtrChecked (page, numRecs, whichSlot, child) || getNode (child) == nullptr)
+			return false;
+		uint64_t childVersion = readLock (child);
+		if (!stillValid (whichPage, version))
+			return false;
+		whichPage = child;
+		version = childVersion;
+	}
+}
+
+void MyDB_ConcurrentBPlusTree :: append (MyDB_RecordPtr appendMe) {
+
+	// see maxEntrySize
+	size_t entrySize = appendMe->getBinarySize () + entryOverhead;
+	size_t maxSize = maxEntrySize.load ();
+	while (maxSize < entrySize && !maxEntrySize.compare_exchange_weak (maxSize, entrySize));
+
+	static thread_local vector <MyDB_PathStep> path;
+	const MyDB_Value &key = appendMe->getValue (whichAttIsOrdering);
+	while (!append (appendMe, key, path));
+}
+
+bool MyDB_ConcurrentBPlusTree :: append (MyDB_RecordPtr appendMe, const MyDB_Value &key, vector <MyDB_PathStep> &path) {
+
+	if (!descend (key, true, path))
+		return false;
+
+	// once the leaf is locked, nobody else can change it, so it is read like it is in any other tree
+	int leafPage = path.back ().whichPage;
+	if (!tryLock (leafPage, path.back ().version))
+		return false;
+	MyDB_BPlusPage &leaf = *getNode (leafPage);
+	size_t whichSlot = leaf.upperBound (leaf.getNumRecs (), [&] (char *rec) {
+		return compareKeys (getDataKey (rec), key);
+	});
+	if (leaf.insert (whichSlot, appendMe)) {
+		unlock (leafPage);
+		return true;
+	}
+
+	// the leaf has to split, and the pages above it split too, up to the first one that has room for the entry
+	// that it gets (or the root, which might split as well); those are all locked, from the top down, as long
+	// as none of them has changed since we came down through it
+	size_t top = path.size () - 1;
+	while (top > 0 && path[--top].bytesFree < maxEntrySize.load ());
+	for (size_t i = top; i < path.size () - 1; i++) {
+		if (!tryLock (path[i].whichPage, path[i].version)) {
+			while (i > top)
+				unlock (path[--i].whichPage);
+			unlock (leafPage);
+			return false;
+		}
+	}
+
+	// now the pages are split just like in any other tree; the new pages are added to this one before anything
+	// is unlocked, so that readers can get to them
+	{
+		lock_guard <mutex> guard (splitLock);
+		int lastPage = getTable ()->lastPage ();
+		auto res = MyDB_BPlusTreeReaderWriter :: append (path[top].whichPage, appendMe);
+		if (res != nullptr)
+			newRoot (res);
+		for (int i = lastPage + 1; i < getNumPages (); i++)
+			addNode (i);
+		root = rootLocation;
+	}
+
+	for (size_t i = top; i < path.size (); i++)
+		unlock (path[i].whichPage);
+	return true;
+}
+
+size_t MyDB_ConcurrentBPlusTree :: search (MyDB_BPlusPage &page, size_t numRecs, size_t n, bool isLeaf,
+	const MyDB_Value &key, int atLeast, bool &bad) {
+
+	size_t low = 0, high = n;
+	while (low < high && !bad) {
+		size_t mid = (low + high) / 2;
+		MyDB_Value midKey;
+		if (!getKeyChecked (page, numRecs, mid, isLeaf, midKey))
+			bad = true;
+		else if (compareKeys (midKey, key) < atLeast)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+bool MyDB_ConcurrentBPlusTree :: getKeyChecked (MyDB_BPlusPage &page, size_t numRecs, size_t i, bool isLeaf,
+	MyDB_Value &key) {
+
+	// the key has to have room for its value (or for a string, the null at the end of it)
+	size_t minSize = sizeof (short);
+	switch (keyType) {
+		case MyDB_ValueType :: IntVal: minSize += sizeof (int); break;
+		case MyDB_ValueType :: DoubleVal: minSize += sizeof (double); break;
+		default: minSize += 1;
+	}
+
+	char *rec = page.getRecChecked (numRecs, i);
+	char *att = (rec == nullptr) ? nullptr : getAttChecked (rec, isLeaf ? whichAttIsOrdering : 0, minSize);
+	if (att == nullptr)
+		return false;
+	key = MyDB_Value :: fromBinary (keyType, att);
+	return true;
+}
+
+bool MyDB_ConcurrentBPlusTree :: getINPtrChecked (MyDB_BPlusPage &page, size_t numRecs, size_t i, int &ptr) {
+	char *rec = page.getRecChecked (numRecs, i);
+	char *att = (rec == nullptr) ? nullptr : getAttChecked (rec, 1, sizeof (short) + sizeof (int));
+	if (att == nullptr)
+		return false;
+	ptr = *((int *) (att + sizeof (short)));
+	return true;
+}
+
+char *MyDB_ConcurrentBPlusTree :: getAttChecked (char *rec, int whichAtt, size_t minSize) {
+
+	// each attribute starts with its size
+	char *end = rec + *((unsigned short *) rec);
+	char *att = rec + sizeof (short);
+	for (int i = 0; ; i++) {
+		if (att + sizeof (short) > end)
+			return nullptr;
+		size_t attSize = *((unsigned short *) att);
+		if (attSize < sizeof (short) || att + attSize > end)
+			return nullptr;
+		if (i == whichAtt)
+			return attSize < minSize ? nullptr : att;
+		att += attSize;
+	}
+}
+
+#endif
@@ -28,9 +28,58 @@ bool MyDB_PageListIteratorAlt :: advance () {
 	if (curPage == forUs.size () - 1)
 		return false;
 
+	nextPage ();
+	return advance ();
+}
+
+void MyDB_PageListIteratorAlt :: appendToBatch (MyDB_RecordBatch &intoMe) {
+
+	while (true) {
+		myIter->appendToBatch (intoMe);
+
+		// if the batch filled up, the current page may still have records on it
+		if (intoMe.isFull () || curPage == (int) forUs.size () - 1)
+			return;
+
+		nextPage ();
+	}
+}
+
+void MyDB_PageListIteratorAlt :: nextPage () {
+
+	if (curPinned) {
+		forUs[curPage].unpin ();
+		curPinned = false;
+	}
 	curPage++;
 	myIter = forUs[curPage].getIteratorAlt ();
-	return advance ();
+
+	// if we read this page ahead, wait until it is in RAM; it stays pinned while it is the current
+	// page, and so, while we are reading ahead, does any other current page
+	if (aheadPage == curPage) {
+		forUs[curPage].getBytes ();
+		curPinned = true;
+		aheadPage = -1;
+	}
+	startReadAhead ();
+}
+
+void MyDB_PageListIteratorAlt :: startReadAhead () {
+	if (readAhead && !curPinned) {
+		forUs[curPage].pin ();
+		curPinned = true;
+	}
+	if (readAhead && aheadPage == -1 && curPage + 1 < (int) forUs.size () && forUs[curPage + 1].prefetch ())
+		aheadPage = curPage + 1;
+}
+
+void MyDB_PageListIteratorAlt :: setReadAhead (bool readAheadIn) {
+	readAhead = readAheadIn;
+	if (!readAhead && curPinned) {
+		forUs[curPage].unpin ();
+		curPinned = false;
+	}
+	startReadAhead ();
 }
 
 void *MyDB_PageListIteratorAlt :: getCurrentPointer () {
@@ -40,9 +89,17 @@ void *MyDB_PageListIteratorAlt :: getCurrentPointer () {
 MyDB_PageListIteratorAlt :: MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUsIn) {
 	forUs = forUsIn;
 	curPage = 0;
+	readAhead = false;
+	aheadPage = -1;
+	curPinned = false;
 	myIter = forUsIn[curPage].getIteratorAlt ();		
 }
 
-MyDB_PageListIteratorAlt :: ~MyDB_PageListIteratorAlt () {}
+MyDB_PageListIteratorAlt :: ~MyDB_PageListIteratorAlt () {
+	if (aheadPage != -1)
+		forUs[aheadPage].unpin ();
+	if (curPinned)
+		forUs[curPage].unpin ();
+}
 
 #endif
@@ -48,6 +48,32 @@ MyDB_PageReaderWriter :: MyDB_PageReaderWriter (MyDB_BufferManager &parent) {
 	clear ();
 }
 
+MyDB_PageReaderWriter :: MyDB_PageReaderWriter (bool pinned, MyDB_BufferManager &parent) {
+	if (pinned) {
+		myPage = parent.getPinnedPage ();
+	} else {
+		myPage = parent.getPage ();
+	}
+	pageSize = parent.getPageSize ();
+	clear ();
+}
+
+void MyDB_PageReaderWriter :: pin () {
+	myPage->getParent ().pin (myPage);
+}
+
+void MyDB_PageReaderWriter :: unpin () {
+	myPage->getParent ().unpin (myPage);
+}
+
+bool MyDB_PageReaderWriter :: prefetch () {
+	return myPage->getParent ().prefetch (myPage);
+}
+
+void MyDB_PageReaderWriter :: flush () {
+	myPage->getParent ().flush (myPage);
+}
+
 void MyDB_PageReaderWriter :: clear () {
 	NUM_BYTES_USED = 2 * sizeof (size_t);
 	PAGE_TYPE = MyDB_PageType :: RegularPage;
@@ -97,6 +123,19 @@ bool MyDB_PageReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	return true;
 }
 
+bool MyDB_PageReaderWriter :: appendBinary (void *appendMe) {
+
+	size_t recSize = *((short *) appendMe);
+	if (recSize > NUM_BYTES_LEFT)
+		return false;
+
+	// write at the end
+	memcpy (NUM_BYTES_USED + (char *) myPage->getBytes (), appendMe, recSize);
+	NUM_BYTES_USED += recSize;
+	myPage->wroteBytes ();
+	return true;
+}
+
 void MyDB_PageReaderWriter :: 
 	sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs) {
 
@@ -162,6 +201,53 @@ MyDB_PageReaderWriterPtr MyDB_PageReaderWriter ::
 	return returnVal;
 }
 
+void MyDB_PageReaderWriter :: sortInPlace (MyDB_SortKeyPtr key) {
+
+	void *temp = malloc (pageSize);
+	memcpy (temp, myPage->getBytes (), pageSize);
+
+	// find all of the records
+	vector <void *> positions;
+	size_t bytesConsumed = sizeof (size_t) * 2;
+	while (bytesConsumed != NUM_BYTES_USED) {
+		void *pos = bytesConsumed + (char *) temp;
+		positions.push_back (pos);
+		bytesConsumed += *((short *) pos);
+	}
+
+	// sort them, and copy them back
+	key->sort (positions);
+	NUM_BYTES_USED = 2 * sizeof (size_t);
+	for (void *pos : positions)
+		appendBinary (pos);
+
+	free (temp);
+}
+
+MyDB_PageReaderWriterPtr MyDB_PageReaderWriter :: sort (MyDB_SortKeyPtr key) {
+
+	// find all of the records
+	vector <void *> positions;
+	getRecords (positions);
+
+	// sort them, and copy them to the new page
+	key->sort (positions);
+	MyDB_PageReaderWriterPtr returnVal = make_shared <MyDB_PageReaderWriter> (myPage->getParent ());
+	for (void *pos : positions)
+		returnVal->appendBinary (pos);
+
+	return returnVal;
+}
+
+void MyDB_PageReaderWriter :: getRecords (vector <void *> &appendToMe) {
+	size_t bytesConsumed = sizeof (size_t) * 2;
+	while (bytesConsumed != NUM_BYTES_USED) {
+		void *pos = bytesConsumed + (char *) myPage->getBytes ();
+		appendToMe.push_back (pos);
+		bytesConsumed += *((short *) pos);
+	}
+}
+
 size_t MyDB_PageReaderWriter :: getPageSize () {
 	return pageSize;
 }
@@ -170,4 +256,8 @@ void *MyDB_PageReaderWriter :: getBytes () {
 	return myPage->getBytes ();
 }
 
+void MyDB_PageReaderWriter :: wroteBytes () {
+	myPage->wroteBytes ();
+}
+
 #endif
@@ -29,15 +29,36 @@ void *MyDB_PageRecIteratorAlt :: getCurrentPointer () {
 }
 
 bool MyDB_PageRecIteratorAlt :: advance () {
-	if (nextRecSize == -1) {
-		cout << "You can't call advance without calling getCurrent!!\n";
-		exit (1);
-	}
+	// if getCurrent () was not called, get the size from the record itself
+	if (nextRecSize == -1)
+		nextRecSize = *((short *) (bytesConsumed + (char *) myPage->getBytes ()));
 	bytesConsumed += nextRecSize;
 	nextRecSize = -1;
 	return bytesConsumed != NUM_BYTES_USED;
 }
 
+void MyDB_PageRecIteratorAlt :: appendToBatch (MyDB_RecordBatch &intoMe) {
+
+	char *bytes = (char *) myPage->getBytes ();
+	char *pos = bytes + bytesConsumed;
+	char *end = bytes + NUM_BYTES_USED;
+
+	// skip the record that advance () moved to; if getCurrent () was not called on it, we
+	// don't know its size, so get it from the record itself
+	if (nextRecSize == -1 && pos != end)
+		nextRecSize = *((unsigned short *) pos);
+	if (nextRecSize > 0)
+		pos += nextRecSize;
+
+	// and copy records off of the page, until we run out of room or records
+	while (pos != end && !intoMe.isFull ())
+		pos = (char *) intoMe.appendBinary (pos);
+
+	// the next call to advance () will go to the record after the batch
+	bytesConsumed = pos - bytes;
+	nextRecSize = 0;
+}
+
 MyDB_PageRecIteratorAlt :: MyDB_PageRecIteratorAlt (MyDB_PageHandle myPageIn) {
 	bytesConsumed = sizeof (size_t) * 2;
 	myPage = myPageIn;
@@ -48,6 +48,11 @@ int MyDB_TableReaderWriter :: getNumPages () {
 	return forMe->lastPage () + 1;
 }
 
+void MyDB_TableReaderWriter :: setLastPage (int whichPage) {
+	forMe->setLastPage (whichPage);
+	lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
+}
+
 MyDB_PageReaderWriter MyDB_TableReaderWriter :: getPinned (size_t i) {
 	return MyDB_PageReaderWriter (true, *this, i);
 }
@@ -90,6 +95,17 @@ void MyDB_TableReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	}
 }
 
+void MyDB_TableReaderWriter :: appendBinary (void *appendMe) {
+
+	// same as above, but with the bytes
+	if (!lastPage->appendBinary (appendMe)) {
+		forMe->setLastPage (forMe->lastPage () + 1);
+		lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
+		lastPage->clear ();
+		lastPage->appendBinary (appendMe);
+	}
+}
+
 void MyDB_TableReaderWriter :: loadFromTextFile (string fName) {
 
 	// empty out the database file
@@ -32,9 +32,51 @@ bool MyDB_TableRecIteratorAlt :: advance () {
 	if (curPage == myTable->lastPage () || curPage == highPage)
 		return false;
 
+	nextPage ();
+	return advance ();
+}
+
+void MyDB_TableRecIteratorAlt :: appendToBatch (MyDB_RecordBatch &intoMe) {
+
+	while (true) {
+
+		// only regular pages have records on them (in a B+-Tree, the others are directory pages)
+		if (myParent[curPage].getType () == MyDB_PageType :: RegularPage)
+			myIter->appendToBatch (intoMe);
+
+		if (intoMe.isFull () || curPage == myTable->lastPage () || curPage == highPage)
+			return;
+
+		nextPage ();
+	}
+}
+
+void MyDB_TableRecIteratorAlt :: nextPage () {
+
 	curPage++;
 	myIter = myParent[curPage].getIteratorAlt ();
-	return advance ();
+
+	// if we read this page ahead, wait until it is in RAM, and then un-pin it
+	if (aheadPage != nullptr && aheadPageNum == curPage) {
+		aheadPage->getBytes ();
+		aheadPage->unpin ();
+		aheadPage = nullptr;
+	}
+	startReadAhead ();
+}
+
+void MyDB_TableRecIteratorAlt :: startReadAhead () {
+	if (!readAhead || aheadPage != nullptr || curPage == myTable->lastPage () || curPage == highPage)
+		return;
+	aheadPage = make_shared <MyDB_PageReaderWriter> (myParent, curPage + 1);
+	aheadPageNum = curPage + 1;
+	if (!aheadPage->prefetch ())
+		aheadPage = nullptr;
+}
+
+void MyDB_TableRecIteratorAlt :: setReadAhead (bool readAheadIn) {
+	readAhead = readAheadIn;
+	startReadAhead ();
 }
 
 MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn,
@@ -43,6 +85,7 @@ MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &my
 	myTable = myTableIn;
 	curPage = lowPage;
 	highPage = highPageIn;
+	readAhead = false;
 	myIter = myParent[curPage].getIteratorAlt ();		
 }
 
@@ -51,9 +94,13 @@ MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &my
 	myTable = myTableIn;
 	curPage = 0;
 	highPage = 1999999999;
+	readAhead = false;
 	myIter = myParent[curPage].getIteratorAlt ();		
 }
 
-MyDB_TableRecIteratorAlt :: ~MyDB_TableRecIteratorAlt () {}
+MyDB_TableRecIteratorAlt :: ~MyDB_TableRecIteratorAlt () {
+	if (aheadPage != nullptr)
+		aheadPage->unpin ();
+}
 
 #endif
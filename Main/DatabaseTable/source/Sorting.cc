@@ -2,12 +2,16 @@
 #ifndef SORT_C
 #define SORT_C
 
+#include <algorithm>
+#include <atomic>
 #include <queue>
+#include <thread>
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_TableRecIterator.h"
 #include "MyDB_TableRecIteratorAlt.h"
 #include "MyDB_TableReaderWriter.h"
-#include "IteratorComparator.h"
+#include "LoserTree.h"
+#include "RecordComparator.h"
 #include "Sorting.h"
 
 using namespace std;
@@ -15,35 +19,166 @@ using namespace std;
 void mergeIntoFile (MyDB_TableReaderWriter &sortIntoMe, vector <MyDB_RecordIteratorAltPtr> &mergeUs, 
 	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
 
-	// create the comparator and the priority queue
-	IteratorComparator temp (comparator, lhs, rhs);
-	priority_queue <MyDB_RecordIteratorAltPtr, vector <MyDB_RecordIteratorAltPtr>, IteratorComparator> pq (temp);
+	if (mergeUs.empty ())
+		return;
 
-	// load up the set
-	for (MyDB_RecordIteratorAltPtr m : mergeUs) {
-		if (m->advance ()) {
-			pq.push (m);
+	// the comparator only looks at lhs and rhs, so we remember which run's head is loaded into
+	// each of them.  The loser tree always calls lessThan (i, j) with j being the record that is
+	// being played up the tree; that record is left in whichever of lhs and rhs it is already in,
+	// so each game only has to deserialize the record that was waiting at the node (there is no
+	// way around that one, since the comparator only works on lhs and rhs).  If j is in lhs, we
+	// get "i before j" as "not j before i", so ties can go either way, which is fine for a merge
+	vector <bool> done (mergeUs.size ());
+	size_t inLhs = mergeUs.size (), inRhs = mergeUs.size ();
+	auto lessThan = [&] (size_t i, size_t j) {
+		if (done[i] || done[j])
+			return !done[i];
+		if (inLhs == j) {
+			if (inRhs != i) {
+				mergeUs[i]->getCurrent (rhs);
+				inRhs = i;
+			}
+			return !comparator ();
+		}
+		if (inLhs != i) {
+			mergeUs[i]->getCurrent (lhs);
+			inLhs = i;
+		}
+		if (inRhs != j) {
+			mergeUs[j]->getCurrent (rhs);
+			inRhs = j;
 		}
+		return comparator ();
+	};
+
+	for (size_t i = 0; i < mergeUs.size (); i++)
+		done[i] = !mergeUs[i]->advance ();
+	LoserTree <decltype (lessThan)> tree (mergeUs.size (), lessThan);
+
+	// and write everyone out, copying the bytes of each record
+	while (!done[tree.top ()]) {
+		size_t whichRun = tree.top ();
+		sortIntoMe.appendBinary (mergeUs[whichRun]->getCurrentPointer ());
+		done[whichRun] = !mergeUs[whichRun]->advance ();
+		if (inLhs == whichRun)
+			inLhs = mergeUs.size ();
+		if (inRhs == whichRun)
+			inRhs = mergeUs.size ();
+		tree.replay ();
+	}
+}
+
+// the normalized key of the record at the head of a run, cached for merging; most comparisons
+// only need to look at the first 8 bytes of the keys
+struct MyDB_HeadKey {
+
+	string key;
+	uint64_t prefix;
+	bool done;
+
+	void set (MyDB_SortKey &sortKey, void *rec) {
+		key.clear ();
+		sortKey.encode (rec, key);
+		prefix = MyDB_SortKey :: getPrefix (key.data (), key.size ());
+		done = false;
+	}
+
+	// a run that is done comes after everything else
+	bool operator < (const MyDB_HeadKey &rhs) const {
+		if (done || rhs.done)
+			return !done;
+		if (prefix != rhs.prefix)
+			return prefix < rhs.prefix;
+		return key < rhs.key;
 	}
+};
+
+// merges the runs, calling writeMe with each record in order
+template <class WriteFunc>
+static void mergeRuns (vector <MyDB_RecordIteratorAltPtr> &mergeUs, MyDB_SortKeyPtr key, WriteFunc writeMe) {
+
+	if (mergeUs.empty ())
+		return;
+
+	// get the key at the head of each run
+	vector <MyDB_HeadKey> heads (mergeUs.size ());
+	for (size_t i = 0; i < mergeUs.size (); i++) {
+		heads[i].done = !mergeUs[i]->advance ();
+		if (!heads[i].done)
+			heads[i].set (*key, mergeUs[i]->getCurrentPointer ());
+	}
+	auto lessThan = [&heads] (size_t i, size_t j) {
+		return heads[i] < heads[j];
+	};
+	LoserTree <decltype (lessThan)> tree (mergeUs.size (), lessThan);
 
 	// and write everyone out
-	int counter = 0;
-	while (pq.size () != 0) {
+	while (!heads[tree.top ()].done) {
+
+		// copy the dude to the output
+		size_t whichRun = tree.top ();
+		writeMe (mergeUs[whichRun]->getCurrentPointer ());
+
+		// and get the new key
+		if (mergeUs[whichRun]->advance ())
+			heads[whichRun].set (*key, mergeUs[whichRun]->getCurrentPointer ());
+		else
+			heads[whichRun].done = true;
+		tree.replay ();
+	}
+}
 
-		// write the dude to the output
-		auto myIter = pq.top ();
-		myIter->getCurrent (lhs);
-		sortIntoMe.append (lhs);
-		counter++;
+// turns on read-ahead for the runs being merged, as long as the merge still fits in numFrames pages: each
+// run then needs two (the one being read, and the one being read ahead), plus the page being written, and
+// the ones being written out in the background
+static void readAhead (vector <MyDB_RecordIteratorAltPtr> &mergeUs, size_t numFrames) {
+	if (mergeUs.size () * 2 + 1 + MAX_FLUSHING > numFrames)
+		return;
+	for (auto &iter : mergeUs)
+		iter->setReadAhead (true);
+}
 
-		// remove from the q
-		pq.pop ();
+// appends the record to the table; as soon as a page of the table is full, it is written back in
+// the background
+static void appendBinaryAndFlush (MyDB_TableReaderWriter &sortIntoMe, void *rec) {
+	int lastPage = sortIntoMe.getTable ()->lastPage ();
+	sortIntoMe.appendBinary (rec);
+	if (sortIntoMe.getTable ()->lastPage () != lastPage)
+		sortIntoMe[lastPage].flush ();
+}
 
-		// re-insert
-		if (myIter->advance ()) {
-			pq.push (myIter);
-		}
+void mergeIntoFile (MyDB_TableReaderWriter &sortIntoMe, vector <MyDB_RecordIteratorAltPtr> &mergeUs, MyDB_SortKeyPtr key) {
+	readAhead (mergeUs, sortIntoMe.getBufferMgr ()->getNumPages ());
+	mergeRuns (mergeUs, key, [&sortIntoMe] (void *rec) {
+		appendBinaryAndFlush (sortIntoMe, rec);
+	});
+}
+
+// if all of sortMe fits into numFrames pages of the buffer (with a few left over for writing the output),
+// there is no need for runs: all of its pages are pinned, the locations of all of its records are put
+// in order using sortThem, and the records are handed straight to writeMe.  Returns false, having
+// done nothing, if it does not fit
+template <class SortFunc, class WriteFunc>
+static bool sortInRAM (MyDB_TableReaderWriter &sortMe, size_t numFrames, SortFunc sortThem, WriteFunc writeMe) {
+
+	size_t numPages = sortMe.getNumPages ();
+	if (numPages + 4 > min (numFrames, sortMe.getBufferMgr ()->getNumUnpinnedPages ()))
+		return false;
+
+	vector <MyDB_PageReaderWriter> pinnedPages;
+	vector <void *> positions;
+	for (size_t i = 0; i < numPages; i++) {
+		pinnedPages.push_back (sortMe.getPinned (i));
+		pinnedPages.back ().getRecords (positions);
 	}
+
+	sortThem (positions);
+	for (void *pos : positions)
+		writeMe (pos);
+
+	for (auto &page : pinnedPages)
+		page.unpin ();
+	return true;
 }
 
 void appendRecord (MyDB_PageReaderWriter &curPage, vector <MyDB_PageReaderWriter> &returnVal, 
@@ -60,6 +195,60 @@ void appendRecord (MyDB_PageReaderWriter &curPage, vector <MyDB_PageReaderWriter
 	}
 }
 
+// like appendRecord, but copies the bytes of a serialized record
+static void appendBinary (MyDB_PageReaderWriter &curPage, vector <MyDB_PageReaderWriter> &returnVal, 
+	void *appendMe, MyDB_BufferManagerPtr parent) {
+
+	if (!curPage.appendBinary (appendMe)) {
+		returnVal.push_back (curPage);
+		MyDB_PageReaderWriter temp (*parent);
+		temp.appendBinary (appendMe);
+		curPage = temp;
+	}
+}
+
+vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB_RecordIteratorAltPtr leftIter, 
+	MyDB_RecordIteratorAltPtr rightIter, MyDB_SortKeyPtr key) {
+
+	vector <MyDB_PageReaderWriter> returnVal;
+	MyDB_PageReaderWriter curPage (*parent);
+
+	// get the key at the head of each list
+	string lhsKey, rhsKey;
+	bool lhsLeft = leftIter->advance ();
+	bool rhsLeft = rightIter->advance ();
+	if (lhsLeft)
+		key->encode (leftIter->getCurrentPointer (), lhsKey);
+	if (rhsLeft)
+		key->encode (rightIter->getCurrentPointer (), rhsKey);
+
+	// and repeatedly copy over the smaller one
+	while (lhsLeft && rhsLeft) {
+		if (lhsKey.compare (rhsKey) <= 0) {
+			appendBinary (curPage, returnVal, leftIter->getCurrentPointer (), parent);
+			lhsKey.clear ();
+			if ((lhsLeft = leftIter->advance ()))
+				key->encode (leftIter->getCurrentPointer (), lhsKey);
+		} else {
+			appendBinary (curPage, returnVal, rightIter->getCurrentPointer (), parent);
+			rhsKey.clear ();
+			if ((rhsLeft = rightIter->advance ()))
+				key->encode (rightIter->getCurrentPointer (), rhsKey);
+		}
+	}
+
+	// one of the lists is done, so copy the rest of the other one
+	MyDB_RecordIteratorAltPtr rest = lhsLeft ? leftIter : rightIter;
+	if (lhsLeft || rhsLeft) {
+		do {
+			appendBinary (curPage, returnVal, rest->getCurrentPointer (), parent);
+		} while (rest->advance ());
+	}
+
+	returnVal.push_back (curPage);
+	return returnVal;
+}
+
 vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB_RecordIteratorAltPtr leftIter, 
 	MyDB_RecordIteratorAltPtr rightIter, function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
 	
@@ -132,11 +321,11 @@ vector <MyDB_PageReaderWriter> mergeIntoList (MyDB_BufferManagerPtr parent, MyDB
 	return returnVal;
 }
 	
-void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, 
-	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
-
-	// this is the list of all of the pages in the file
-	vector <vector<MyDB_PageReaderWriter>> allPages;
+// does the first phase of the TPMMS: sorts each group of runSize pages (by sorting each page, and then
+// repeatedly merging pairs of sorted lists) and returns an iterator over each resulting run
+static vector <MyDB_RecordIteratorAltPtr> buildRuns (int runSize, MyDB_TableReaderWriter &sortMe,
+	function <MyDB_PageReaderWriterPtr (MyDB_PageReaderWriter &)> sortPage,
+	function <vector <MyDB_PageReaderWriter> (vector <MyDB_PageReaderWriter> &, vector <MyDB_PageReaderWriter> &)> mergeRuns) {
 
 	// this is the pages making up the current run
 	vector <vector<MyDB_PageReaderWriter>> pagesToSort;
@@ -144,14 +333,12 @@ void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &
 	// this is the list of all of the iterators, with one for each run
 	vector <MyDB_RecordIteratorAltPtr> runIters;
 	
-	int mySize = 0;
-
 	// process the file 
 	for (int i = 0; i < sortMe.getNumPages (); i++) {
 
 		// add this next page
 		vector <MyDB_PageReaderWriter> run;
-		run.push_back (*(sortMe[i].sort (comparator, lhs, rhs)));
+		run.push_back (*sortPage (sortMe[i]));
 		pagesToSort.push_back (run);
 
 		// if we are not done reading this run, go on to the next one
@@ -181,23 +368,641 @@ void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &
 				pagesToSort.pop_back ();
 		
 				// merge them
-				newPagesToSort.push_back (mergeIntoList (sortMe.getBufferMgr (), getIteratorAlt (runOne), 
-					getIteratorAlt (runTwo), comparator, lhs, rhs));
+				newPagesToSort.push_back (mergeRuns (runOne, runTwo));
 			}
 	
 			pagesToSort = newPagesToSort;
 		}
 
 		// now we have a single list, so create an iterator for it
-		mySize += pagesToSort[0].size ();
 		runIters.push_back (getIteratorAlt (pagesToSort[0]));
 
 		// and start over on the next run
 		pagesToSort.clear ();
 	}
+
+	return runIters;
+}
+
+void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, 
+	function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) {
+
+	// see if we can do it all at once
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+	if (sortInRAM (sortMe, parent->getNumPages (), [&] (vector <void *> &positions) {
+		std :: sort (positions.begin (), positions.end (), RecordComparator (comparator, lhs, rhs));
+	}, [&sortIntoMe] (void *rec) {
+		appendBinaryAndFlush (sortIntoMe, rec);
+	}))
+		return;
+
+	vector <MyDB_RecordIteratorAltPtr> runIters = buildRuns (runSize, sortMe,
+		[&] (MyDB_PageReaderWriter &page) {
+			return page.sort (comparator, lhs, rhs);
+		},
+		[&] (vector <MyDB_PageReaderWriter> &runOne, vector <MyDB_PageReaderWriter> &runTwo) {
+			return mergeIntoList (parent, getIteratorAlt (runOne), getIteratorAlt (runTwo), comparator, lhs, rhs);
+		});
 	
 	// and now, we are ready to merge everything
 	mergeIntoFile (sortIntoMe, runIters, comparator, lhs, rhs);
 }
 
+// with a sort key, there is no need to sort the pages one at a time and then merge them: we pin all
+// of the pages in a run, sort the locations of all of their records at once (which uses a radix sort
+// on the keys), and then copy the records out in order
+static vector <MyDB_RecordIteratorAltPtr> sortRunsInRAM (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_SortKeyPtr key) {
+
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+	vector <MyDB_RecordIteratorAltPtr> runIters;
+	vector <void *> positions;
+	for (int first = 0; first < sortMe.getNumPages (); first += runSize) {
+
+		// get all of the records in the run
+		vector <MyDB_PageReaderWriter> pinnedPages;
+		positions.clear ();
+		for (int i = first; i < first + runSize && i < sortMe.getNumPages (); i++) {
+			pinnedPages.push_back (sortMe.getPinned (i));
+			pinnedPages.back ().getRecords (positions);
+		}
+
+		// sort them, and write them out
+		key->sort (positions);
+		vector <MyDB_PageReaderWriter> run;
+		MyDB_PageReaderWriter curPage (*parent);
+		for (void *pos : positions)
+			appendBinary (curPage, run, pos, parent);
+		run.push_back (curPage);
+
+		runIters.push_back (getIteratorAlt (run));
+	}
+
+	return runIters;
+}
+
+void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key) {
+	if (sortInRAM (sortMe, sortMe.getBufferMgr ()->getNumPages (), [&key] (vector <void *> &positions) {
+		key->sort (positions);
+	}, [&sortIntoMe] (void *rec) {
+		appendBinaryAndFlush (sortIntoMe, rec);
+	}))
+		return;
+	vector <MyDB_RecordIteratorAltPtr> runIters = sortRunsInRAM (runSize, sortMe, key);
+	mergeIntoFile (sortIntoMe, runIters, key);
+}
+
+// the number of keys that the parallel sort samples from each run to pick the splitters
+#define SAMPLES_PER_RUN 128
+
+// a run written by the parallel sort: its pages, the key of the first record on each page (so
+// that a thread can quickly find where its part of the run starts), the number of records and
+// bytes on each page (so that a thread can count its part without reading most of the pages),
+// the size of the biggest record, and some sample keys
+struct MyDB_SortedRun {
+	vector <MyDB_PageReaderWriter> pages;
+	vector <string> firstKeys;
+	vector <size_t> pageRecs;
+	vector <size_t> pageBytes;
+	size_t maxRecSize = 0;
+	vector <string> samples;
+};
+
+// while several threads are using the buffer manager, we can only touch pinned pages; so this is
+// like appendBinary, except that the page being written is kept pinned until it is full.  Returns
+// true if the record went onto a new page
+static bool appendBinaryPinned (MyDB_PageReaderWriter &curPage, vector <MyDB_PageReaderWriter> &returnVal, 
+	void *appendMe, MyDB_BufferManagerPtr parent) {
+
+	if (curPage.appendBinary (appendMe))
+		return false;
+
+	curPage.unpin ();
+	returnVal.push_back (curPage);
+	curPage = MyDB_PageReaderWriter (true, *parent);
+	curPage.appendBinary (appendMe);
+	return true;
+}
+
+// walks through the records in one run whose keys are less than high (if there is a high),
+// keeping the current page pinned
+struct MyDB_RunCursor {
+
+	MyDB_SortedRun *run;
+	MyDB_SortKey *sortKey;
+	const string *high;
+
+	// where we are, and the key of the current record
+	size_t whichPage;
+	size_t whichRec;
+	vector <void *> recs;
+	bool pinned;
+	MyDB_HeadKey head;
+
+	// starts at the given page; next () must be called to get to the first record
+	void start (MyDB_SortedRun &runIn, MyDB_SortKey &keyIn, const string *highIn, size_t page) {
+		run = &runIn;
+		sortKey = &keyIn;
+		high = highIn;
+		whichPage = page;
+		whichRec = 0;
+		recs.clear ();
+		pinned = false;
+		head.done = true;
+	}
+
+	// moves to the next record; returns false (with nothing pinned) once we are done
+	bool next () {
+		whichRec++;
+		while (whichRec >= recs.size ()) {
+			if (pinned) {
+				run->pages[whichPage].unpin ();
+				pinned = false;
+				whichPage++;
+			}
+			if (whichPage >= run->pages.size ()) {
+				head.done = true;
+				return false;
+			}
+			run->pages[whichPage].pin ();
+			pinned = true;
+			recs.clear ();
+			run->pages[whichPage].getRecords (recs);
+			whichRec = 0;
+		}
+
+		head.set (*sortKey, recs[whichRec]);
+		if (high != nullptr && head.key >= *high) {
+			run->pages[whichPage].unpin ();
+			pinned = false;
+			head.done = true;
+			return false;
+		}
+		return true;
+	}
+};
+
+// adds the number of records in the run with keys from low up to high (if there is a low, and a high)
+// to numRecs, and their bytes to numBytes; only the pages where the range starts and ends are read
+static void countPart (MyDB_SortedRun &run, MyDB_SortKey &sortKey, const string *low, const string *high,
+	size_t &numRecs, size_t &numBytes) {
+
+	// the records on the page before the first one that starts at or after low might be in the range
+	vector <string> &firstKeys = run.firstKeys;
+	size_t page = 0;
+	if (low != nullptr) {
+		size_t pos = lower_bound (firstKeys.begin (), firstKeys.end (), *low) - firstKeys.begin ();
+		page = (pos == 0) ? 0 : pos - 1;
+	}
+
+	vector <void *> recs;
+	string recKey;
+	for (; page < firstKeys.size (); page++) {
+		if (high != nullptr && firstKeys[page] >= *high)
+			break;
+
+		// if the page starts at or after low, and the next one starts before high, all of it is in range
+		if ((low == nullptr || firstKeys[page] >= *low) && (high == nullptr ||
+			(page + 1 < firstKeys.size () && firstKeys[page + 1] < *high))) {
+			numRecs += run.pageRecs[page];
+			numBytes += run.pageBytes[page];
+			continue;
+		}
+
+		run.pages[page].pin ();
+		recs.clear ();
+		run.pages[page].getRecords (recs);
+		for (void *rec : recs) {
+			recKey.clear ();
+			sortKey.encode (rec, recKey);
+			if ((low == nullptr || recKey >= *low) && (high == nullptr || recKey < *high)) {
+				numRecs++;
+				numBytes += *((short *) rec);
+			}
+		}
+		run.pages[page].unpin ();
+	}
+}
+
+// the number of pages that a thread's part of the parallel sort's output gets.  When records are packed
+// onto pages in order, a page is only started when the next record does not fit on the last one, so each
+// page but the last has more than spacePerPage - maxRecSize bytes on it; this is enough pages for the
+// records in any order, and each of them can get at least one record
+static size_t partPages (size_t numRecs, size_t numBytes, size_t maxRecSize, size_t spacePerPage) {
+	return min (numRecs, numBytes / (spacePerPage - maxRecSize + 1) + 1);
+}
+
+// writes a thread's part of the parallel sort's output into numPages pages of the table (see partPages
+// ()), starting at firstPage, keeping the page being written pinned.  The records are packed onto the
+// pages as usual, except that once there are only as many records left as pages, each of the rest goes
+// onto a page of its own, so that every one of the pages is used
+struct MyDB_PartWriter {
+
+	MyDB_TableReaderWriter *table;
+	int nextPage;
+	size_t pagesLeft;
+	size_t recsLeft;
+	MyDB_PageReaderWriterPtr curPage;
+
+	void start (MyDB_TableReaderWriter &tableIn, int firstPage, size_t numPages, size_t numRecs) {
+		table = &tableIn;
+		nextPage = firstPage;
+		pagesLeft = numPages;
+		recsLeft = numRecs;
+	}
+
+	void write (void *rec) {
+		if (curPage == nullptr || recsLeft == pagesLeft || !curPage->appendBinary (rec)) {
+			if (curPage != nullptr)
+				curPage->unpin ();
+			curPage = make_shared <MyDB_PageReaderWriter> (true, *table, nextPage++);
+			curPage->clear ();
+			curPage->appendBinary (rec);
+			pagesLeft--;
+		}
+		recsLeft--;
+	}
+
+	// un-pins the last page
+	void finish () {
+		if (curPage != nullptr)
+			curPage->unpin ();
+		curPage = nullptr;
+	}
+};
+
+void sort (int runSize, MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key,
+	int numThreads) {
+
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+	int numPages = sortMe.getNumPages ();
+	int numBufferPages = parent->getNumPages ();
+	vector <MyDB_SortedRun> runs ((numPages + runSize - 1) / runSize);
+	if (runs.empty ())
+		return;
+
+	// first, sort the runs; each thread needs to pin a run, plus the page that it is writing
+	int numSorters = max (1, min ({numThreads, numBufferPages / (runSize + 1), (int) runs.size ()}));
+	atomic <size_t> nextRun (0);
+	auto sortRuns = [&] () {
+
+		MyDB_SortKey myKey (*key);
+		vector <void *> positions;
+		for (size_t whichRun; (whichRun = nextRun++) < runs.size ();) {
+
+			// get all of the records in the run
+			vector <MyDB_PageReaderWriter> pinnedPages;
+			positions.clear ();
+			for (int i = whichRun * runSize; i < (int) (whichRun + 1) * runSize && i < numPages; i++) {
+				pinnedPages.push_back (sortMe.getPinned (i));
+				pinnedPages.back ().getRecords (positions);
+			}
+
+			// sort them, and write them out
+			myKey.sort (positions);
+			MyDB_SortedRun &run = runs[whichRun];
+			MyDB_PageReaderWriter curPage (true, *parent);
+			size_t sampleEvery = max ((size_t) 1, positions.size () / SAMPLES_PER_RUN);
+			for (size_t i = 0; i < positions.size (); i++) {
+				if (appendBinaryPinned (curPage, run.pages, positions[i], parent) || i == 0) {
+					run.firstKeys.emplace_back ();
+					myKey.encode (positions[i], run.firstKeys.back ());
+					run.pageRecs.push_back (0);
+					run.pageBytes.push_back (0);
+				}
+				size_t recSize = *((short *) positions[i]);
+				run.pageRecs.back ()++;
+				run.pageBytes.back () += recSize;
+				run.maxRecSize = max (run.maxRecSize, recSize);
+				if (i % sampleEvery == 0) {
+					run.samples.emplace_back ();
+					myKey.encode (positions[i], run.samples.back ());
+				}
+			}
+			curPage.unpin ();
+			run.pages.push_back (curPage);
+		}
+	};
+
+	vector <thread> threads;
+	for (int i = 0; i < numSorters; i++)
+		threads.emplace_back (sortRuns);
+	for (auto &t : threads)
+		t.join ();
+	threads.clear ();
+
+	// now we merge; each thread needs a page for each run, plus the page that it is writing
+	int numMergers = max (1, min (numThreads, numBufferPages / ((int) runs.size () + 1)));
+	if (numMergers == 1) {
+		vector <MyDB_RecordIteratorAltPtr> runIters;
+		for (auto &run : runs)
+			runIters.push_back (getIteratorAlt (run.pages));
+		mergeIntoFile (sortIntoMe, runIters, key);
+		return;
+	}
+
+	// pick the splitters; thread i merges the keys from splitters[i - 1] up to splitters[i]
+	vector <string> allSamples;
+	for (auto &run : runs)
+		allSamples.insert (allSamples.end (), run.samples.begin (), run.samples.end ());
+	std :: sort (allSamples.begin (), allSamples.end ());
+	vector <string> splitters;
+	for (int i = 1; i < numMergers; i++)
+		splitters.push_back (allSamples.empty () ? string () : allSamples[i * allSamples.size () / numMergers]);
+
+	// count the records in each thread's key range, so that each thread can be given its own pages of
+	// the output, one after the other
+	vector <size_t> partRecs (numMergers), partBytes (numMergers);
+	auto countParts = [&] (int whichPart) {
+		MyDB_SortKey myKey (*key);
+		const string *low = (whichPart == 0) ? nullptr : &splitters[whichPart - 1];
+		const string *high = (whichPart == numMergers - 1) ? nullptr : &splitters[whichPart];
+		for (auto &run : runs)
+			countPart (run, myKey, low, high, partRecs[whichPart], partBytes[whichPart]);
+	};
+
+	for (int i = 0; i < numMergers; i++)
+		threads.emplace_back (countParts, i);
+	for (auto &t : threads)
+		t.join ();
+	threads.clear ();
+
+	// the output starts on the table's last page if that is empty, and on a new page if it is not;
+	// records can use all of a page but its header, which is two size_t's (see MyDB_PageReaderWriter)
+	vector <void *> lastRecs;
+	sortIntoMe.last ().getRecords (lastRecs);
+	int firstPage = sortIntoMe.getTable ()->lastPage () + (lastRecs.empty () ? 0 : 1);
+	size_t maxRecSize = 0;
+	for (auto &run : runs)
+		maxRecSize = max (maxRecSize, run.maxRecSize);
+	vector <MyDB_PartWriter> parts (numMergers);
+	int numOutPages = 0;
+	for (int i = 0; i < numMergers; i++) {
+		size_t numPartPages = partPages (partRecs[i], partBytes[i], maxRecSize, 
+			parent->getPageSize () - 2 * sizeof (size_t));
+		parts[i].start (sortIntoMe, firstPage + numOutPages, numPartPages, partRecs[i]);
+		numOutPages += numPartPages;
+	}
+
+	auto mergePart = [&] (int whichPart) {
+
+		MyDB_SortKey myKey (*key);
+		const string *low = (whichPart == 0) ? nullptr : &splitters[whichPart - 1];
+		const string *high = (whichPart == numMergers - 1) ? nullptr : &splitters[whichPart];
+
+		// find where our part of each run starts: the records on the page before the first one
+		// that starts at or after low might be at or after low as well
+		vector <MyDB_RunCursor> cursors (runs.size ());
+		for (size_t i = 0; i < runs.size (); i++) {
+			size_t page = 0;
+			if (low != nullptr) {
+				auto &firstKeys = runs[i].firstKeys;
+				size_t pos = lower_bound (firstKeys.begin (), firstKeys.end (), *low) - firstKeys.begin ();
+				page = (pos == 0) ? 0 : pos - 1;
+			}
+			cursors[i].start (runs[i], myKey, high, page);
+			bool more = cursors[i].next ();
+			while (more && low != nullptr && cursors[i].head.key < *low)
+				more = cursors[i].next ();
+		}
+
+		// and merge, straight into our pages of the output
+		auto lessThan = [&cursors] (size_t i, size_t j) {
+			return cursors[i].head < cursors[j].head;
+		};
+		LoserTree <decltype (lessThan)> tree (cursors.size (), lessThan);
+		while (!cursors[tree.top ()].head.done) {
+			MyDB_RunCursor &cursor = cursors[tree.top ()];
+			parts[whichPart].write (cursor.recs[cursor.whichRec]);
+			cursor.next ();
+			tree.replay ();
+		}
+		parts[whichPart].finish ();
+	};
+
+	for (int i = 0; i < numMergers; i++)
+		threads.emplace_back (mergePart, i);
+	for (auto &t : threads)
+		t.join ();
+
+	// last, the table ends with the last page of the output
+	if (numOutPages > 0)
+		sortIntoMe.setLastPage (firstPage + numOutPages - 1);
+}
+
+// a record that is being held in memory: the run that it will go into (or, for topK, when it was
+// seen), its key, and a copy of its bytes
+struct MyDB_HeldRecord {
+	size_t run;
+	MyDB_HeadKey head;
+	string bytes;
+};
+
+vector <vector <MyDB_PageReaderWriter>> makeRuns (MyDB_TableReaderWriter &sortMe, MyDB_SortKeyPtr key, int numFrames) {
+
+	// two frames are for reading (the current page, and the next one, which is read ahead),
+	// and one is for writing; the rest hold records
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+	size_t budget = max (1, numFrames - 3) * parent->getPageSize ();
+
+	// the records that we are holding, and a heap of them ordered by run, then key
+	vector <MyDB_HeldRecord> held;
+	vector <size_t> freeSlots;
+	auto cmp = [&held] (size_t lhs, size_t rhs) {
+		if (held[lhs].run != held[rhs].run)
+			return held[lhs].run > held[rhs].run;
+		return held[rhs].head < held[lhs].head;
+	};
+	priority_queue <size_t, vector <size_t>, decltype (cmp)> heap (cmp);
+	size_t bytesHeld = 0;
+
+	// the runs that we have written, and the one that we are writing
+	vector <vector <MyDB_PageReaderWriter>> runs;
+	vector <MyDB_PageReaderWriter> curRun;
+	MyDB_PageReaderWriter curPage (*parent);
+	size_t curRunNum = 0;
+	string lastKey;
+	bool wroteAny = false;
+
+	// writes out the smallest record that we are holding
+	auto writeSmallest = [&] () {
+		size_t slot = heap.top ();
+		heap.pop ();
+		MyDB_HeldRecord &rec = held[slot];
+
+		// see if this starts a new run
+		if (rec.run != curRunNum) {
+			curRun.push_back (curPage);
+			runs.push_back (curRun);
+			curRun.clear ();
+			curPage = MyDB_PageReaderWriter (*parent);
+			curRunNum = rec.run;
+		}
+		appendBinary (curPage, curRun, &rec.bytes[0], parent);
+		lastKey.swap (rec.head.key);
+		wroteAny = true;
+
+		bytesHeld -= rec.bytes.size () + lastKey.size () + sizeof (MyDB_HeldRecord);
+		freeSlots.push_back (slot);
+	};
+
+	MyDB_RecordIteratorAltPtr myIter = sortMe.getIteratorAlt ();
+	myIter->setReadAhead (true);
+	string nextRec;
+	while (myIter->advance ()) {
+
+		// copy the record right away, since writing records out can kick its page out of RAM
+		char *bytes = (char *) myIter->getCurrentPointer ();
+		nextRec.assign (bytes, *((short *) bytes));
+
+		// put it in a free slot
+		size_t slot;
+		if (freeSlots.empty ()) {
+			slot = held.size ();
+			held.emplace_back ();
+		} else {
+			slot = freeSlots.back ();
+			freeSlots.pop_back ();
+		}
+		MyDB_HeldRecord &rec = held[slot];
+		rec.bytes.swap (nextRec);
+		rec.head.set (*key, &rec.bytes[0]);
+		size_t size = rec.bytes.size () + rec.head.key.size () + sizeof (MyDB_HeldRecord);
+
+		// make room for it
+		while (bytesHeld + size > budget && !heap.empty ())
+			writeSmallest ();
+
+		// if it comes before the last record written, it has to wait for the next run
+		rec.run = curRunNum;
+		if (wroteAny && rec.head.key < lastKey)
+			rec.run++;
+		bytesHeld += size;
+		heap.push (slot);
+	}
+
+	// write out everything that is left
+	while (!heap.empty ())
+		writeSmallest ();
+	curRun.push_back (curPage);
+	runs.push_back (curRun);
+	return runs;
+}
+
+void sort (MyDB_TableReaderWriter &sortMe, MyDB_SortKeyPtr key, int numFrames, function <void (void *)> writeMe) {
+
+	// see if we can do it all at once
+	if (sortInRAM (sortMe, numFrames, [&key] (vector <void *> &positions) {
+		key->sort (positions);
+	}, writeMe))
+		return;
+
+	// each run being merged needs a frame, and so does the output, along with the output pages that are
+	// being written in the background.  With background I/O, each run also needs a frame for the page
+	// that is read ahead (see readAhead ()); we plan for that, so that every pass gets to read ahead,
+	// even though it means merging half as many runs at a time
+	MyDB_BufferManagerPtr parent = sortMe.getBufferMgr ();
+	int mergeFrames = numFrames - 1 - MAX_FLUSHING;
+	size_t fanIn = max (2, parent->getAsyncIO () ? mergeFrames / 2 : mergeFrames);
+	vector <vector <MyDB_PageReaderWriter>> runs = makeRuns (sortMe, key, numFrames);
+
+	// if there are too many runs, merge some of them first; we merge the smallest runs, and only
+	// as many as we need to, so that as little as possible is written more than once
+	while (runs.size () > fanIn) {
+		size_t numToMerge = min (fanIn, runs.size () - fanIn + 1);
+		std :: sort (runs.begin (), runs.end (), [] (const vector <MyDB_PageReaderWriter> &lhs,
+			const vector <MyDB_PageReaderWriter> &rhs) {
+			return lhs.size () < rhs.size ();
+		});
+
+		vector <MyDB_RecordIteratorAltPtr> runIters;
+		for (size_t i = 0; i < numToMerge; i++)
+			runIters.push_back (getIteratorAlt (runs[i]));
+
+		readAhead (runIters, numFrames);
+		vector <MyDB_PageReaderWriter> merged;
+		MyDB_PageReaderWriter curPage (*parent);
+		mergeRuns (runIters, key, [&] (void *rec) {
+			size_t numPages = merged.size ();
+			appendBinary (curPage, merged, rec, parent);
+			if (merged.size () != numPages)
+				merged.back ().flush ();
+		});
+		merged.push_back (curPage);
+
+		runIters.clear ();
+		runs.erase (runs.begin (), runs.begin () + numToMerge);
+		runs.push_back (merged);
+	}
+
+	// and do the final merge
+	vector <MyDB_RecordIteratorAltPtr> runIters;
+	for (auto &run : runs)
+		runIters.push_back (getIteratorAlt (run));
+	readAhead (runIters, numFrames);
+	mergeRuns (runIters, key, writeMe);
+}
+
+void sort (MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key, int numFrames) {
+	sort (sortMe, key, numFrames, [&sortIntoMe] (void *rec) {
+		appendBinaryAndFlush (sortIntoMe, rec);
+	});
+}
+
+void sort (MyDB_TableReaderWriter &sortMe, MyDB_TableReaderWriter &sortIntoMe, MyDB_SortKeyPtr key) {
+	sort (sortMe, sortIntoMe, key, sortMe.getBufferMgr ()->getNumPages () / 2);
+}
+
+void topK (size_t k, MyDB_RecordIteratorAltPtr topOfMe, MyDB_TableReaderWriter &intoMe, MyDB_SortKeyPtr key) {
+
+	if (k == 0)
+		return;
+
+	// the best records seen so far, in a heap with the one that comes last on top; when two keys are
+	// the same, the record that was seen first comes first
+	vector <MyDB_HeldRecord> held;
+	vector <size_t> heap;
+	auto comesFirst = [&held] (size_t lhs, size_t rhs) {
+		if (held[lhs].head < held[rhs].head)
+			return true;
+		if (held[rhs].head < held[lhs].head)
+			return false;
+		return held[lhs].run < held[rhs].run;
+	};
+
+	MyDB_HeadKey next;
+	for (size_t seen = 0; topOfMe->advance (); seen++) {
+
+		// once we have k records, the new one has to beat the last of them; most records do not, and
+		// all that we have done for them is to compute their keys
+		void *rec = topOfMe->getCurrentPointer ();
+		next.set (*key, rec);
+		size_t slot;
+		if (heap.size () == k) {
+			if (!(next < held[heap[0]].head))
+				continue;
+			pop_heap (heap.begin (), heap.end (), comesFirst);
+			slot = heap.back ();
+			heap.pop_back ();
+		} else {
+			slot = held.size ();
+			held.emplace_back ();
+		}
+
+		// the slot's strings are re-used, so once the heap is full, nothing is allocated
+		MyDB_HeldRecord &keepMe = held[slot];
+		keepMe.head.key.swap (next.key);
+		keepMe.head.prefix = next.prefix;
+		keepMe.head.done = false;
+		keepMe.bytes.assign ((char *) rec, *((short *) rec));
+		keepMe.run = seen;
+		heap.push_back (slot);
+		push_heap (heap.begin (), heap.end (), comesFirst);
+	}
+
+	// and write them out in order
+	sort_heap (heap.begin (), heap.end (), comesFirst);
+	for (size_t slot : heap)
+		intoMe.appendBinary (&held[slot].bytes[0]);
+}
+
 #endif
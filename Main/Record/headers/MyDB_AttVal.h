@@ -3,6 +3,7 @@
 #define ATT_VAL_H
 
 #include <memory>
+#include "MyDB_Value.h"
 #include <string>
 #include <string.h>
 
@@ -33,6 +34,17 @@ public:
 	virtual MyDB_AttValPtr getCopy () = 0;
 	virtual void fromString (string &fromMe) = 0;
 	virtual void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) = 0;
+
+	// the type of the MyDB_Value that this attribute is decoded into
+	virtual MyDB_ValueType getValueType () = 0;
+
+	// set this attribute from a typed value (the value is copied, so it can be a view)
+	virtual void fromValue (const MyDB_Value &fromMe) = 0;
+
+	// get a typed version of this attribute without allocating; for a string, the result is a
+	// view over the buffered bytes (or over the string held by the attribute)
+	virtual MyDB_Value toValue () = 0;
+
 	virtual ~MyDB_AttVal ();
 
 	// this gets a pointer to our data... useful because we can avoid deserializing the record
@@ -96,6 +108,9 @@ public:
 	size_t hash () override;
 	MyDB_AttValPtr getCopy () override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	MyDB_ValueType getValueType () override;
+	void fromValue (const MyDB_Value &fromMe) override;
+	MyDB_Value toValue () override;
 	void set (int val);
 	MyDB_IntAttVal ();
 	~MyDB_IntAttVal ();
@@ -122,6 +137,9 @@ public:
 	void set (MyDB_AttValPtr toMe) override;
 	void fromString (string &fromMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	MyDB_ValueType getValueType () override;
+	void fromValue (const MyDB_Value &fromMe) override;
+	MyDB_Value toValue () override;
 	void set (double val);
 	MyDB_DoubleAttVal ();
 	~MyDB_DoubleAttVal ();
@@ -147,6 +165,9 @@ public:
 	size_t hash () override;
 	void set (MyDB_AttValPtr toMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	MyDB_ValueType getValueType () override;
+	void fromValue (const MyDB_Value &fromMe) override;
+	MyDB_Value toValue () override;
 	void fromInt (int fromMe) override;
 	void set (string val);
 	MyDB_StringAttVal ();
@@ -174,6 +195,9 @@ public:
 	size_t hash () override;
 	void fromInt (int fromMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	MyDB_ValueType getValueType () override;
+	void fromValue (const MyDB_Value &fromMe) override;
+	MyDB_Value toValue () override;
 	void set (bool val);
 	MyDB_BoolAttVal ();
 	~MyDB_BoolAttVal ();
@@ -0,0 +1,101 @@
+
+#ifndef BATCH_COMPUTATION_H
+#define BATCH_COMPUTATION_H
+
+#include "MyDB_ByteCode.h"
+#include "MyDB_RecordBatch.h"
+#include "MyDB_Schema.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// create a smart pointer for batch computations
+class MyDB_BatchComputation;
+typedef shared_ptr <MyDB_BatchComputation> MyDB_BatchComputationPtr;
+
+// this runs a computation (written in the same syntax as MyDB_Record :: compileComputation ())
+// over an entire MyDB_RecordBatch at a time.  The computation is compiled into the same typed
+// instructions used by MyDB_ByteCode, but here each instruction is run as a tight, type-specific
+// loop over all of the rows in the batch, so that the cost of interpreting the program is paid
+// once per batch rather than once per record (and the loops can be vectorized by the compiler).
+// && and || still short-circuit: the right-hand side is only computed over the rows of the
+// batch that the left-hand side did not decide.  For example:
+//
+// MyDB_BatchComputation pred (mySchema, "&& (> ([acctbal], double[4000.5]), == ([nationkey], int[3]))");
+// vector <uint32_t> selection;
+// pred.filter (myBatch, selection);
+// for (uint32_t i : selection)
+// 	myBatch.getRecord (i, myRec) ...
+//
+// Integer division by zero gives a zero here, rather than crashing.
+class MyDB_BatchComputation {
+
+public:
+
+	// compile the computation over batches with the given schema
+	MyDB_BatchComputation (MyDB_SchemaPtr forMe, string computation);
+
+	// runs the computation (which must produce a boolean) over the batch, and puts the
+	// numbers of the rows where it is true into the selection vector, in order
+	void filter (MyDB_RecordBatch &overMe, vector <uint32_t> &selection);
+
+	// runs the computation over the batch; after this, getResult () can be used to get the
+	// result for each row
+	void run (MyDB_RecordBatch &overMe);
+
+	// get the result for a particular row, from the last call to run () or filter (); as usual,
+	// a string is a view that is only good until the next run
+	MyDB_Value getResult (size_t whichRow);
+
+	// the type of the result
+	MyDB_AttTypePtr getType ();
+
+private:
+
+	// a register holds a column of values (or just one value, if it is a constant); data
+	// points at the values, which are either in the batch, in the compiled program (for a
+	// constant), or in the storage held by the register itself
+	struct MyDB_BatchReg {
+		MyDB_ValueType type;
+		bool isConstant;
+		const void *data;
+		vector <int64_t> ints;
+		vector <double> doubles;
+		vector <char> bools;
+		vector <MyDB_Value> strings;
+		vector <string> stringBytes;
+	};
+
+	// get the value in a register at the given row
+	MyDB_Value valueAt (MyDB_BatchReg &fromMe, size_t whichRow);
+
+	// makes sure that all of the registers computed by the program can hold this many rows
+	void reserve (size_t numRows);
+
+	// when we get to a jump over the right-hand side of an && or ||, we remember where it goes,
+	// and which rows we were computing over, so that we can go back to those rows once we get there
+	struct MyDB_BatchJump {
+		size_t target;
+		const uint32_t *sel;
+		size_t count;
+	};
+
+	// the compiled program
+	MyDB_ByteCodePtr code;
+
+	// and the registers it runs over
+	vector <MyDB_BatchReg> regs;
+
+	// the jumps we are inside of, and the rows that we are computing over inside of each one
+	vector <MyDB_BatchJump> jumps;
+	vector <vector <uint32_t>> selections;
+
+	// the number of rows that the registers can hold, and the number in the last batch
+	size_t allocated;
+	size_t lastSize;
+};
+
+#endif
@@ -0,0 +1,99 @@
+
+#ifndef BATCH_PREDICATE_H
+#define BATCH_PREDICATE_H
+
+#include "MyDB_BatchComputation.h"
+#include "MyDB_PredicateKernels.h"
+#include "MyDB_RecordBatch.h"
+#include "MyDB_Schema.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// create a smart pointer for batch predicates
+class MyDB_BatchPredicate;
+typedef shared_ptr <MyDB_BatchPredicate> MyDB_BatchPredicatePtr;
+
+// this is a selection predicate in conjunctive normal form (such as the allDisjunctions list that
+// SFWQuery builds), that is run over an entire MyDB_RecordBatch at a time.  Each clause is a
+// computation written in the same syntax as MyDB_Record :: compileComputation ().  Comparisons
+// of an int or double attribute against a literal (=, !=, <, >), and the ||, && and ! of those,
+// are run using the vectorized kernels in MyDB_PredicateKernels; a pair of clauses that put a
+// lower and an upper bound on the same attribute is run as a single BETWEEN.  Anything else
+// is run using a MyDB_BatchComputation.  For example:
+//
+// MyDB_BatchPredicate pred (mySchema, {"> ([acctbal], double[4000.5])", "< ([acctbal], double[5000.0])",
+// 	"|| (== ([nationkey], int[3]), == ([nationkey], int[7]))"});
+// vector <uint32_t> selection;
+// pred.filter (myBatch, selection);
+class MyDB_BatchPredicate {
+
+public:
+
+	// compile the clauses, which are all and-ed together, over batches with the given schema
+	MyDB_BatchPredicate (MyDB_SchemaPtr forMe, vector <string> clauses);
+
+	// runs the predicate over the batch, and puts the numbers of the rows where it is true
+	// into the selection vector, in order
+	void filter (MyDB_RecordBatch &overMe, vector <uint32_t> &selection);
+
+	// runs the predicate over the batch, and sets the bits (see MyDB_PredicateKernels) for
+	// the rows where it is true
+	void evaluate (MyDB_RecordBatch &overMe, vector <uint64_t> &bits);
+
+	// the number of clauses (after putting the BETWEENs together), and the number of those
+	// that are run entirely using the kernels
+	size_t getNumClauses ();
+	size_t getNumKernelClauses ();
+
+private:
+
+	// each clause is compiled into a little tree of these
+	struct MyDB_PredicateNode {
+
+		// a comparison run using a kernel, the and/or/not of the children, or a computation
+		// that we could not use a kernel for
+		enum {Compare, And, Or, Not, Computation} kind;
+
+		// for a comparison: the attribute, its type, the comparison, and the literal(s)
+		int whichAtt;
+		bool isDouble;
+		MyDB_CompareOp op;
+		int64_t intVal, intHigh;
+		double doubleVal, doubleHigh;
+
+		vector <MyDB_PredicateNode> children;
+		MyDB_BatchComputationPtr computation;
+	};
+
+	// compiles a clause
+	MyDB_PredicateNode compile (string clause);
+
+	// tries to turn the comparison into a kernel comparison
+	bool compileCompare (string op, string lhs, string rhs, MyDB_PredicateNode &intoMe);
+
+	// puts the lower and upper bounds on the same attribute together into BETWEENs
+	void findBetweens ();
+
+	// true if the node (and everything under it) uses the kernels
+	bool usesKernels (MyDB_PredicateNode &checkMe);
+
+	// runs a node over the batch, putting the result into out
+	void run (MyDB_PredicateNode &runMe, MyDB_RecordBatch &overMe, uint64_t *out, size_t depth);
+
+	MyDB_SchemaPtr mySchema;
+	vector <MyDB_PredicateNode> clauses;
+
+	// space for the intermediate bitmaps, one for each level of the trees, and for the
+	// selection vectors used by the computations
+	vector <vector <uint64_t>> scratch;
+	vector <uint32_t> scratchSelection;
+
+	// the bitmap used by filter ()
+	vector <uint64_t> filterBits;
+};
+
+#endif
@@ -0,0 +1,139 @@
+
+#ifndef BYTE_CODE_H
+#define BYTE_CODE_H
+
+#include "MyDB_AttType.h"
+#include "MyDB_Record.h"
+#include "MyDB_Value.h"
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// create a smart pointer for compiled programs
+class MyDB_ByteCode;
+typedef shared_ptr <MyDB_ByteCode> MyDB_ByteCodePtr;
+
+// the instructions understood by the interpreter.  Every instruction is fully typed (the
+// compiler figures out all of the promotions), so the interpreter never looks at a type tag
+enum class MyDB_OpCode : unsigned char {
+
+	// conversions: reg[dest] = (double) reg[lhs], and reg[dest] = reg[lhs] rendered as a string
+	IntToDouble, ToString,
+
+	// arithmetic: reg[dest] = reg[lhs] op reg[rhs]
+	AddInt, AddDouble, Concat, SubInt, SubDouble, MulInt, MulDouble, DivInt, DivDouble,
+	NegInt, NegDouble,
+
+	// comparisons: reg[dest] = reg[lhs] op reg[rhs]
+	GtInt, GtDouble, GtString, LtInt, LtDouble, LtString,
+	EqInt, EqDouble, EqBool, EqString, NeqInt, NeqDouble, NeqBool, NeqString,
+
+	// reg[dest] = !reg[lhs], and reg[dest] = reg[lhs]
+	Not, Move,
+
+	// used to short-circuit && and ||: if reg[lhs] is false (resp. true), then reg[dest] gets
+	// that value and we jump to instruction number rhs
+	JumpIfFalse, JumpIfTrue
+};
+
+// a single instruction; the operands are all register numbers (or a jump target)
+struct MyDB_Instruction {
+	MyDB_OpCode op;
+	unsigned short dest;
+	unsigned short lhs;
+	unsigned short rhs;
+};
+
+// this is a compiled version of a computation over a record; it accepts exactly the same
+// syntax as MyDB_Record :: compileComputation (), and gives exactly the same answer, but
+// rather than building a tree of lambdas (one indirect call per node, per record), it compiles
+// the computation into a flat list of typed instructions over a register file, which are
+// then run by a single interpreter loop.  For example:
+//
+// MyDB_ByteCode pred (myRec, "&& (> ([acctbal], double[4000.5]), == ([nationkey], int[3]))");
+// while (myIter->advance ()) {
+//	myIter->getCurrent (myRec);
+//	if (pred.run ().boolVal) ...
+// }
+//
+// As with compileComputation (), the program is always run over the CURRENT contents of
+// the record that it was compiled against.
+class MyDB_ByteCode {
+
+public:
+
+	// compile the computation over the given record
+	MyDB_ByteCode (MyDB_RecordPtr overMe, string computation);
+
+	// run the program over the current contents of the record; if the result is a string,
+	// it is a view that is only good until the next run, or until the record is changed
+	const MyDB_Value &run ();
+
+	// the type of the result
+	MyDB_AttTypePtr getType ();
+
+	// returns a function that can be used wherever a lambda from compileComputation () is
+	// expected; as with compileComputation (), the one result attribute is re-used over calls
+	func getFunc ();
+
+private:
+
+	// the record we are reading from
+	MyDB_RecordPtr myRec;
+
+	// the program, and the register file that it runs over.  Registers that hold literals
+	// (or the result of folding literals) are filled in once, at compile time
+	vector <MyDB_Instruction> program;
+	vector <MyDB_Value> regs;
+
+	// the bytes for any string held in a register that is not a view into the record; this is
+	// a deque so that adding registers never moves the bytes that a register is looking at
+	deque <string> regStrings;
+
+	// the attributes used by the program (each one gets a single register, which is loaded
+	// before the program is run), as (attribute, register) pairs
+	vector <pair <int, unsigned short>> loads;
+
+	// the register holding the final result, and its type
+	unsigned short result;
+	MyDB_AttTypePtr resultType;
+
+	// true for each register whose value is known at compile time
+	vector <bool> isConstant;
+
+	// the compiler; each returns the register that the result will be in, and its type
+	pair <unsigned short, MyDB_AttTypePtr> compile (char * &vals);
+	pair <unsigned short, MyDB_AttTypePtr> compileBinary (string op, pair <unsigned short, MyDB_AttTypePtr> lhs,
+		pair <unsigned short, MyDB_AttTypePtr> rhs);
+	pair <unsigned short, MyDB_AttTypePtr> compileUnary (string op, pair <unsigned short, MyDB_AttTypePtr> lhs);
+	pair <unsigned short, MyDB_AttTypePtr> compileShortCircuit (bool isAnd, char * &vals);
+
+	// get a new register
+	unsigned short newReg (MyDB_ValueType ofType);
+
+	// adds an instruction; if all of its inputs are constant, the instruction is run right
+	// away, and its output is made into a constant, rather than adding it to the program
+	unsigned short emit (MyDB_OpCode op, MyDB_ValueType resType, unsigned short lhs, unsigned short rhs);
+
+	// converts the given register to a double/string
+	unsigned short toDouble (pair <unsigned short, MyDB_AttTypePtr> fromMe);
+	unsigned short toStr (pair <unsigned short, MyDB_AttTypePtr> fromMe);
+
+	// the interpreter: runs the given instructions over the given registers
+	static void execute (const MyDB_Instruction *code, size_t len, MyDB_Value *r, deque <string> &regStrings);
+
+	// helper function for the compilation
+	char *findsymbol (char val, char *input);
+
+	// runs our programs a batch at a time
+	friend class MyDB_BatchComputation;
+
+	// we hold views into our own registers, so we cannot be copied
+	MyDB_ByteCode (const MyDB_ByteCode &) = delete;
+	MyDB_ByteCode &operator = (const MyDB_ByteCode &) = delete;
+};
+
+#endif
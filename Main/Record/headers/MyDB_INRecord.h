@@ -16,6 +16,7 @@ public:
 	MyDB_INRecord (MyDB_AttValPtr myAtt) : MyDB_Record (nullptr) {
 		values.push_back (myAtt);
 		values.push_back (make_shared <MyDB_IntAttVal> ());	
+		resetTypes ();
 		bufferOld = true;
 	}
 
@@ -0,0 +1,78 @@
+
+#ifndef PREDICATE_KERNELS_H
+#define PREDICATE_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// the comparisons that there are kernels for; Between checks low <= val <= high
+enum class MyDB_CompareOp {Equal, NotEqual, LessThan, GreaterThan, Between};
+
+// the instruction sets that the kernels can be run with
+enum class MyDB_KernelLevel {Scalar, SSE, AVX2};
+
+// these are hand-vectorized kernels that compare a column of numbers (such as a column in a
+// MyDB_RecordBatch) against a constant, producing a bitmap with one bit per row: bit (i % 64)
+// of word (i / 64) is set iff row i passes.  Bits past the end of the column are always zero.
+// When the class is first used, it checks what the CPU supports, and uses AVX2 or SSE4.2
+// instructions if it can; otherwise (or on a machine that is not x86) it uses plain loops.
+// Bitmaps can then be combined using andBits (), orBits () and notBits (), and turned into
+// a selection vector (the numbers of the rows that passed) using toSelection ().  For example:
+//
+// vector <uint64_t> bits (MyDB_PredicateKernels :: numWords (batch.size ()));
+// vector <uint64_t> more (bits.size ());
+// MyDB_PredicateKernels :: compare (batch.getInts (0), batch.size (), MyDB_CompareOp :: Between, 10, 20, bits.data ());
+// MyDB_PredicateKernels :: compare (batch.getDoubles (5), batch.size (), MyDB_CompareOp :: GreaterThan, 4000.0, 0, more.data ());
+// MyDB_PredicateKernels :: andBits (bits.data (), more.data (), batch.size ());
+//
+// As in C++, a comparison with a NaN is false, except for NotEqual, which is true.
+class MyDB_PredicateKernels {
+
+public:
+
+	// compare each of the numRows values in the column with val (or for Between, check if it
+	// is from val to high, inclusive), and write the resulting bits into out, which must have
+	// room for numWords (numRows) words.  high is ignored by all of the other comparisons
+	static void compare (const int32_t *col, size_t numRows, MyDB_CompareOp op, int32_t val, int32_t high, uint64_t *out);
+	static void compare (const int64_t *col, size_t numRows, MyDB_CompareOp op, int64_t val, int64_t high, uint64_t *out);
+	static void compare (const double *col, size_t numRows, MyDB_CompareOp op, double val, double high, uint64_t *out);
+
+	// intoMe = intoMe & other, intoMe = intoMe | other, and bits = !bits
+	static void andBits (uint64_t *intoMe, const uint64_t *other, size_t numRows);
+	static void orBits (uint64_t *intoMe, const uint64_t *other, size_t numRows);
+	static void notBits (uint64_t *bits, size_t numRows);
+
+	// sets all of the bits to zero, or one
+	static void setBits (uint64_t *bits, size_t numRows, bool toMe);
+
+	// writes the numbers of the rows whose bits are set into selection (which needs room for
+	// numRows entries) in order, and returns how many there were
+	static size_t toSelection (const uint64_t *bits, size_t numRows, uint32_t *selection);
+
+	// and goes the other way
+	static void fromSelection (const uint32_t *selection, size_t count, size_t numRows, uint64_t *bits);
+
+	// the number of rows whose bits are set
+	static size_t countBits (const uint64_t *bits, size_t numRows);
+
+	// true if no bits are set
+	static bool noneSet (const uint64_t *bits, size_t numRows);
+
+	// the number of words in a bitmap over this many rows
+	static size_t numWords (size_t numRows) {
+		return (numRows + 63) / 64;
+	}
+
+	// the instruction set that the kernels are using, and the best one that this machine has
+	static MyDB_KernelLevel getLevel ();
+	static MyDB_KernelLevel getBestLevel ();
+
+	// makes the kernels use a particular instruction set (for testing and benchmarking); if the
+	// machine does not support it, the best one that it does support is used instead
+	static void setLevel (MyDB_KernelLevel toMe);
+
+	// the name of an instruction set, for printing
+	static const char *getLevelName (MyDB_KernelLevel forMe);
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include <functional>
 #include "MyDB_AttVal.h"
 #include "MyDB_Schema.h"
+#include "MyDB_Value.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +19,24 @@ typedef shared_ptr <MyDB_Record> MyDB_RecordPtr;
 // a lambda function over the record... computes an attribute value
 typedef function <MyDB_AttValPtr ()> func;
 
+// a lambda function over the record... computes a typed value; this is what compiled
+// computations are built out of, since producing a MyDB_Value never allocates
+typedef function <MyDB_Value ()> valFunc;
+
+// one of the keys that the multi-key buildRecordComparator orders records on: a computation (in the
+// same syntax as compileComputation), whether it is ascending, and where the nulls go.  There are
+// no null attributes, so for now the only "null" is a double computation that comes out as NaN;
+// without this, a NaN compares as equal to everything, and sorting on it is undefined
+struct MyDB_CompareKey {
+
+	MyDB_CompareKey (string computationIn, bool ascendingIn = true, bool nullsFirstIn = false) :
+		computation (computationIn), ascending (ascendingIn), nullsFirst (nullsFirstIn) {}
+
+	string computation;
+	bool ascending;
+	bool nullsFirst;
+};
+
 class MyDB_Record {
 
 public:
@@ -109,12 +128,39 @@ public:
 	// used by the method compileComputation above
 	friend function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation);
 
+	// the same, but the records are ordered on a list of keys: the first key decides, unless lhs and rhs
+	// tie on it, in which case the second key decides, and so on.  Each key is compiled once, and the
+	// comparison for its type (and direction) is picked here, rather than every time that the function
+	// is called; a key that is just an attribute (such as "[acctbal]") is read straight out of the
+	// record.  For example, to sort on nationkey descending and then acctbal ascending:
+	//
+	// buildRecordComparator (lhs, rhs, {{"[nationkey]", false}, {"[acctbal]", true}});
+	friend function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, vector <MyDB_CompareKey> keys);
+
+	// like the multi-key buildRecordComparator, but the function returns a number that is less than,
+	// equal to, or greater than zero, as lhs comes before, ties with, or comes after rhs (this is what
+	// a merge join needs, since it has to find the matches as well as the order)
+	friend function <int ()> buildRecordCompare (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, vector <MyDB_CompareKey> keys);
+
 	// access the schema
 	MyDB_SchemaPtr getSchema ();
 
 	// access a particular attribute
 	MyDB_AttValPtr getAtt (int whichAtt);
 
+	// access the typed value of a particular attribute.  This never allocates; if the attribute
+	// is a string, the returned value is a view into the attribute's bytes, so it is only good
+	// until the next time that the contents of the record are changed.  The value decoded by
+	// fromBinary () is used as long as the attribute is still buffered where it was decoded
+	// from; otherwise (the attribute was set, or it is shared with another record by buildFrom ()
+	// and that record was changed) it is read through the attribute
+	inline const MyDB_Value &getValue (int whichAtt) {
+		void *loc = values[whichAtt]->getDataPointer ();
+		if (loc == nullptr || loc != attLocs[whichAtt])
+			attVals[whichAtt] = values[whichAtt]->toValue ();
+		return attVals[whichAtt];
+	}
+
 private:
 
 	// for fast reading from a page; the contents of the record are simply copied into this buffer
@@ -127,29 +173,32 @@ private:
 	size_t recSize;
 
 	// helper function for the compilation
-	pair <func, MyDB_AttTypePtr> compileHelper (char * &vals);
+	pair <valFunc, MyDB_AttTypePtr> compileHelper (char * &vals);
 
 	// helper function for the compilation
 	char *findsymbol (char val, char *input);
 	
 	// these functions are all used to build up computations over the record
-	pair <func, MyDB_AttTypePtr> fromData (string attName);
-	pair <func, MyDB_AttTypePtr> plus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> minus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> times (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> divide (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> gt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> lt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> eq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> neq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> andd (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> orr (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs);
-	pair <func, MyDB_AttTypePtr> unaryMinus (pair <func, MyDB_AttTypePtr> lhs);
-	pair <func, MyDB_AttTypePtr> nott (pair <func, MyDB_AttTypePtr> lhs);
+	pair <valFunc, MyDB_AttTypePtr> fromData (string attName);
+	pair <valFunc, MyDB_AttTypePtr> plus (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> minus (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> times (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> divide (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> gt (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> lt (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> eq (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> neq (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> andd (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> orr (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs);
+	pair <valFunc, MyDB_AttTypePtr> unaryMinus (pair <valFunc, MyDB_AttTypePtr> lhs);
+	pair <valFunc, MyDB_AttTypePtr> nott (pair <valFunc, MyDB_AttTypePtr> lhs);
 
 	// write the current attribute values into the buffer
 	void writeAttsToBuffer ();
 
+	// set up the list of attribute types (and the typed values) to match the list of attributes
+	void resetTypes ();
+
 	// true when the set of attributes don't match the attribute buffer
 	bool bufferOld;
 
@@ -158,7 +207,12 @@ private:
 
 	MyDB_SchemaPtr mySchema;
 	vector <MyDB_AttValPtr> values;	
-	vector <MyDB_AttValPtr> scratch;
+
+	// the typed version of each of the attributes, along with its type, and where in the buffer
+	// it was decoded from (nullptr if it was not)
+	vector <MyDB_Value> attVals;
+	vector <MyDB_ValueType> attTypes;
+	vector <void *> attLocs;
 
 };
 
@@ -0,0 +1,108 @@
+
+#ifndef RECORD_BATCH_H
+#define RECORD_BATCH_H
+
+#include "MyDB_Record.h"
+#include "MyDB_Schema.h"
+#include "MyDB_Value.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// create a smart pointer for record batches
+class MyDB_RecordBatch;
+typedef shared_ptr <MyDB_RecordBatch> MyDB_RecordBatchPtr;
+
+// this holds a batch of records (1024 by default) in columnar form, so that computations
+// can be run a batch at a time (see MyDB_BatchComputation).  Each attribute is decoded into
+// its own array: ints into an int64_t array, doubles into a double array, bools into a char
+// array, and strings into an array of MyDB_Values that are views into the batch's own copy
+// of the records.  Since the batch keeps the serialized records, any row can be turned back
+// into a record using getRecord ().  A batch can also be created over just some of the
+// attributes (a projection); the other attributes are still kept in the serialized records,
+// but they are not decoded into columns
+class MyDB_RecordBatch {
+
+public:
+
+	// creates an empty batch that can hold records with the given schema
+	MyDB_RecordBatch (MyDB_SchemaPtr mySchema, size_t capacity = 1024);
+
+	// creates an empty batch that only decodes the named attributes into columns
+	MyDB_RecordBatch (MyDB_SchemaPtr mySchema, vector <string> projection, size_t capacity = 1024);
+
+	// empties out the batch; the memory is kept so that it can be re-used
+	void clear ();
+
+	// append a record to the batch; the record's contents are copied
+	void append (MyDB_RecordPtr appendMe);
+
+	// append a serialized record (such as one that is sitting on a page) to the batch; the
+	// bytes are copied, so the original location can change after this call.  Returns the
+	// location just past the record
+	void *appendBinary (void *fromHere);
+
+	// loads the record at the given row of the batch into the given record
+	void getRecord (size_t whichRow, MyDB_RecordPtr intoMe);
+
+	// get the serialized version of the record at the given row
+	void *getBinary (size_t whichRow);
+
+	// the number of records in the batch, and the number that it can hold
+	size_t size ();
+	size_t getCapacity ();
+	bool isFull ();
+
+	// access the schema
+	MyDB_SchemaPtr getSchema ();
+
+	// access the columns; only the one that matches the attribute's type can be used, and
+	// only if the attribute is in the projection
+	bool isProjected (int whichAtt);
+	MyDB_ValueType getType (int whichAtt);
+	const int64_t *getInts (int whichAtt);
+	const double *getDoubles (int whichAtt);
+	const char *getBools (int whichAtt);
+	const MyDB_Value *getStrings (int whichAtt);
+
+private:
+
+	// one of these for each attribute
+	struct MyDB_Column {
+		MyDB_ValueType type;
+		bool projected;
+		vector <int64_t> ints;
+		vector <double> doubles;
+		vector <char> bools;
+		vector <MyDB_Value> strings;
+	};
+
+	// sets up the columns; the ones for the attributes not in the projection stay empty
+	void makeColumns (vector <bool> &projected);
+
+	// gets space to hold a serialized record of the given size
+	char *allocate (size_t len);
+
+	// decodes the serialized record at the given location into the next row
+	void decodeRow (char *fromHere);
+
+	MyDB_SchemaPtr mySchema;
+	size_t capacity;
+	size_t numRows;
+
+	vector <MyDB_Column> columns;
+
+	// the serialized records; these are kept in a list of chunks (rather than in one big
+	// vector) so that adding a record never moves the bytes that the string columns point to
+	vector <vector <char>> chunks;
+	size_t curChunk;
+	size_t curUsed;
+
+	// where each of the rows is
+	vector <char *> rows;
+};
+
+#endif
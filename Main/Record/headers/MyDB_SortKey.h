@@ -0,0 +1,112 @@
+
+#ifndef SORT_KEY_H
+#define SORT_KEY_H
+
+#include "MyDB_Schema.h"
+#include "MyDB_Value.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// create a smart pointer for sort keys
+class MyDB_SortKey;
+typedef shared_ptr <MyDB_SortKey> MyDB_SortKeyPtr;
+
+// one of the attributes that records are sorted on
+struct MyDB_SortAtt {
+	int whichAtt;
+	MyDB_ValueType type;
+	bool ascending;
+};
+
+// this describes a sort order over records (one or more attributes, each ascending or descending),
+// and is able to turn the key of a serialized record into a normalized string of bytes: comparing
+// the normalized keys of two records using memcmp gives the same answer as comparing the records
+// attribute-by-attribute.  Ints are written as big-endian with the sign bit flipped, doubles have
+// their bits re-arranged so that they order correctly as unsigned integers, and strings are
+// written out followed by a zero; the bytes for a descending attribute are all flipped.
+//
+// Since the key is taken straight from the serialized bytes, the record never has to be
+// deserialized.  For sorting, the first 8 bytes of each key are packed into an integer next to
+// a pointer to the record, and these are put in order with a radix sort (so there are no
+// comparisons at all); only the records whose prefixes tie need their whole keys compared.
+// For example:
+//
+// MyDB_SortKey key (mySchema, {{"nationkey", true}, {"acctbal", false}});
+// key.sort (positions);
+class MyDB_SortKey {
+
+public:
+
+	// sort on the named attributes of records with the given schema; each name is paired with
+	// true (for ascending order) or false (for descending order)
+	MyDB_SortKey (MyDB_SchemaPtr forMe, vector <pair <string, bool>> atts);
+
+	// sort on the given attributes; this can be used for records without schemas (such as
+	// the MyDB_INRecords in a B+-Tree)
+	MyDB_SortKey (vector <MyDB_SortAtt> atts);
+
+	// appends the normalized key of the serialized record to the end of the string
+	void encode (void *rec, string &appendToMe);
+
+	// compares the keys of two serialized records; returns a number that is less than,
+	// equal to, or greater than zero, just like memcmp
+	int compare (void *lhs, void *rhs);
+
+	// sorts the list of serialized records by key
+	void sort (vector <void *> &recs);
+
+	// by default, sort () uses a radix sort on the key prefixes; this can turn that off, so that
+	// std :: sort is used instead (this is mostly for testing)
+	void setRadixSort (bool useIt);
+
+	// the first 8 bytes of the normalized key (padded with zeros) as an integer, so that
+	// comparing the prefixes of two keys gives the same answer as comparing their first
+	// 8 bytes using memcmp
+	static uint64_t getPrefix (const char *key, size_t len);
+
+	// true if the normalized key always has exactly the same number of bytes, which is
+	// at most 8; in this case, comparing the prefixes is the same as comparing the keys
+	bool prefixIsKey ();
+
+	// the attributes that we sort on
+	vector <MyDB_SortAtt> &getAtts ();
+
+private:
+
+	// appends the normalized version of the value
+	void encodeValue (const MyDB_Value &val, bool ascending, string &appendToMe);
+
+	// what we sort on
+	vector <MyDB_SortAtt> atts;
+
+	// the largest attribute number that we use
+	int maxAtt;
+
+	// true if the prefix is the whole key
+	bool fixedKey;
+
+	// true if we use a radix sort
+	bool useRadix;
+
+	// where each of the attributes is in the record being encoded
+	vector <char *> attLocs;
+
+	// space used for compare () and sort ()
+	string lhsKey, rhsKey, allKeys;
+	struct MyDB_KeyEntry {
+		uint64_t prefix;
+		uint32_t offset;
+		uint32_t len;
+		void *rec;
+	};
+	vector <MyDB_KeyEntry> entries, radixTemp;
+
+	// sorts the entries on their prefixes (this is stable)
+	void radixSort ();
+};
+
+#endif
@@ -0,0 +1,179 @@
+
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <string.h>
+
+using namespace std;
+
+// the type tag stored in each MyDB_Value
+enum class MyDB_ValueType : char {IntVal, DoubleVal, BoolVal, StringVal};
+
+// this is a compact, by-value version of an attribute value.  Unlike MyDB_AttVal, it is
+// never heap allocated and has no virtual methods, so records keep their decoded attributes
+// in a contiguous vector of these, and compiled computations pass them around by value.
+//
+// A string value does NOT own its bytes... it is just a (pointer, length) view over bytes
+// that are owned by someone else (typically the buffer inside of a MyDB_Record).  So a string
+// value is only good until its owner is changed (for example, until the next fromBinary ())
+struct MyDB_Value {
+
+	union {
+		int64_t intVal;
+		double doubleVal;
+		bool boolVal;
+		const char *strVal;
+	};
+
+	// the length of the string (only used by string values)
+	uint32_t strLen;
+
+	// what type of value this is
+	MyDB_ValueType type;
+
+	static inline MyDB_Value makeInt (int64_t fromMe) {
+		MyDB_Value returnVal;
+		returnVal.type = MyDB_ValueType :: IntVal;
+		returnVal.intVal = fromMe;
+		return returnVal;
+	}
+
+	static inline MyDB_Value makeDouble (double fromMe) {
+		MyDB_Value returnVal;
+		returnVal.type = MyDB_ValueType :: DoubleVal;
+		returnVal.doubleVal = fromMe;
+		return returnVal;
+	}
+
+	static inline MyDB_Value makeBool (bool fromMe) {
+		MyDB_Value returnVal;
+		returnVal.type = MyDB_ValueType :: BoolVal;
+		returnVal.boolVal = fromMe;
+		return returnVal;
+	}
+
+	static inline MyDB_Value makeString (const char *fromMe, size_t len) {
+		MyDB_Value returnVal;
+		returnVal.type = MyDB_ValueType :: StringVal;
+		returnVal.strVal = fromMe;
+		returnVal.strLen = (uint32_t) len;
+		return returnVal;
+	}
+
+	// decode a value of the given type from an attribute that was serialized by MyDB_AttVal;
+	// fromHere points at the short length that prefixes each serialized attribute
+	static inline MyDB_Value fromBinary (MyDB_ValueType whichType, char *fromHere) {
+		char *data = fromHere + sizeof (short);
+		switch (whichType) {
+			case MyDB_ValueType :: IntVal: return makeInt (*((int *) data));
+			case MyDB_ValueType :: DoubleVal: return makeDouble (*((double *) data));
+			case MyDB_ValueType :: BoolVal: return makeBool (*data == 1);
+			default: return makeString (data, *((short *) fromHere) - sizeof (short) - 1);
+		}
+	}
+
+	inline int64_t toInt () const {
+		if (type == MyDB_ValueType :: DoubleVal)
+			return (int64_t) doubleVal;
+		return intVal;
+	}
+
+	inline double toDouble () const {
+		if (type == MyDB_ValueType :: IntVal)
+			return (double) intVal;
+		return doubleVal;
+	}
+
+	inline bool toBool () const {
+		return boolVal;
+	}
+
+	// returns a string version of this value; if it is not a string, then it is rendered
+	// into the scratch string, and a view over the scratch string is returned
+	inline MyDB_Value asString (string &scratch) const {
+		if (type == MyDB_ValueType :: StringVal)
+			return *this;
+		scratch.clear ();
+		appendTo (scratch);
+		return makeString (scratch.data (), scratch.size ());
+	}
+
+	// appends a text version of this value to the given string; uses the same formatting
+	// as MyDB_AttVal :: toString ()
+	inline void appendTo (string &appendToMe) const {
+		switch (type) {
+			case MyDB_ValueType :: IntVal: appendToMe += to_string ((int) intVal); break;
+			case MyDB_ValueType :: DoubleVal: appendToMe += to_string (doubleVal); break;
+			case MyDB_ValueType :: BoolVal: appendToMe += (boolVal ? "true" : "false"); break;
+			default: appendToMe.append (strVal, strLen);
+		}
+	}
+
+	// allocates a string; only used off of the hot path (printing, etc.)
+	inline string toString () const {
+		string returnVal;
+		appendTo (returnVal);
+		return returnVal;
+	}
+
+	// loads the first (up to) eight bytes of a string as a big-endian integer, padded with zeros, so
+	// that comparing two prefixes as integers gives the same answer as memcmp on those bytes
+	static inline uint64_t stringPrefix (const char *str, uint32_t len) {
+		uint64_t returnVal = 0;
+		if (len >= sizeof (uint64_t))
+			memcpy (&returnVal, str, sizeof (uint64_t));
+		else
+			memcpy (&returnVal, str, len);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		returnVal = __builtin_bswap64 (returnVal);
+#endif
+		return returnVal;
+	}
+
+	// compares two string values, returning <0, 0, or >0 like strcmp does.  Most of the time,
+	// strings differ in the first few bytes, so we start with a single integer comparison of
+	// the prefixes, and only go to memcmp if those are the same
+	inline int compareString (const MyDB_Value &withMe) const {
+		uint64_t myPrefix = stringPrefix (strVal, strLen);
+		uint64_t otherPrefix = stringPrefix (withMe.strVal, withMe.strLen);
+		if (myPrefix != otherPrefix)
+			return myPrefix < otherPrefix ? -1 : 1;
+
+		// the prefixes match; since strings never contain a zero byte, if either one is that short, we are done
+		uint32_t len = strLen < withMe.strLen ? strLen : withMe.strLen;
+		if (len > sizeof (uint64_t)) {
+			int res = memcmp (strVal + sizeof (uint64_t), withMe.strVal + sizeof (uint64_t), len - sizeof (uint64_t));
+			if (res != 0)
+				return res;
+		}
+		return (strLen < withMe.strLen) ? -1 : (strLen > withMe.strLen);
+	}
+
+	inline bool equalsString (const MyDB_Value &withMe) const {
+		return strLen == withMe.strLen && memcmp (strVal, withMe.strVal, strLen) == 0;
+	}
+
+	// hashes this value without allocating; non-strings hash the same way that MyDB_AttVal always has
+	inline size_t hash () const {
+		switch (type) {
+			case MyDB_ValueType :: IntVal: return std :: hash <int> () ((int) intVal);
+			case MyDB_ValueType :: DoubleVal: return std :: hash <int> () ((int) doubleVal);
+			case MyDB_ValueType :: BoolVal: return std :: hash <int> () (boolVal);
+			default: {
+
+				// 64-bit FNV-1a over the bytes in the string
+				uint64_t returnVal = 14695981039346656037ULL;
+				for (uint32_t i = 0; i < strLen; i++) {
+					returnVal ^= (unsigned char) strVal[i];
+					returnVal *= 1099511628211ULL;
+				}
+				return (size_t) returnVal;
+			}
+		}
+	}
+};
+
+#endif
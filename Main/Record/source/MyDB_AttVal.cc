@@ -66,19 +66,19 @@ void MyDB_IntAttVal :: fromString (string &fromMe) {
 }
 
 size_t MyDB_IntAttVal :: hash () {
-	return std :: hash <int> () (toInt ());
+	return toValue ().hash ();
 }
 
 size_t MyDB_DoubleAttVal :: hash () {
-	return std :: hash <int> () (toDouble ());
+	return toValue ().hash ();
 }
 
 size_t MyDB_BoolAttVal :: hash () {
-	return std :: hash <int> () (toBool ());
+	return toValue ().hash ();
 }
 
 size_t MyDB_StringAttVal :: hash () {
-	return std :: hash <string> () (toString ());
+	return toValue ().hash ();
 }
 
 bool MyDB_IntAttVal :: toBool () {
@@ -328,4 +328,63 @@ MyDB_BoolAttVal :: MyDB_BoolAttVal () {
 
 MyDB_BoolAttVal :: ~MyDB_BoolAttVal () {}
 
+MyDB_ValueType MyDB_IntAttVal :: getValueType () {
+	return MyDB_ValueType :: IntVal;
+}
+
+void MyDB_IntAttVal :: fromValue (const MyDB_Value &fromMe) {
+	value = (int) fromMe.toInt ();
+	setNotBuffered ();
+}
+
+MyDB_Value MyDB_IntAttVal :: toValue () {
+	return MyDB_Value :: makeInt (toInt ());
+}
+
+MyDB_ValueType MyDB_DoubleAttVal :: getValueType () {
+	return MyDB_ValueType :: DoubleVal;
+}
+
+void MyDB_DoubleAttVal :: fromValue (const MyDB_Value &fromMe) {
+	value = fromMe.toDouble ();
+	setNotBuffered ();
+}
+
+MyDB_Value MyDB_DoubleAttVal :: toValue () {
+	return MyDB_Value :: makeDouble (toDouble ());
+}
+
+MyDB_ValueType MyDB_StringAttVal :: getValueType () {
+	return MyDB_ValueType :: StringVal;
+}
+
+void MyDB_StringAttVal :: fromValue (const MyDB_Value &fromMe) {
+	value.clear ();
+	fromMe.appendTo (value);
+	setNotBuffered ();
+}
+
+MyDB_Value MyDB_StringAttVal :: toValue () {
+	void *dataPtr = getDataPointer ();
+	if (dataPtr == nullptr) 
+		return MyDB_Value :: makeString (value.data (), value.size ());
+
+	// the serialized length (which counts the length itself and the terminating zero) is just before the data
+	short serializedLen = *((short *) (((char *) dataPtr) - sizeof (short)));
+	return MyDB_Value :: makeString ((char *) dataPtr, serializedLen - sizeof (short) - 1);
+}
+
+MyDB_ValueType MyDB_BoolAttVal :: getValueType () {
+	return MyDB_ValueType :: BoolVal;
+}
+
+void MyDB_BoolAttVal :: fromValue (const MyDB_Value &fromMe) {
+	value = fromMe.toBool ();
+	setNotBuffered ();
+}
+
+MyDB_Value MyDB_BoolAttVal :: toValue () {
+	return MyDB_Value :: makeBool (toBool ());
+}
+
 #endif
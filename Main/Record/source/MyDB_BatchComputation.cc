@@ -0,0 +1,329 @@
+
+#ifndef BATCH_COMPUTATION_C
+#define BATCH_COMPUTATION_C
+
+#include "MyDB_BatchComputation.h"
+#include <iostream>
+
+using namespace std;
+
+// these are the kernels.  Each is run either over all of the first n rows of the batch (if sel
+// is null), which is a simple loop that the compiler can vectorize, or over just the n rows listed
+// in sel.  Since constants are folded during compilation, at most one side is ever a constant
+template <class In, class Out, class Op>
+static inline void binaryKernel (const void *lhs, bool lConst, const void *rhs, bool rConst, Out *out, 
+	const uint32_t *sel, size_t n, Op op) {
+
+	const In *l = (const In *) lhs;
+	const In *r = (const In *) rhs;
+	if (sel == nullptr) {
+		if (lConst) {
+			In lVal = l[0];
+			for (size_t i = 0; i < n; i++)
+				out[i] = op (lVal, r[i]);
+		} else if (rConst) {
+			In rVal = r[0];
+			for (size_t i = 0; i < n; i++)
+				out[i] = op (l[i], rVal);
+		} else {
+			for (size_t i = 0; i < n; i++)
+				out[i] = op (l[i], r[i]);
+		}
+	} else {
+		size_t lMask = lConst ? 0 : ~((size_t) 0);
+		size_t rMask = rConst ? 0 : ~((size_t) 0);
+		for (size_t k = 0; k < n; k++) {
+			size_t i = sel[k];
+			out[i] = op (l[i & lMask], r[i & rMask]);
+		}
+	}
+}
+
+template <class In, class Out, class Op>
+static inline void unaryKernel (const void *lhs, Out *out, const uint32_t *sel, size_t n, Op op) {
+	const In *l = (const In *) lhs;
+	if (sel == nullptr) {
+		for (size_t i = 0; i < n; i++)
+			out[i] = op (l[i]);
+	} else {
+		for (size_t k = 0; k < n; k++)
+			out[sel[k]] = op (l[sel[k]]);
+	}
+}
+
+MyDB_BatchComputation :: MyDB_BatchComputation (MyDB_SchemaPtr forMe, string computation) {
+
+	// compile the program
+	code = make_shared <MyDB_ByteCode> (make_shared <MyDB_Record> (forMe), computation);
+
+	// and set up the registers
+	regs.resize (code->regs.size ());
+	for (size_t i = 0; i < regs.size (); i++) {
+		MyDB_Value &val = code->regs[i];
+		regs[i].type = val.type;
+		regs[i].isConstant = code->isConstant[i];
+		regs[i].data = nullptr;
+		if (regs[i].isConstant) {
+			switch (val.type) {
+				case MyDB_ValueType :: IntVal: regs[i].data = &val.intVal; break;
+				case MyDB_ValueType :: DoubleVal: regs[i].data = &val.doubleVal; break;
+				case MyDB_ValueType :: BoolVal: regs[i].data = &val.boolVal; break;
+				default: regs[i].data = &val;
+			}
+		}
+	}
+	allocated = 0;
+	lastSize = 0;
+}
+
+void MyDB_BatchComputation :: reserve (size_t numRows) {
+	if (numRows <= allocated)
+		return;
+
+	// note that the registers that hold attributes are pointed at the batch when we run
+	for (MyDB_BatchReg &reg : regs) {
+		if (reg.isConstant)
+			continue;
+		switch (reg.type) {
+			case MyDB_ValueType :: IntVal: reg.ints.resize (numRows); reg.data = reg.ints.data (); break;
+			case MyDB_ValueType :: DoubleVal: reg.doubles.resize (numRows); reg.data = reg.doubles.data (); break;
+			case MyDB_ValueType :: BoolVal: reg.bools.resize (numRows); reg.data = reg.bools.data (); break;
+			default:
+				reg.strings.resize (numRows);
+				reg.stringBytes.resize (numRows);
+				reg.data = reg.strings.data ();
+		}
+	}
+
+	// and there can be no more nested jumps than there are jumps
+	size_t numJumps = 0;
+	for (MyDB_Instruction &instr : code->program) {
+		if (instr.op == MyDB_OpCode :: JumpIfFalse || instr.op == MyDB_OpCode :: JumpIfTrue)
+			numJumps++;
+	}
+	jumps.resize (numJumps);
+	selections.resize (numJumps);
+	for (auto &sel : selections)
+		sel.resize (numRows);
+
+	allocated = numRows;
+}
+
+void MyDB_BatchComputation :: run (MyDB_RecordBatch &overMe) {
+
+	size_t n = overMe.size ();
+	reserve (n);
+	lastSize = n;
+
+	// point the attribute registers at the batch
+	for (auto &load : code->loads) {
+		MyDB_BatchReg &reg = regs[load.second];
+		if (!overMe.isProjected (load.first)) {
+			cout << "The computation uses an attribute that is not in the batch's projection.\n";
+			exit (1);
+		}
+		switch (reg.type) {
+			case MyDB_ValueType :: IntVal: reg.data = overMe.getInts (load.first); break;
+			case MyDB_ValueType :: DoubleVal: reg.data = overMe.getDoubles (load.first); break;
+			case MyDB_ValueType :: BoolVal: reg.data = overMe.getBools (load.first); break;
+			default: reg.data = overMe.getStrings (load.first);
+		}
+	}
+
+	// the rows that we are computing over (null means all of them)
+	const uint32_t *sel = nullptr;
+	size_t count = n;
+	size_t depth = 0;
+
+	// and run each instruction over the batch
+	vector <MyDB_Instruction> &program = code->program;
+	for (size_t pc = 0; pc < program.size (); pc++) {
+
+		// see if we are at the end of the right-hand side of an && or ||
+		while (depth > 0 && jumps[depth - 1].target == pc) {
+			depth--;
+			sel = jumps[depth].sel;
+			count = jumps[depth].count;
+		}
+
+		MyDB_Instruction &instr = program[pc];
+		MyDB_BatchReg &dest = regs[instr.dest];
+		MyDB_BatchReg &lhs = regs[instr.lhs];
+		MyDB_BatchReg &rhs = regs[instr.rhs];
+		const void *l = lhs.data, *r = rhs.data;
+		bool lc = lhs.isConstant, rc = rhs.isConstant;
+		int64_t *outInts = dest.ints.data ();
+		double *outDoubles = dest.doubles.data ();
+		char *outBools = dest.bools.data ();
+
+		switch (instr.op) {
+
+			case MyDB_OpCode :: IntToDouble:
+				unaryKernel <int64_t> (l, outDoubles, sel, count, [] (int64_t a) {return (double) a;}); break;
+			case MyDB_OpCode :: NegInt:
+				unaryKernel <int64_t> (l, outInts, sel, count, [] (int64_t a) {return -a;}); break;
+			case MyDB_OpCode :: NegDouble:
+				unaryKernel <double> (l, outDoubles, sel, count, [] (double a) {return -a;}); break;
+			case MyDB_OpCode :: Not:
+				unaryKernel <char> (l, outBools, sel, count, [] (char a) {return (char) !a;}); break;
+
+			case MyDB_OpCode :: AddInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outInts, sel, count, [] (int64_t a, int64_t b) {return a + b;}); break;
+			case MyDB_OpCode :: AddDouble:
+				binaryKernel <double> (l, lc, r, rc, outDoubles, sel, count, [] (double a, double b) {return a + b;}); break;
+			case MyDB_OpCode :: SubInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outInts, sel, count, [] (int64_t a, int64_t b) {return a - b;}); break;
+			case MyDB_OpCode :: SubDouble:
+				binaryKernel <double> (l, lc, r, rc, outDoubles, sel, count, [] (double a, double b) {return a - b;}); break;
+			case MyDB_OpCode :: MulInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outInts, sel, count, [] (int64_t a, int64_t b) {return a * b;}); break;
+			case MyDB_OpCode :: MulDouble:
+				binaryKernel <double> (l, lc, r, rc, outDoubles, sel, count, [] (double a, double b) {return a * b;}); break;
+			case MyDB_OpCode :: DivInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outInts, sel, count, [] (int64_t a, int64_t b) {return b == 0 ? 0 : a / b;}); break;
+			case MyDB_OpCode :: DivDouble:
+				binaryKernel <double> (l, lc, r, rc, outDoubles, sel, count, [] (double a, double b) {return a / b;}); break;
+
+			case MyDB_OpCode :: GtInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outBools, sel, count, [] (int64_t a, int64_t b) {return (char) (a > b);}); break;
+			case MyDB_OpCode :: GtDouble:
+				binaryKernel <double> (l, lc, r, rc, outBools, sel, count, [] (double a, double b) {return (char) (a > b);}); break;
+			case MyDB_OpCode :: LtInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outBools, sel, count, [] (int64_t a, int64_t b) {return (char) (a < b);}); break;
+			case MyDB_OpCode :: LtDouble:
+				binaryKernel <double> (l, lc, r, rc, outBools, sel, count, [] (double a, double b) {return (char) (a < b);}); break;
+			case MyDB_OpCode :: EqInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outBools, sel, count, [] (int64_t a, int64_t b) {return (char) (a == b);}); break;
+			case MyDB_OpCode :: EqDouble:
+				binaryKernel <double> (l, lc, r, rc, outBools, sel, count, [] (double a, double b) {return (char) (a == b);}); break;
+			case MyDB_OpCode :: NeqInt:
+				binaryKernel <int64_t> (l, lc, r, rc, outBools, sel, count, [] (int64_t a, int64_t b) {return (char) (a != b);}); break;
+			case MyDB_OpCode :: NeqDouble:
+				binaryKernel <double> (l, lc, r, rc, outBools, sel, count, [] (double a, double b) {return (char) (a != b);}); break;
+			case MyDB_OpCode :: EqBool:
+				binaryKernel <char> (l, lc, r, rc, outBools, sel, count, [] (char a, char b) {return (char) (a == b);}); break;
+			case MyDB_OpCode :: NeqBool:
+				binaryKernel <char> (l, lc, r, rc, outBools, sel, count, [] (char a, char b) {return (char) (a != b);}); break;
+
+			case MyDB_OpCode :: GtString:
+				binaryKernel <MyDB_Value> (l, lc, r, rc, outBools, sel, count,
+					[] (const MyDB_Value &a, const MyDB_Value &b) {return (char) (a.compareString (b) > 0);}); break;
+			case MyDB_OpCode :: LtString:
+				binaryKernel <MyDB_Value> (l, lc, r, rc, outBools, sel, count,
+					[] (const MyDB_Value &a, const MyDB_Value &b) {return (char) (a.compareString (b) < 0);}); break;
+			case MyDB_OpCode :: EqString:
+				binaryKernel <MyDB_Value> (l, lc, r, rc, outBools, sel, count,
+					[] (const MyDB_Value &a, const MyDB_Value &b) {return (char) a.equalsString (b);}); break;
+			case MyDB_OpCode :: NeqString:
+				binaryKernel <MyDB_Value> (l, lc, r, rc, outBools, sel, count,
+					[] (const MyDB_Value &a, const MyDB_Value &b) {return (char) !a.equalsString (b);}); break;
+
+			// these build new strings, so they go a row at a time
+			case MyDB_OpCode :: ToString:
+			case MyDB_OpCode :: Concat:
+				for (size_t k = 0; k < count; k++) {
+					size_t i = (sel == nullptr) ? k : sel[k];
+					string &temp = dest.stringBytes[i];
+					temp.clear ();
+					valueAt (lhs, i).appendTo (temp);
+					if (instr.op == MyDB_OpCode :: Concat)
+						valueAt (rhs, i).appendTo (temp);
+					dest.strings[i] = MyDB_Value :: makeString (temp.data (), temp.size ());
+				}
+				break;
+
+			case MyDB_OpCode :: Move:
+				switch (dest.type) {
+					case MyDB_ValueType :: IntVal:
+						binaryKernel <int64_t> (l, lc, l, lc, outInts, sel, count, [] (int64_t a, int64_t) {return a;}); break;
+					case MyDB_ValueType :: DoubleVal:
+						binaryKernel <double> (l, lc, l, lc, outDoubles, sel, count, [] (double a, double) {return a;}); break;
+					case MyDB_ValueType :: BoolVal:
+						binaryKernel <char> (l, lc, l, lc, outBools, sel, count, [] (char a, char) {return a;}); break;
+					default:
+						binaryKernel <MyDB_Value> (l, lc, l, lc, dest.strings.data (), sel, count,
+							[] (const MyDB_Value &a, const MyDB_Value &) {return a;});
+				}
+				break;
+
+			// the rows where the left-hand side of an && is false (or where the left-hand side
+			// of an || is true) are done; we keep going over the rest of them
+			case MyDB_OpCode :: JumpIfFalse:
+			case MyDB_OpCode :: JumpIfTrue: {
+				char jumpOn = (instr.op == MyDB_OpCode :: JumpIfTrue);
+				const char *cond = (const char *) l;
+				uint32_t *next = selections[depth].data ();
+				size_t numLeft = 0;
+				for (size_t k = 0; k < count; k++) {
+					size_t i = (sel == nullptr) ? k : sel[k];
+					char val = cond[lc ? 0 : i];
+
+					// the rows that keep going will have this overwritten when the right side is done
+					outBools[i] = jumpOn;
+					next[numLeft] = (uint32_t) i;
+					numLeft += (val != jumpOn);
+				}
+				jumps[depth].target = instr.rhs;
+				jumps[depth].sel = sel;
+				jumps[depth].count = count;
+				depth++;
+				sel = next;
+				count = numLeft;
+				break;
+			}
+		}
+	}
+}
+
+void MyDB_BatchComputation :: filter (MyDB_RecordBatch &overMe, vector <uint32_t> &selection) {
+
+	if (!getType ()->isBool ()) {
+		cout << "Can only filter with a boolean computation.\n";
+		exit (1);
+	}
+
+	run (overMe);
+	MyDB_BatchReg &res = regs[code->result];
+	size_t n = overMe.size ();
+	selection.resize (n);
+
+	// the answer is the same for every row
+	if (res.isConstant) {
+		if (!code->regs[code->result].boolVal)
+			n = 0;
+		for (size_t i = 0; i < n; i++)
+			selection[i] = (uint32_t) i;
+		selection.resize (n);
+		return;
+	}
+
+	// write every row number, but only move forward past the ones that are selected
+	const char *vals = (const char *) res.data;
+	size_t numSelected = 0;
+	for (size_t i = 0; i < n; i++) {
+		selection[numSelected] = (uint32_t) i;
+		numSelected += (vals[i] != 0);
+	}
+	selection.resize (numSelected);
+}
+
+MyDB_Value MyDB_BatchComputation :: valueAt (MyDB_BatchReg &fromMe, size_t whichRow) {
+	if (fromMe.isConstant)
+		whichRow = 0;
+	switch (fromMe.type) {
+		case MyDB_ValueType :: IntVal: return MyDB_Value :: makeInt (((const int64_t *) fromMe.data)[whichRow]);
+		case MyDB_ValueType :: DoubleVal: return MyDB_Value :: makeDouble (((const double *) fromMe.data)[whichRow]);
+		case MyDB_ValueType :: BoolVal: return MyDB_Value :: makeBool (((const char *) fromMe.data)[whichRow] != 0);
+		default: return ((const MyDB_Value *) fromMe.data)[whichRow];
+	}
+}
+
+MyDB_Value MyDB_BatchComputation :: getResult (size_t whichRow) {
+	return valueAt (regs[code->result], whichRow);
+}
+
+MyDB_AttTypePtr MyDB_BatchComputation :: getType () {
+	return code->resultType;
+}
+
+#endif
@@ -0,0 +1,279 @@
+
+#ifndef BATCH_PREDICATE_C
+#define BATCH_PREDICATE_C
+
+#include "MyDB_BatchPredicate.h"
+#include <algorithm>
+#include <iostream>
+#include <math.h>
+
+using namespace std;
+
+// removes the spaces from both ends
+static string trim (string fromMe) {
+	size_t start = fromMe.find_first_not_of (" \t\n");
+	if (start == string :: npos)
+		return "";
+	size_t end = fromMe.find_last_not_of (" \t\n");
+	return fromMe.substr (start, end - start + 1);
+}
+
+// finds the arguments of the operation that starts at the beginning of the string: that is, the
+// comma-separated list inside of the first set of parens.  Anything inside of square brackets
+// (such as a string literal) is skipped over.  Returns false if there is anything after the parens
+static bool getArgs (string fromMe, vector <string> &args) {
+
+	size_t pos = fromMe.find ('(');
+	if (pos == string :: npos)
+		return false;
+
+	int depth = 0;
+	size_t argStart = pos + 1;
+	for (pos++; pos < fromMe.size (); pos++) {
+		char c = fromMe[pos];
+		if (c == '[') {
+			pos = fromMe.find (']', pos);
+			if (pos == string :: npos)
+				return false;
+		} else if (c == '(') {
+			depth++;
+		} else if (c == ')' && depth > 0) {
+			depth--;
+		} else if ((c == ',' && depth == 0) || c == ')') {
+			args.push_back (trim (fromMe.substr (argStart, pos - argStart)));
+			argStart = pos + 1;
+			if (c == ')')
+				return trim (fromMe.substr (pos + 1)) == "";
+		}
+	}
+	return false;
+}
+
+MyDB_BatchPredicate :: MyDB_BatchPredicate (MyDB_SchemaPtr forMe, vector <string> clausesIn) {
+
+	mySchema = forMe;
+	for (string &clause : clausesIn)
+		clauses.push_back (compile (clause));
+	findBetweens ();
+
+	// run the cheap clauses first, since if nothing is left after them, we are done
+	stable_partition (clauses.begin (), clauses.end (), [&] (MyDB_PredicateNode &checkMe) {
+		return usesKernels (checkMe);
+	});
+}
+
+MyDB_BatchPredicate :: MyDB_PredicateNode MyDB_BatchPredicate :: compile (string clause) {
+
+	MyDB_PredicateNode returnVal;
+	clause = trim (clause);
+	vector <string> args;
+
+	// and, or
+	if ((clause.compare (0, 2, "&&") == 0 || clause.compare (0, 2, "||") == 0) && getArgs (clause, args) && args.size () == 2) {
+		returnVal.kind = (clause[0] == '&') ? MyDB_PredicateNode :: And : MyDB_PredicateNode :: Or;
+		returnVal.children.push_back (compile (args[0]));
+		returnVal.children.push_back (compile (args[1]));
+		return returnVal;
+	}
+
+	// comparisons
+	string op = "";
+	if (clause.compare (0, 2, "==") == 0 || clause.compare (0, 2, "!=") == 0)
+		op = clause.substr (0, 2);
+	else if (clause[0] == '>' || clause[0] == '<')
+		op = clause.substr (0, 1);
+
+	if (op != "" && getArgs (clause, args) && args.size () == 2 && compileCompare (op, args[0], args[1], returnVal))
+		return returnVal;
+
+	// not
+	if (op == "" && clause[0] == '!' && getArgs (clause, args) && args.size () == 1) {
+		returnVal.kind = MyDB_PredicateNode :: Not;
+		returnVal.children.push_back (compile (args[0]));
+		return returnVal;
+	}
+
+	// if we got here, we cannot use a kernel
+	returnVal.kind = MyDB_PredicateNode :: Computation;
+	returnVal.computation = make_shared <MyDB_BatchComputation> (mySchema, clause);
+	if (!returnVal.computation->getType ()->isBool ()) {
+		cout << "The clause " << clause << " is not a boolean.\n";
+		exit (1);
+	}
+	return returnVal;
+}
+
+bool MyDB_BatchPredicate :: compileCompare (string op, string lhs, string rhs, MyDB_PredicateNode &intoMe) {
+
+	// get the attribute on the left
+	bool flip = false;
+	if (lhs[0] != '[') {
+		swap (lhs, rhs);
+		flip = true;
+	}
+	if (lhs[0] != '[' || lhs[lhs.size () - 1] != ']')
+		return false;
+	auto whichAtt = mySchema->getAttByName (lhs.substr (1, lhs.size () - 2));
+	if (whichAtt.first < 0)
+		return false;
+
+	// and the literal on the right
+	bool isInt = rhs.compare (0, 4, "int[") == 0;
+	bool isDouble = rhs.compare (0, 7, "double[") == 0;
+	if ((!isInt && !isDouble) || rhs[rhs.size () - 1] != ']')
+		return false;
+	string lit = rhs.substr (rhs.find ('[') + 1);
+
+	// comparing an int attribute to a double promotes the attribute, so leave that to the computation
+	MyDB_ValueType type = whichAtt.second->createAtt ()->getValueType ();
+	if (type == MyDB_ValueType :: IntVal && isInt) {
+		intoMe.isDouble = false;
+		intoMe.intVal = intoMe.intHigh = stoi (lit);
+	} else if (type == MyDB_ValueType :: DoubleVal) {
+		intoMe.isDouble = true;
+		intoMe.doubleVal = intoMe.doubleHigh = isInt ? stoi (lit) : stod (lit);
+	} else {
+		return false;
+	}
+
+	if (op == "==")
+		intoMe.op = MyDB_CompareOp :: Equal;
+	else if (op == "!=")
+		intoMe.op = MyDB_CompareOp :: NotEqual;
+	else if ((op == ">") != flip)
+		intoMe.op = MyDB_CompareOp :: GreaterThan;
+	else
+		intoMe.op = MyDB_CompareOp :: LessThan;
+
+	intoMe.kind = MyDB_PredicateNode :: Compare;
+	intoMe.whichAtt = whichAtt.first;
+	return true;
+}
+
+void MyDB_BatchPredicate :: findBetweens () {
+
+	for (size_t i = 0; i < clauses.size (); i++) {
+		MyDB_PredicateNode &low = clauses[i];
+		if (low.kind != MyDB_PredicateNode :: Compare || low.op != MyDB_CompareOp :: GreaterThan)
+			continue;
+
+		// look for an upper bound on the same attribute
+		for (size_t j = 0; j < clauses.size (); j++) {
+			MyDB_PredicateNode &high = clauses[j];
+			if (high.kind != MyDB_PredicateNode :: Compare || high.op != MyDB_CompareOp :: LessThan ||
+				high.whichAtt != low.whichAtt || high.isDouble != low.isDouble)
+				continue;
+
+			// the kernel's BETWEEN is inclusive, so move the bounds in by one
+			if (low.isDouble) {
+				if (!isfinite (low.doubleVal) || !isfinite (high.doubleVal))
+					continue;
+				low.doubleHigh = nextafter (high.doubleVal, -INFINITY);
+				low.doubleVal = nextafter (low.doubleVal, INFINITY);
+			} else {
+				low.intHigh = high.intVal - 1;
+				low.intVal = low.intVal + 1;
+			}
+			low.op = MyDB_CompareOp :: Between;
+			clauses.erase (clauses.begin () + j);
+			if (j < i)
+				i--;
+			break;
+		}
+	}
+}
+
+bool MyDB_BatchPredicate :: usesKernels (MyDB_PredicateNode &checkMe) {
+	if (checkMe.kind == MyDB_PredicateNode :: Computation)
+		return false;
+	for (auto &child : checkMe.children) {
+		if (!usesKernels (child))
+			return false;
+	}
+	return true;
+}
+
+void MyDB_BatchPredicate :: run (MyDB_PredicateNode &runMe, MyDB_RecordBatch &overMe, uint64_t *out, size_t depth) {
+
+	size_t n = overMe.size ();
+	switch (runMe.kind) {
+
+		case MyDB_PredicateNode :: Compare:
+			if (!overMe.isProjected (runMe.whichAtt)) {
+				cout << "The predicate uses an attribute that is not in the batch's projection.\n";
+				exit (1);
+			}
+			if (runMe.isDouble)
+				MyDB_PredicateKernels :: compare (overMe.getDoubles (runMe.whichAtt), n, runMe.op,
+					runMe.doubleVal, runMe.doubleHigh, out);
+			else
+				MyDB_PredicateKernels :: compare (overMe.getInts (runMe.whichAtt), n, runMe.op,
+					runMe.intVal, runMe.intHigh, out);
+			return;
+
+		case MyDB_PredicateNode :: And:
+		case MyDB_PredicateNode :: Or: {
+			if (scratch.size () <= depth)
+				scratch.resize (depth + 1);
+			scratch[depth].resize (MyDB_PredicateKernels :: numWords (n));
+			run (runMe.children[0], overMe, out, depth + 1);
+			run (runMe.children[1], overMe, scratch[depth].data (), depth + 1);
+			if (runMe.kind == MyDB_PredicateNode :: And)
+				MyDB_PredicateKernels :: andBits (out, scratch[depth].data (), n);
+			else
+				MyDB_PredicateKernels :: orBits (out, scratch[depth].data (), n);
+			return;
+		}
+
+		case MyDB_PredicateNode :: Not:
+			run (runMe.children[0], overMe, out, depth + 1);
+			MyDB_PredicateKernels :: notBits (out, n);
+			return;
+
+		default:
+			runMe.computation->filter (overMe, scratchSelection);
+			MyDB_PredicateKernels :: fromSelection (scratchSelection.data (), scratchSelection.size (), n, out);
+	}
+}
+
+void MyDB_BatchPredicate :: evaluate (MyDB_RecordBatch &overMe, vector <uint64_t> &bits) {
+
+	size_t n = overMe.size ();
+	bits.resize (MyDB_PredicateKernels :: numWords (n));
+	if (clauses.empty ()) {
+		MyDB_PredicateKernels :: setBits (bits.data (), n, true);
+		return;
+	}
+
+	// the first level of scratch space is for the clauses after the first one
+	if (scratch.empty ())
+		scratch.resize (1);
+	scratch[0].resize (bits.size ());
+
+	run (clauses[0], overMe, bits.data (), 1);
+	for (size_t i = 1; i < clauses.size (); i++) {
+		if (MyDB_PredicateKernels :: noneSet (bits.data (), n))
+			return;
+		run (clauses[i], overMe, scratch[0].data (), 1);
+		MyDB_PredicateKernels :: andBits (bits.data (), scratch[0].data (), n);
+	}
+}
+
+void MyDB_BatchPredicate :: filter (MyDB_RecordBatch &overMe, vector <uint32_t> &selection) {
+	evaluate (overMe, filterBits);
+	selection.resize (overMe.size ());
+	selection.resize (MyDB_PredicateKernels :: toSelection (filterBits.data (), overMe.size (), selection.data ()));
+}
+
+size_t MyDB_BatchPredicate :: getNumClauses () {
+	return clauses.size ();
+}
+
+size_t MyDB_BatchPredicate :: getNumKernelClauses () {
+	size_t count = 0;
+	for (auto &clause : clauses)
+		count += usesKernels (clause);
+	return count;
+}
+
+#endif
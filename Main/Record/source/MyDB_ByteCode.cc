@@ -0,0 +1,425 @@
+
+#ifndef BYTE_CODE_C
+#define BYTE_CODE_C
+
+#include "MyDB_ByteCode.h"
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+MyDB_ByteCode :: MyDB_ByteCode (MyDB_RecordPtr overMe, string computation) {
+	myRec = overMe;
+	char *str = (char *) computation.c_str ();
+	auto res = compile (str);
+	result = res.first;
+	resultType = res.second;
+}
+
+const MyDB_Value &MyDB_ByteCode :: run () {
+
+	MyDB_Value *r = regs.data ();
+	for (auto &load : loads) {
+		r[load.second] = myRec->getValue (load.first);
+	}
+	execute (program.data (), program.size (), r, regStrings);
+	return regs[result];
+}
+
+MyDB_AttTypePtr MyDB_ByteCode :: getType () {
+	return resultType;
+}
+
+func MyDB_ByteCode :: getFunc () {
+	MyDB_AttValPtr res = resultType->createAtt ();
+	return [this, res] {res->fromValue (run ()); return res;};
+}
+
+void MyDB_ByteCode :: execute (const MyDB_Instruction *code, size_t len, MyDB_Value *r, deque <string> &regStrings) {
+
+	for (size_t pc = 0; pc < len; pc++) {
+
+		const MyDB_Instruction &runMe = code[pc];
+		MyDB_Value &dest = r[runMe.dest];
+		const MyDB_Value &lhs = r[runMe.lhs];
+		const MyDB_Value &rhs = r[runMe.rhs];
+
+		switch (runMe.op) {
+
+			case MyDB_OpCode :: IntToDouble: dest.doubleVal = (double) lhs.intVal; break;
+			case MyDB_OpCode :: ToString: {
+				string &temp = regStrings[runMe.dest];
+				temp.clear ();
+				lhs.appendTo (temp);
+				dest.strVal = temp.data ();
+				dest.strLen = temp.size ();
+				break;
+			}
+
+			case MyDB_OpCode :: AddInt: dest.intVal = lhs.intVal + rhs.intVal; break;
+			case MyDB_OpCode :: AddDouble: dest.doubleVal = lhs.doubleVal + rhs.doubleVal; break;
+			case MyDB_OpCode :: Concat: {
+				string &temp = regStrings[runMe.dest];
+				temp.clear ();
+				lhs.appendTo (temp);
+				rhs.appendTo (temp);
+				dest.strVal = temp.data ();
+				dest.strLen = temp.size ();
+				break;
+			}
+			case MyDB_OpCode :: SubInt: dest.intVal = lhs.intVal - rhs.intVal; break;
+			case MyDB_OpCode :: SubDouble: dest.doubleVal = lhs.doubleVal - rhs.doubleVal; break;
+			case MyDB_OpCode :: MulInt: dest.intVal = lhs.intVal * rhs.intVal; break;
+			case MyDB_OpCode :: MulDouble: dest.doubleVal = lhs.doubleVal * rhs.doubleVal; break;
+			case MyDB_OpCode :: DivInt: dest.intVal = lhs.intVal / rhs.intVal; break;
+			case MyDB_OpCode :: DivDouble: dest.doubleVal = lhs.doubleVal / rhs.doubleVal; break;
+			case MyDB_OpCode :: NegInt: dest.intVal = -lhs.intVal; break;
+			case MyDB_OpCode :: NegDouble: dest.doubleVal = -lhs.doubleVal; break;
+
+			case MyDB_OpCode :: GtInt: dest.boolVal = lhs.intVal > rhs.intVal; break;
+			case MyDB_OpCode :: GtDouble: dest.boolVal = lhs.doubleVal > rhs.doubleVal; break;
+			case MyDB_OpCode :: GtString: dest.boolVal = lhs.compareString (rhs) > 0; break;
+			case MyDB_OpCode :: LtInt: dest.boolVal = lhs.intVal < rhs.intVal; break;
+			case MyDB_OpCode :: LtDouble: dest.boolVal = lhs.doubleVal < rhs.doubleVal; break;
+			case MyDB_OpCode :: LtString: dest.boolVal = lhs.compareString (rhs) < 0; break;
+			case MyDB_OpCode :: EqInt: dest.boolVal = lhs.intVal == rhs.intVal; break;
+			case MyDB_OpCode :: EqDouble: dest.boolVal = lhs.doubleVal == rhs.doubleVal; break;
+			case MyDB_OpCode :: EqBool: dest.boolVal = lhs.boolVal == rhs.boolVal; break;
+			case MyDB_OpCode :: EqString: dest.boolVal = lhs.equalsString (rhs); break;
+			case MyDB_OpCode :: NeqInt: dest.boolVal = lhs.intVal != rhs.intVal; break;
+			case MyDB_OpCode :: NeqDouble: dest.boolVal = lhs.doubleVal != rhs.doubleVal; break;
+			case MyDB_OpCode :: NeqBool: dest.boolVal = lhs.boolVal != rhs.boolVal; break;
+			case MyDB_OpCode :: NeqString: dest.boolVal = !lhs.equalsString (rhs); break;
+
+			case MyDB_OpCode :: Not: dest.boolVal = !lhs.boolVal; break;
+			case MyDB_OpCode :: Move: dest = lhs; break;
+
+			case MyDB_OpCode :: JumpIfFalse:
+				if (!lhs.boolVal) {
+					dest.boolVal = false;
+					pc = runMe.rhs - 1;
+				}
+				break;
+			case MyDB_OpCode :: JumpIfTrue:
+				if (lhs.boolVal) {
+					dest.boolVal = true;
+					pc = runMe.rhs - 1;
+				}
+				break;
+		}
+	}
+}
+
+unsigned short MyDB_ByteCode :: newReg (MyDB_ValueType ofType) {
+	if (regs.size () == 65535) {
+		cout << "Computation is too big to compile.\n";
+		exit (1);
+	}
+	MyDB_Value temp;
+	temp.type = ofType;
+	temp.intVal = 0;
+	temp.strLen = 0;
+	regs.push_back (temp);
+	regStrings.emplace_back ();
+	isConstant.push_back (false);
+	return (unsigned short) (regs.size () - 1);
+}
+
+unsigned short MyDB_ByteCode :: emit (MyDB_OpCode op, MyDB_ValueType resType, unsigned short lhs, unsigned short rhs) {
+	unsigned short dest = newReg (resType);
+	MyDB_Instruction temp {op, dest, lhs, rhs};
+
+	// if we know the inputs, just compute the output now
+	if (isConstant[lhs] && isConstant[rhs]) {
+		execute (&temp, 1, regs.data (), regStrings);
+		isConstant[dest] = true;
+	} else {
+		program.push_back (temp);
+	}
+	return dest;
+}
+
+unsigned short MyDB_ByteCode :: toDouble (pair <unsigned short, MyDB_AttTypePtr> fromMe) {
+	if (regs[fromMe.first].type == MyDB_ValueType :: DoubleVal)
+		return fromMe.first;
+	return emit (MyDB_OpCode :: IntToDouble, MyDB_ValueType :: DoubleVal, fromMe.first, fromMe.first);
+}
+
+unsigned short MyDB_ByteCode :: toStr (pair <unsigned short, MyDB_AttTypePtr> fromMe) {
+	if (regs[fromMe.first].type == MyDB_ValueType :: StringVal)
+		return fromMe.first;
+	return emit (MyDB_OpCode :: ToString, MyDB_ValueType :: StringVal, fromMe.first, fromMe.first);
+}
+
+pair <unsigned short, MyDB_AttTypePtr> MyDB_ByteCode :: compileBinary (string op,
+	pair <unsigned short, MyDB_AttTypePtr> lhs, pair <unsigned short, MyDB_AttTypePtr> rhs) {
+
+	// figure out the typed versions of the operation; the promotion rules (and the order that
+	// they are tried in) are the same as the ones used by MyDB_Record :: compileComputation ()
+	MyDB_OpCode intOp, doubleOp, boolOp = MyDB_OpCode :: Move, stringOp = MyDB_OpCode :: Move;
+	bool isCompare = true;
+	if (op == "+") {
+		intOp = MyDB_OpCode :: AddInt; doubleOp = MyDB_OpCode :: AddDouble; stringOp = MyDB_OpCode :: Concat;
+		isCompare = false;
+	} else if (op == "-") {
+		intOp = MyDB_OpCode :: SubInt; doubleOp = MyDB_OpCode :: SubDouble;
+		isCompare = false;
+	} else if (op == "*") {
+		intOp = MyDB_OpCode :: MulInt; doubleOp = MyDB_OpCode :: MulDouble;
+		isCompare = false;
+	} else if (op == "/") {
+		intOp = MyDB_OpCode :: DivInt; doubleOp = MyDB_OpCode :: DivDouble;
+		isCompare = false;
+	} else if (op == ">") {
+		intOp = MyDB_OpCode :: GtInt; doubleOp = MyDB_OpCode :: GtDouble; stringOp = MyDB_OpCode :: GtString;
+	} else if (op == "<") {
+		intOp = MyDB_OpCode :: LtInt; doubleOp = MyDB_OpCode :: LtDouble; stringOp = MyDB_OpCode :: LtString;
+	} else if (op == "==") {
+		intOp = MyDB_OpCode :: EqInt; doubleOp = MyDB_OpCode :: EqDouble; boolOp = MyDB_OpCode :: EqBool;
+		stringOp = MyDB_OpCode :: EqString;
+	} else {
+		intOp = MyDB_OpCode :: NeqInt; doubleOp = MyDB_OpCode :: NeqDouble; boolOp = MyDB_OpCode :: NeqBool;
+		stringOp = MyDB_OpCode :: NeqString;
+	}
+
+	MyDB_AttTypePtr boolType = make_shared <MyDB_BoolAttType> ();
+
+	// if both sides can be cast upwards to be ints, then do so
+	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
+		if (isCompare)
+			return make_pair (emit (intOp, MyDB_ValueType :: BoolVal, lhs.first, rhs.first), boolType);
+		return make_pair (emit (intOp, MyDB_ValueType :: IntVal, lhs.first, rhs.first), make_shared <MyDB_IntAttType> ());
+
+	// otherwise, if both sides can be cast upwards to be doubles, then do so
+	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
+		unsigned short l = toDouble (lhs), r = toDouble (rhs);
+		if (isCompare)
+			return make_pair (emit (doubleOp, MyDB_ValueType :: BoolVal, l, r), boolType);
+		return make_pair (emit (doubleOp, MyDB_ValueType :: DoubleVal, l, r), make_shared <MyDB_DoubleAttType> ());
+
+	} else if (boolOp != MyDB_OpCode :: Move && lhs.second->isBool () && rhs.second->isBool ()) {
+		return make_pair (emit (boolOp, MyDB_ValueType :: BoolVal, lhs.first, rhs.first), boolType);
+
+	// otherwise, if both sides can be cast upwards to be strings, then do so
+	} else if (stringOp != MyDB_OpCode :: Move && lhs.second->promotableToString () && rhs.second->promotableToString ()) {
+
+		// concatenation can append anything, so no conversion is needed
+		if (stringOp == MyDB_OpCode :: Concat)
+			return make_pair (emit (stringOp, MyDB_ValueType :: StringVal, lhs.first, rhs.first),
+				make_shared <MyDB_StringAttType> ());
+		return make_pair (emit (stringOp, MyDB_ValueType :: BoolVal, toStr (lhs), toStr (rhs)), boolType);
+
+	} else {
+		cout << "This is bad... cannot do anything with the " << op << ".\n";
+		exit (1);
+	}
+}
+
+pair <unsigned short, MyDB_AttTypePtr> MyDB_ByteCode :: compileUnary (string op, pair <unsigned short, MyDB_AttTypePtr> lhs) {
+
+	if (op == "!") {
+		if (!lhs.second->isBool ()) {
+			cout << "This is bad... cannot do not on non boolean.\n";
+			exit (1);
+		}
+		return make_pair (emit (MyDB_OpCode :: Not, MyDB_ValueType :: BoolVal, lhs.first, lhs.first), lhs.second);
+	}
+
+	// this is a unary minus
+	if (lhs.second->promotableToInt ()) {
+		return make_pair (emit (MyDB_OpCode :: NegInt, MyDB_ValueType :: IntVal, lhs.first, lhs.first), lhs.second);
+	} else if (lhs.second->promotableToDouble ()) {
+		unsigned short l = toDouble (lhs);
+		return make_pair (emit (MyDB_OpCode :: NegDouble, MyDB_ValueType :: DoubleVal, l, l),
+			make_shared <MyDB_DoubleAttType> ());
+	} else {
+		cout << "This is bad... cannot do anything with the unary minus.\n";
+		exit (1);
+	}
+}
+
+pair <unsigned short, MyDB_AttTypePtr> MyDB_ByteCode :: compileShortCircuit (bool isAnd, char * &vals) {
+
+	// find the l-paren
+	vals = findsymbol ('(', vals);
+
+	// find the left result
+	auto lres = compile (vals);
+
+	// and the comma
+	vals = findsymbol (',', vals);
+
+	// remember where we are, and put in the jump over the right-hand side
+	unsigned short dest = newReg (MyDB_ValueType :: BoolVal);
+	size_t jumpAt = program.size ();
+	program.push_back (MyDB_Instruction {isAnd ? MyDB_OpCode :: JumpIfFalse : MyDB_OpCode :: JumpIfTrue, dest, lres.first, 0});
+
+	// find the right result
+	auto rres = compile (vals);
+
+	// find the r-paren
+	vals = findsymbol (')', vals);
+
+	if (!lres.second->isBool () || !rres.second->isBool ()) {
+		cout << "This is bad... cannot do " << (isAnd ? "and" : "or") << " on non booleans.\n";
+		exit (1);
+	}
+
+	// if the left side is a constant, then either we never need the right side, or we always do
+	if (isConstant[lres.first]) {
+		if (regs[lres.first].boolVal != isAnd) {
+			program.resize (jumpAt);
+			return lres;
+		}
+		program.erase (program.begin () + jumpAt);
+		for (size_t i = jumpAt; i < program.size (); i++) {
+			if (program[i].op == MyDB_OpCode :: JumpIfFalse || program[i].op == MyDB_OpCode :: JumpIfTrue)
+				program[i].rhs--;
+		}
+		return rres;
+	}
+
+	// the right side is the answer if we did not jump over it
+	program.push_back (MyDB_Instruction {MyDB_OpCode :: Move, dest, rres.first, rres.first});
+	program[jumpAt].rhs = (unsigned short) program.size ();
+	return make_pair (dest, lres.second);
+}
+
+char *MyDB_ByteCode :: findsymbol (char val, char *input) {
+	while (*input != val) {
+		input++;
+	}
+	return input + 1;
+}
+
+pair <unsigned short, MyDB_AttTypePtr> MyDB_ByteCode :: compile (char * &vals) {
+
+	// search for one of the infix symbols
+	while (true) {
+
+		if (vals[0] == 0) {
+			cout << "Reached end of string while parsing.\n";
+			exit (1);
+		}
+
+		// all of the binary operations look the same
+		string op = "";
+		if ((vals[0] == '!' || vals[0] == '=') && vals[1] == '=') {
+			op = string (vals, 2);
+		} else if (vals[0] == '+' || vals[0] == '-' || vals[0] == '*' || vals[0] == '/' || vals[0] == '>' || vals[0] == '<') {
+			op = string (vals, 1);
+		}
+
+		if (op != "") {
+
+			// find the l-paren
+			vals = findsymbol ('(', vals);
+
+			// find the left result
+			auto lres = compile (vals);
+
+			// and the comma
+			vals = findsymbol (',', vals);
+
+			// find the right result
+			auto rres = compile (vals);
+
+			// find the r-paren
+			vals = findsymbol (')', vals);
+
+			// outta here!
+			return compileBinary (op, lres, rres);
+
+		// and, or
+		} else if ((vals[0] == '&' && vals[1] == '&') || (vals[0] == '|' && vals[1] == '|')) {
+
+			return compileShortCircuit (vals[0] == '&', vals);
+
+		// not, unary minus
+		} else if (vals[0] == '!' || (vals[0] == 'u' && vals[1] == 'm')) {
+
+			op = (vals[0] == '!') ? "!" : "um";
+
+			// find the l-paren
+			vals = findsymbol ('(', vals);
+
+			// find the result
+			auto res = compile (vals);
+
+			// find the r-paren
+			vals = findsymbol (')', vals);
+
+			// outta here!
+			return compileUnary (op, res);
+
+		} else if (vals[0] == '[') {
+
+			// find the right bracket
+			vals++;
+			int cnt = 0;
+			for (; vals[cnt] != ']'; cnt++);
+			string name (vals, cnt);
+			vals = findsymbol (']', vals);
+
+			// and get that attribute
+			auto whichAtt = myRec->getSchema ()->getAttByName (name);
+			if (whichAtt.first < 0) {
+				cout << "Could not find attribute " << name << " while compiling.\n";
+				exit (1);
+			}
+
+			for (auto &load : loads) {
+				if (load.first == whichAtt.first)
+					return make_pair (load.second, whichAtt.second);
+			}
+			unsigned short dest = newReg (whichAtt.second->createAtt ()->getValueType ());
+			loads.push_back (make_pair (whichAtt.first, dest));
+			return make_pair (dest, whichAtt.second);
+
+		} else if (strncmp (vals, "int", 3) == 0) {
+
+			vals = findsymbol ('[', vals);
+			unsigned short dest = newReg (MyDB_ValueType :: IntVal);
+			regs[dest].intVal = stoi (vals);
+			isConstant[dest] = true;
+			vals = findsymbol (']', vals);
+			return make_pair (dest, make_shared <MyDB_IntAttType> ());
+
+		} else if (strncmp (vals, "double", 6) == 0) {
+
+			vals = findsymbol ('[', vals);
+			unsigned short dest = newReg (MyDB_ValueType :: DoubleVal);
+			regs[dest].doubleVal = stod (vals);
+			isConstant[dest] = true;
+			vals = findsymbol (']', vals);
+			return make_pair (dest, make_shared <MyDB_DoubleAttType> ());
+
+		} else if (strncmp (vals, "bool", 4) == 0) {
+
+			vals = findsymbol ('[', vals);
+			unsigned short dest = newReg (MyDB_ValueType :: BoolVal);
+			regs[dest].boolVal = (strncmp (vals, "true", 4) == 0);
+			isConstant[dest] = true;
+			vals = findsymbol (']', vals);
+			return make_pair (dest, make_shared <MyDB_BoolAttType> ());
+
+		} else if (strncmp (vals, "string", 6) == 0) {
+
+			vals = findsymbol ('[', vals);
+			int cnt = 0;
+			for (; vals[cnt] != ']'; cnt++);
+			unsigned short dest = newReg (MyDB_ValueType :: StringVal);
+			regStrings[dest] = string (vals, cnt);
+			regs[dest].strVal = regStrings[dest].data ();
+			regs[dest].strLen = cnt;
+			isConstant[dest] = true;
+			vals = findsymbol (']', vals);
+			return make_pair (dest, make_shared <MyDB_StringAttType> ());
+
+		} else {
+			vals++;
+		}
+	}
+}
+
+#endif
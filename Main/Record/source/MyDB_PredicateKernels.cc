@@ -0,0 +1,306 @@
+
+#ifndef PREDICATE_KERNELS_C
+#define PREDICATE_KERNELS_C
+
+#include "MyDB_PredicateKernels.h"
+#include <string.h>
+
+// the vectorized kernels are compiled with gcc's target attribute, so that they can be built
+// without -mavx2 (and then are only run if the CPU has the instructions)
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// the plain versions; these are also used for the rows at the end of a column that do not fill
+// up a whole 64-bit word
+template <class T>
+static void compareScalar (const T *col, size_t numRows, MyDB_CompareOp op, T val, T high, uint64_t *out) {
+
+	for (size_t w = 0; w * 64 < numRows; w++) {
+		const T *c = col + w * 64;
+		size_t len = numRows - w * 64 < 64 ? numRows - w * 64 : 64;
+		uint64_t word = 0;
+		switch (op) {
+			case MyDB_CompareOp :: Equal:
+				for (size_t j = 0; j < len; j++) word |= ((uint64_t) (c[j] == val)) << j;
+				break;
+			case MyDB_CompareOp :: NotEqual:
+				for (size_t j = 0; j < len; j++) word |= ((uint64_t) (c[j] != val)) << j;
+				break;
+			case MyDB_CompareOp :: LessThan:
+				for (size_t j = 0; j < len; j++) word |= ((uint64_t) (c[j] < val)) << j;
+				break;
+			case MyDB_CompareOp :: GreaterThan:
+				for (size_t j = 0; j < len; j++) word |= ((uint64_t) (c[j] > val)) << j;
+				break;
+			case MyDB_CompareOp :: Between:
+				for (size_t j = 0; j < len; j++) word |= ((uint64_t) (c[j] >= val && c[j] <= high)) << j;
+				break;
+		}
+		out[w] = word;
+	}
+}
+
+#ifdef X86_KERNELS
+
+// fills in the bitmap for the first full * 64 rows, one word at a time; MASK gives the bits for
+// the LANES rows starting at row i
+#define SIMD_LOOP(LANES, MASK) 						\
+	for (size_t w = 0; w < full; w++) { 				\
+		uint64_t word = 0; 					\
+		for (size_t j = 0; j < 64; j += LANES) { 		\
+			size_t i = w * 64 + j; 				\
+			word |= ((uint64_t) (MASK)) << j; 		\
+		} 							\
+		out[w] = word; 						\
+	} 								\
+	break;
+
+// AVX2: 8 ints, or 4 longs or doubles, at a time
+__attribute__ ((target ("avx2")))
+static void compareAVX2 (const int32_t *col, size_t numRows, MyDB_CompareOp op, int32_t val, int32_t high, uint64_t *out) {
+	size_t full = numRows / 64;
+	__m256i v = _mm256_set1_epi32 (val);
+	__m256i h = _mm256_set1_epi32 (high);
+	#define LOAD(i) _mm256_loadu_si256 ((const __m256i *) (col + (i)))
+	#define MASK(x) _mm256_movemask_ps (_mm256_castsi256_ps (x))
+	switch (op) {
+		case MyDB_CompareOp :: Equal: SIMD_LOOP (8, MASK (_mm256_cmpeq_epi32 (LOAD (i), v)))
+		case MyDB_CompareOp :: NotEqual: SIMD_LOOP (8, MASK (_mm256_cmpeq_epi32 (LOAD (i), v)) ^ 0xFF)
+		case MyDB_CompareOp :: LessThan: SIMD_LOOP (8, MASK (_mm256_cmpgt_epi32 (v, LOAD (i))))
+		case MyDB_CompareOp :: GreaterThan: SIMD_LOOP (8, MASK (_mm256_cmpgt_epi32 (LOAD (i), v)))
+		case MyDB_CompareOp :: Between: SIMD_LOOP (8, MASK (_mm256_or_si256 (_mm256_cmpgt_epi32 (v, LOAD (i)),
+			_mm256_cmpgt_epi32 (LOAD (i), h))) ^ 0xFF)
+	}
+	#undef LOAD
+	#undef MASK
+	compareScalar (col + full * 64, numRows - full * 64, op, val, high, out + full);
+}
+
+__attribute__ ((target ("avx2")))
+static void compareAVX2 (const int64_t *col, size_t numRows, MyDB_CompareOp op, int64_t val, int64_t high, uint64_t *out) {
+	size_t full = numRows / 64;
+	__m256i v = _mm256_set1_epi64x (val);
+	__m256i h = _mm256_set1_epi64x (high);
+	#define LOAD(i) _mm256_loadu_si256 ((const __m256i *) (col + (i)))
+	#define MASK(x) _mm256_movemask_pd (_mm256_castsi256_pd (x))
+	switch (op) {
+		case MyDB_CompareOp :: Equal: SIMD_LOOP (4, MASK (_mm256_cmpeq_epi64 (LOAD (i), v)))
+		case MyDB_CompareOp :: NotEqual: SIMD_LOOP (4, MASK (_mm256_cmpeq_epi64 (LOAD (i), v)) ^ 0xF)
+		case MyDB_CompareOp :: LessThan: SIMD_LOOP (4, MASK (_mm256_cmpgt_epi64 (v, LOAD (i))))
+		case MyDB_CompareOp :: GreaterThan: SIMD_LOOP (4, MASK (_mm256_cmpgt_epi64 (LOAD (i), v)))
+		case MyDB_CompareOp :: Between: SIMD_LOOP (4, MASK (_mm256_or_si256 (_mm256_cmpgt_epi64 (v, LOAD (i)),
+			_mm256_cmpgt_epi64 (LOAD (i), h))) ^ 0xF)
+	}
+	#undef LOAD
+	#undef MASK
+	compareScalar (col + full * 64, numRows - full * 64, op, val, high, out + full);
+}
+
+__attribute__ ((target ("avx2")))
+static void compareAVX2 (const double *col, size_t numRows, MyDB_CompareOp op, double val, double high, uint64_t *out) {
+	size_t full = numRows / 64;
+	__m256d v = _mm256_set1_pd (val);
+	__m256d h = _mm256_set1_pd (high);
+	#define LOAD(i) _mm256_loadu_pd (col + (i))
+	switch (op) {
+		case MyDB_CompareOp :: Equal: SIMD_LOOP (4, _mm256_movemask_pd (_mm256_cmp_pd (LOAD (i), v, _CMP_EQ_OQ)))
+		case MyDB_CompareOp :: NotEqual: SIMD_LOOP (4, _mm256_movemask_pd (_mm256_cmp_pd (LOAD (i), v, _CMP_NEQ_UQ)))
+		case MyDB_CompareOp :: LessThan: SIMD_LOOP (4, _mm256_movemask_pd (_mm256_cmp_pd (LOAD (i), v, _CMP_LT_OQ)))
+		case MyDB_CompareOp :: GreaterThan: SIMD_LOOP (4, _mm256_movemask_pd (_mm256_cmp_pd (LOAD (i), v, _CMP_GT_OQ)))
+		case MyDB_CompareOp :: Between: SIMD_LOOP (4, _mm256_movemask_pd (_mm256_and_pd (_mm256_cmp_pd (LOAD (i), v, _CMP_GE_OQ),
+			_mm256_cmp_pd (LOAD (i), h, _CMP_LE_OQ))))
+	}
+	#undef LOAD
+	compareScalar (col + full * 64, numRows - full * 64, op, val, high, out + full);
+}
+
+// SSE4.2 (which is needed for the 64-bit integer comparison): 4 ints, or 2 longs or doubles, at a time
+__attribute__ ((target ("sse4.2")))
+static void compareSSE (const int32_t *col, size_t numRows, MyDB_CompareOp op, int32_t val, int32_t high, uint64_t *out) {
+	size_t full = numRows / 64;
+	__m128i v = _mm_set1_epi32 (val);
+	__m128i h = _mm_set1_epi32 (high);
+	#define LOAD(i) _mm_loadu_si128 ((const __m128i *) (col + (i)))
+	#define MASK(x) _mm_movemask_ps (_mm_castsi128_ps (x))
+	switch (op) {
+		case MyDB_CompareOp :: Equal: SIMD_LOOP (4, MASK (_mm_cmpeq_epi32 (LOAD (i), v)))
+		case MyDB_CompareOp :: NotEqual: SIMD_LOOP (4, MASK (_mm_cmpeq_epi32 (LOAD (i), v)) ^ 0xF)
+		case MyDB_CompareOp :: LessThan: SIMD_LOOP (4, MASK (_mm_cmpgt_epi32 (v, LOAD (i))))
+		case MyDB_CompareOp :: GreaterThan: SIMD_LOOP (4, MASK (_mm_cmpgt_epi32 (LOAD (i), v)))
+		case MyDB_CompareOp :: Between: SIMD_LOOP (4, MASK (_mm_or_si128 (_mm_cmpgt_epi32 (v, LOAD (i)),
+			_mm_cmpgt_epi32 (LOAD (i), h))) ^ 0xF)
+	}
+	#undef LOAD
+	#undef MASK
+	compareScalar (col + full * 64, numRows - full * 64, op, val, high, out + full);
+}
+
+__attribute__ ((target ("sse4.2")))
+static void compareSSE (const int64_t *col, size_t numRows, MyDB_CompareOp op, int64_t val, int64_t high, uint64_t *out) {
+	size_t full = numRows / 64;
+	__m128i v = _mm_set1_epi64x (val);
+	__m128i h = _mm_set1_epi64x (high);
+	#define LOAD(i) _mm_loadu_si128 ((const __m128i *) (col + (i)))
+	#define MASK(x) _mm_movemask_pd (_mm_castsi128_pd (x))
+	switch (op) {
+		case MyDB_CompareOp :: Equal: SIMD_LOOP (2, MASK (_mm_cmpeq_epi64 (LOAD (i), v)))
+		case MyDB_CompareOp :: NotEqual: SIMD_LOOP (2, MASK (_mm_cmpeq_epi64 (LOAD (i), v)) ^ 0x3)
+		case MyDB_CompareOp :: LessThan: SIMD_LOOP (2, MASK (_mm_cmpgt_epi64 (v, LOAD (i))))
+		case MyDB_CompareOp :: GreaterThan: SIMD_LOOP (2, MASK (_mm_cmpgt_epi64 (LOAD (i), v)))
+		case MyDB_CompareOp :: Between: SIMD_LOOP (2, MASK (_mm_or_si128 (_mm_cmpgt_epi64 (v, LOAD (i)),
+			_mm_cmpgt_epi64 (LOAD (i), h))) ^ 0x3)
+	}
+	#undef LOAD
+	#undef MASK
+	compareScalar (col + full * 64, numRows - full * 64, op, val, high, out + full);
+}
+
+__attribute__ ((target ("sse4.2")))
+static void compareSSE (const double *col, size_t numRows, MyDB_CompareOp op, double val, double high, uint64_t *out) {
+	size_t full = numRows / 64;
+	__m128d v = _mm_set1_pd (val);
+	__m128d h = _mm_set1_pd (high);
+	#define LOAD(i) _mm_loadu_pd (col + (i))
+	switch (op) {
+		case MyDB_CompareOp :: Equal: SIMD_LOOP (2, _mm_movemask_pd (_mm_cmpeq_pd (LOAD (i), v)))
+		case MyDB_CompareOp :: NotEqual: SIMD_LOOP (2, _mm_movemask_pd (_mm_cmpneq_pd (LOAD (i), v)))
+		case MyDB_CompareOp :: LessThan: SIMD_LOOP (2, _mm_movemask_pd (_mm_cmplt_pd (LOAD (i), v)))
+		case MyDB_CompareOp :: GreaterThan: SIMD_LOOP (2, _mm_movemask_pd (_mm_cmpgt_pd (LOAD (i), v)))
+		case MyDB_CompareOp :: Between: SIMD_LOOP (2, _mm_movemask_pd (_mm_and_pd (_mm_cmpge_pd (LOAD (i), v),
+			_mm_cmple_pd (LOAD (i), h))))
+	}
+	#undef LOAD
+	compareScalar (col + full * 64, numRows - full * 64, op, val, high, out + full);
+}
+
+#undef SIMD_LOOP
+
+#endif
+
+// figure out what the CPU can do
+static MyDB_KernelLevel findBestLevel () {
+#ifdef X86_KERNELS
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2"))
+		return MyDB_KernelLevel :: AVX2;
+	if (__builtin_cpu_supports ("sse4.2"))
+		return MyDB_KernelLevel :: SSE;
+#endif
+	return MyDB_KernelLevel :: Scalar;
+}
+
+static MyDB_KernelLevel bestLevel = findBestLevel ();
+static MyDB_KernelLevel curLevel = bestLevel;
+
+// sends the comparison to the right version
+#ifdef X86_KERNELS
+#define DISPATCH 								\
+	switch (curLevel) { 							\
+		case MyDB_KernelLevel :: AVX2: 					\
+			compareAVX2 (col, numRows, op, val, high, out); 	\
+			return; 						\
+		case MyDB_KernelLevel :: SSE: 					\
+			compareSSE (col, numRows, op, val, high, out); 		\
+			return; 						\
+		default: 							\
+			compareScalar (col, numRows, op, val, high, out); 	\
+	}
+#else
+#define DISPATCH compareScalar (col, numRows, op, val, high, out);
+#endif
+
+void MyDB_PredicateKernels :: compare (const int32_t *col, size_t numRows, MyDB_CompareOp op, int32_t val, int32_t high, uint64_t *out) {
+	DISPATCH
+}
+
+void MyDB_PredicateKernels :: compare (const int64_t *col, size_t numRows, MyDB_CompareOp op, int64_t val, int64_t high, uint64_t *out) {
+	DISPATCH
+}
+
+void MyDB_PredicateKernels :: compare (const double *col, size_t numRows, MyDB_CompareOp op, double val, double high, uint64_t *out) {
+	DISPATCH
+}
+
+#undef DISPATCH
+
+void MyDB_PredicateKernels :: andBits (uint64_t *intoMe, const uint64_t *other, size_t numRows) {
+	for (size_t w = 0; w < numWords (numRows); w++)
+		intoMe[w] &= other[w];
+}
+
+void MyDB_PredicateKernels :: orBits (uint64_t *intoMe, const uint64_t *other, size_t numRows) {
+	for (size_t w = 0; w < numWords (numRows); w++)
+		intoMe[w] |= other[w];
+}
+
+void MyDB_PredicateKernels :: notBits (uint64_t *bits, size_t numRows) {
+	for (size_t w = 0; w < numWords (numRows); w++)
+		bits[w] = ~bits[w];
+
+	// keep the bits past the end at zero
+	if (numRows % 64 != 0)
+		bits[numRows / 64] &= (((uint64_t) 1) << (numRows % 64)) - 1;
+}
+
+void MyDB_PredicateKernels :: setBits (uint64_t *bits, size_t numRows, bool toMe) {
+	memset (bits, 0, numWords (numRows) * sizeof (uint64_t));
+	if (toMe)
+		notBits (bits, numRows);
+}
+
+size_t MyDB_PredicateKernels :: toSelection (const uint64_t *bits, size_t numRows, uint32_t *selection) {
+	size_t count = 0;
+	for (size_t w = 0; w < numWords (numRows); w++) {
+		uint64_t word = bits[w];
+		while (word != 0) {
+			selection[count++] = (uint32_t) (w * 64 + __builtin_ctzll (word));
+			word &= word - 1;
+		}
+	}
+	return count;
+}
+
+void MyDB_PredicateKernels :: fromSelection (const uint32_t *selection, size_t count, size_t numRows, uint64_t *bits) {
+	memset (bits, 0, numWords (numRows) * sizeof (uint64_t));
+	for (size_t i = 0; i < count; i++)
+		bits[selection[i] / 64] |= ((uint64_t) 1) << (selection[i] % 64);
+}
+
+size_t MyDB_PredicateKernels :: countBits (const uint64_t *bits, size_t numRows) {
+	size_t count = 0;
+	for (size_t w = 0; w < numWords (numRows); w++)
+		count += __builtin_popcountll (bits[w]);
+	return count;
+}
+
+bool MyDB_PredicateKernels :: noneSet (const uint64_t *bits, size_t numRows) {
+	for (size_t w = 0; w < numWords (numRows); w++) {
+		if (bits[w] != 0)
+			return false;
+	}
+	return true;
+}
+
+MyDB_KernelLevel MyDB_PredicateKernels :: getLevel () {
+	return curLevel;
+}
+
+MyDB_KernelLevel MyDB_PredicateKernels :: getBestLevel () {
+	return bestLevel;
+}
+
+void MyDB_PredicateKernels :: setLevel (MyDB_KernelLevel toMe) {
+	curLevel = ((int) toMe > (int) bestLevel) ? bestLevel : toMe;
+}
+
+const char *MyDB_PredicateKernels :: getLevelName (MyDB_KernelLevel forMe) {
+	switch (forMe) {
+		case MyDB_KernelLevel :: AVX2: return "AVX2";
+		case MyDB_KernelLevel :: SSE: return "SSE4.2";
+		default: return "scalar";
+	}
+}
+
+#endif
@@ -18,10 +18,15 @@ char *MyDB_Record :: findsymbol (char val, char *input) {
 
 func MyDB_Record :: compileComputation (string compileMe) {
 	char *str = (char *) compileMe.c_str ();
-	return compileHelper (str).first;
+	pair <valFunc, MyDB_AttTypePtr> res = compileHelper (str);
+
+	// the caller wants an attribute value back, so we allocate exactly one to hold the result
+	MyDB_AttValPtr result = res.second->createAtt ();
+	valFunc computation = res.first;
+	return [result, computation] {result->fromValue (computation ()); return result;};
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 	
 	// search for one of the infix symbols
 	while (true) {
@@ -319,9 +324,7 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			vals = findsymbol (']', vals);
 
 			// remember this value
-			MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-			scratch.push_back (temp);
-			temp->set (val);
+			MyDB_Value temp = MyDB_Value :: makeInt (val);
 
 			// returns a lambda that computes the result
 			return make_pair ([temp] {return temp;}, make_shared <MyDB_IntAttType> ());
@@ -333,9 +336,7 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			vals = findsymbol (']', vals);
 
 			// remember this value
-			MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-			scratch.push_back (temp);
-			temp->set (val);
+			MyDB_Value temp = MyDB_Value :: makeDouble (val);
 
 			// returns a lambda that computes the result
 			return make_pair ([temp] {return temp;}, make_shared <MyDB_DoubleAttType> ());
@@ -350,9 +351,7 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			vals = findsymbol (']', vals);
 
 			// remember this value
-			MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-			scratch.push_back (temp);
-			temp->set (val);
+			MyDB_Value temp = MyDB_Value :: makeBool (val);
 
 			// returns a lambda that computes the result
 			return make_pair ([temp] {return temp;}, make_shared <MyDB_BoolAttType> ());
@@ -366,7 +365,7 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			for (; vals[cnt] != ']'; cnt++);
 
 			// copy the string over
-			char name[cnt];
+			char name[cnt + 1];
 			for (cnt = 0; vals[cnt] != ']'; cnt++) {
 				name[cnt] = vals[cnt];
 			}	
@@ -375,13 +374,12 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 			// find the ]
 			vals = findsymbol (']', vals);
 	
-			// remember this value
-			MyDB_StringAttValPtr temp = make_shared <MyDB_StringAttVal> ();
-			scratch.push_back (temp);
-			temp->set (name);
+			// remember this value; the lambda owns the bytes, and the value is a view over them
+			shared_ptr <string> temp = make_shared <string> (string (name));
 
 			// returns a lambda that computes the result
-			return make_pair ([temp] {return temp;}, make_shared <MyDB_StringAttType> ());
+			return make_pair ([temp] {return MyDB_Value :: makeString (temp->data (), temp->size ());}, 
+				make_shared <MyDB_StringAttType> ());
 			
 		} else {
 			vals++;
@@ -389,40 +387,44 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: fromData (string attName) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: fromData (string attName) {
 
 	// just return a particular attribute
 	auto whichAtt = mySchema->getAttByName (attName);
-	return make_pair ([this, whichAtt] {return values[whichAtt.first];}, whichAtt.second);		
+	int which = whichAtt.first;
+	return make_pair ([this, which] {return getValue (which);}, whichAtt.second);		
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: plus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: plus (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () + rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeInt (l ().intVal + r ().intVal);},
 			make_shared <MyDB_IntAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () + rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeDouble (l ().toDouble () + r ().toDouble ());},
 			make_shared <MyDB_DoubleAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be strings, then do so
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_StringAttValPtr temp = make_shared <MyDB_StringAttVal> ();
-		scratch.push_back (temp);
+
+		// the result is built in this string, which is re-used from call to call
+		shared_ptr <string> temp = make_shared <string> ();
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () + rhs.first ()->toString ()); return temp;},
+		return make_pair ([temp, l, r] {
+				temp->clear (); 
+				l ().appendTo (*temp); 
+				r ().appendTo (*temp); 
+				return MyDB_Value :: makeString (temp->data (), temp->size ());},
 			make_shared <MyDB_StringAttType> ());
 
 	} else {
@@ -431,24 +433,22 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: plus (pair <func, MyDB_AttTypePtr> l
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: minus (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: minus (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () - rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeInt (l ().intVal - r ().intVal);},
 			make_shared <MyDB_IntAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () - rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeDouble (l ().toDouble () - r ().toDouble ());},
 			make_shared <MyDB_DoubleAttType> ());
 	
 	} else {
@@ -457,24 +457,22 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: minus (pair <func, MyDB_AttTypePtr>
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: unaryMinus (pair <func, MyDB_AttTypePtr> lhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: unaryMinus (pair <valFunc, MyDB_AttTypePtr> lhs) {
+
+	valFunc l = lhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs] {temp->set (-lhs.first ()->toInt ()); return temp;},
+		return make_pair ([l] {return MyDB_Value :: makeInt (-l ().intVal);},
 			make_shared <MyDB_IntAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs] {temp->set (-lhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l] {return MyDB_Value :: makeDouble (-l ().toDouble ());},
 			make_shared <MyDB_DoubleAttType> ());
 	
 	} else {
@@ -483,24 +481,22 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: unaryMinus (pair <func, MyDB_AttType
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: times (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: times (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () * rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeInt (l ().intVal * r ().intVal);},
 			make_shared <MyDB_IntAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () * rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeDouble (l ().toDouble () * r ().toDouble ());},
 			make_shared <MyDB_DoubleAttType> ());
 
 	} else {
@@ -509,24 +505,22 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: times (pair <func, MyDB_AttTypePtr>
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: divide (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: divide (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () / rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeInt (l ().intVal / r ().intVal);},
 			make_shared <MyDB_IntAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () / rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeDouble (l ().toDouble () / r ().toDouble ());},
 			make_shared <MyDB_DoubleAttType> ());
 
 	} else {
@@ -535,33 +529,33 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: divide (pair <func, MyDB_AttTypePtr>
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: gt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: gt (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () > rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().intVal > r ().intVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () > rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().toDouble () > r ().toDouble ());},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be strings, then do so
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+
+		// only used if one of the sides is not actually a string
+		shared_ptr <string> lTemp = make_shared <string> (), rTemp = make_shared <string> ();
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () > rhs.first ()->toString ()); return temp;},
+		return make_pair ([lTemp, rTemp, l, r] {
+				return MyDB_Value :: makeBool (l ().asString (*lTemp).compareString (r ().asString (*rTemp)) > 0);},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -570,33 +564,33 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: gt (pair <func, MyDB_AttTypePtr> lhs
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: lt (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: lt (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () < rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().intVal < r ().intVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () < rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().toDouble () < r ().toDouble ());},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be strings, then do so
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+
+		// only used if one of the sides is not actually a string
+		shared_ptr <string> lTemp = make_shared <string> (), rTemp = make_shared <string> ();
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () < rhs.first ()->toString ()); return temp;},
+		return make_pair ([lTemp, rTemp, l, r] {
+				return MyDB_Value :: makeBool (l ().asString (*lTemp).compareString (r ().asString (*rTemp)) < 0);},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -605,41 +599,39 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: lt (pair <func, MyDB_AttTypePtr> lhs
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: eq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: eq (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () == rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().intVal == r ().intVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () == rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().toDouble () == r ().toDouble ());},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () == rhs.first ()->toBool ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().boolVal == r ().boolVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be strings, then do so
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+
+		// only used if one of the sides is not actually a string
+		shared_ptr <string> lTemp = make_shared <string> (), rTemp = make_shared <string> ();
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () == rhs.first ()->toString ()); return temp;},
+		return make_pair ([lTemp, rTemp, l, r] {
+				return MyDB_Value :: makeBool (l ().asString (*lTemp).equalsString (r ().asString (*rTemp)));},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -648,41 +640,39 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: eq (pair <func, MyDB_AttTypePtr> lhs
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: neq (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: neq (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->promotableToInt () && rhs.second->promotableToInt ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toInt () != rhs.first ()->toInt ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().intVal != r ().intVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () != rhs.first ()->toBool ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().boolVal != r ().boolVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be doubles, then do so
 	} else if (lhs.second->promotableToDouble () && rhs.second->promotableToDouble ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toDouble () != rhs.first ()->toDouble ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().toDouble () != r ().toDouble ());},
 			make_shared <MyDB_BoolAttType> ());
 
 	// otherwise, if both sides can be cast upwards to be strings, then do so
 	} else if (lhs.second->promotableToString () && rhs.second->promotableToString ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
+
+		// only used if one of the sides is not actually a string
+		shared_ptr <string> lTemp = make_shared <string> (), rTemp = make_shared <string> ();
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toString () != rhs.first ()->toString ()); return temp;},
+		return make_pair ([lTemp, rTemp, l, r] {
+				return MyDB_Value :: makeBool (!l ().asString (*lTemp).equalsString (r ().asString (*rTemp)));},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -691,15 +681,15 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: neq (pair <func, MyDB_AttTypePtr> lh
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: orr (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: orr (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () || rhs.first ()->toBool ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().boolVal || r ().boolVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -708,15 +698,15 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: orr (pair <func, MyDB_AttTypePtr> lh
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: andd (pair <func, MyDB_AttTypePtr> lhs, pair <func, MyDB_AttTypePtr> rhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: andd (pair <valFunc, MyDB_AttTypePtr> lhs, pair <valFunc, MyDB_AttTypePtr> rhs) {
+
+	valFunc l = lhs.first, r = rhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->isBool () && rhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs, rhs] {temp->set (lhs.first ()->toBool () && rhs.first ()->toBool ()); return temp;},
+		return make_pair ([l, r] {return MyDB_Value :: makeBool (l ().boolVal && r ().boolVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -725,15 +715,15 @@ pair <func, MyDB_AttTypePtr> MyDB_Record :: andd (pair <func, MyDB_AttTypePtr> l
 	}
 }
 
-pair <func, MyDB_AttTypePtr> MyDB_Record :: nott (pair <func, MyDB_AttTypePtr> lhs) {
+pair <valFunc, MyDB_AttTypePtr> MyDB_Record :: nott (pair <valFunc, MyDB_AttTypePtr> lhs) {
+
+	valFunc l = lhs.first;
 
 	// if both sides can be cast upwards to be ints, then do so
 	if (lhs.second->isBool ()) {
-		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
-		scratch.push_back (temp);
 
 		// returns a lambda that computes the result
-		return make_pair ([temp, lhs] {temp->set (!lhs.first ()->toBool ()); return temp;},
+		return make_pair ([l] {return MyDB_Value :: makeBool (!l ().boolVal);},
 			make_shared <MyDB_BoolAttType> ());
 
 	} else {
@@ -761,6 +751,18 @@ void MyDB_Record :: writeAttsToBuffer () {
 	}		
 	*((short *) buffer) = (short) recSize;
 	bufferOld = false;
+
+	// the attributes are not buffered in the bytes that were just written, so getValue () reads through them
+	attLocs.assign (attLocs.size (), nullptr);
+}
+
+void MyDB_Record :: resetTypes () {
+	attTypes.clear ();
+	for (MyDB_AttValPtr temp : values) {
+		attTypes.push_back (temp->getValueType ());
+	}
+	attVals.resize (values.size ());
+	attLocs.assign (values.size (), nullptr);
 }
 
 void *MyDB_Record :: toBinary (void *toHere) {
@@ -788,10 +790,12 @@ void *MyDB_Record :: fromBinary (void *fromHere) {
 	// copy over
 	memcpy (buffer, fromHere, recSize);
 
-	// and set up the attributes
+	// and set up the attributes, along with their typed versions
 	char *recLoc = buffer + sizeof (short);
-	for (MyDB_AttValPtr temp : values) {
-		recLoc = temp->fromBinary (recLoc);
+	for (size_t i = 0; i < values.size (); i++) {
+		attVals[i] = MyDB_Value :: fromBinary (attTypes[i], recLoc);
+		attLocs[i] = recLoc + sizeof (short);
+		recLoc = values[i]->fromBinary (recLoc);
 	}		
 
 	bufferOld = false;
@@ -826,19 +830,103 @@ std::ostream& operator<<(std::ostream& os, const MyDB_RecordPtr printMe) {
 }
 
 function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation) {
+	return buildRecordComparator (lhs, rhs, vector <MyDB_CompareKey> {MyDB_CompareKey (computation)});
+}
 
-	// compile a computation over the LHS and over the RHS
-	char *str = (char *) computation.c_str ();
-	pair <func, MyDB_AttTypePtr> lhsFunc = lhs->compileHelper (str);
+function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, vector <MyDB_CompareKey> keys) {
+	function <int ()> compare = buildRecordCompare (lhs, rhs, keys);
+	return [compare] {return compare () < 0;};
+}
 
-	str = (char *) computation.c_str ();
-	pair <func, MyDB_AttTypePtr> rhsFunc = rhs->compileHelper (str);
+// builds a function that compares the values produced by getLHS and getRHS, which are both of the given
+// type.  A NaN sorts as a null: nanResult is what we return if the lhs is NaN and the rhs is not
+template <class GetLHS, class GetRHS>
+static function <int ()> compareValues (GetLHS getLHS, GetRHS getRHS, MyDB_ValueType type, int nanResult) {
+
+	switch (type) {
+
+		case MyDB_ValueType :: IntVal:
+			return [getLHS, getRHS] {
+				int64_t l = getLHS ().intVal, r = getRHS ().intVal;
+				return (l > r) - (l < r);
+			};
+
+		case MyDB_ValueType :: DoubleVal:
+			return [getLHS, getRHS, nanResult] {
+				double l = getLHS ().doubleVal, r = getRHS ().doubleVal;
+				if (l < r)
+					return -1;
+				if (l > r)
+					return 1;
+				if (l == r)
+					return 0;
+
+				// at least one of them is a NaN
+				bool lNaN = (l != l), rNaN = (r != r);
+				return (lNaN == rNaN) ? 0 : (lNaN ? nanResult : -nanResult);
+			};
+
+		case MyDB_ValueType :: BoolVal:
+			return [getLHS, getRHS] {return (int) getLHS ().boolVal - (int) getRHS ().boolVal;};
+
+		default:
+			return [getLHS, getRHS] {return getLHS ().compareString (getRHS ());};
+	}
+}
 
-	// and then build a lambda that performs the computatation
-	auto res = lhs->lt (lhsFunc, rhsFunc);
-	func temp = res.first;
-	return [=] {return temp ()->toBool ();};
-	
+function <int ()> buildRecordCompare (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, vector <MyDB_CompareKey> keys) {
+
+	// build the keys from last to first, so that each one can fall back on the ones after it
+	function <int ()> returnVal = [] {return 0;};
+	for (auto key = keys.rbegin (); key != keys.rend (); key++) {
+
+		// a descending key is just an ascending key with lhs and rhs switched
+		MyDB_Record *l = lhs.get (), *r = rhs.get ();
+		if (!key->ascending)
+			swap (l, r);
+		int nanResult = (key->nullsFirst == key->ascending) ? -1 : 1;
+
+		// see if this key is just an attribute; if it is, we can read it right out of the records
+		string computation = key->computation;
+		size_t start = computation.find_first_not_of (" \t\n");
+		size_t end = computation.find_last_not_of (" \t\n");
+		int whichAtt = -1;
+		MyDB_AttTypePtr type;
+		if (start != string :: npos && computation[start] == '[' && computation[end] == ']' &&
+			computation.find (']', start) == end) {
+			auto att = lhs->mySchema->getAttByName (computation.substr (start + 1, end - start - 1));
+			whichAtt = att.first;
+			type = att.second;
+		}
+
+		function <int ()> compareKey;
+		if (whichAtt >= 0) {
+			auto getLHS = [l, whichAtt] () -> const MyDB_Value & {return l->getValue (whichAtt);};
+			auto getRHS = [r, whichAtt] () -> const MyDB_Value & {return r->getValue (whichAtt);};
+			compareKey = compareValues (getLHS, getRHS, type->createAtt ()->getValueType (), nanResult);
+
+		// otherwise, compile the computation over both records
+		} else {
+			char *str = (char *) computation.c_str ();
+			pair <valFunc, MyDB_AttTypePtr> lhsFunc = l->compileHelper (str);
+			str = (char *) computation.c_str ();
+			pair <valFunc, MyDB_AttTypePtr> rhsFunc = r->compileHelper (str);
+			compareKey = compareValues (lhsFunc.first, rhsFunc.first, lhsFunc.second->createAtt ()->getValueType (), nanResult);
+		}
+
+		// the last key has nothing to fall back on
+		if (key == keys.rbegin ()) {
+			returnVal = compareKey;
+		} else {
+			function <int ()> nextKeys = returnVal;
+			returnVal = [compareKey, nextKeys] {
+				int res = compareKey ();
+				return res != 0 ? res : nextKeys ();
+			};
+		}
+	}
+
+	return returnVal;
 }
 
 MyDB_Record :: MyDB_Record (MyDB_SchemaPtr mySchemaIn) {
@@ -855,6 +943,7 @@ MyDB_Record :: MyDB_Record (MyDB_SchemaPtr mySchemaIn) {
 	for (auto &val : mySchema->getAtts ()) {
 		values.push_back (val.second->createAtt ());	
 	}
+	resetTypes ();
 }
 
 MyDB_SchemaPtr MyDB_Record :: getSchema () {
@@ -874,6 +963,8 @@ void MyDB_Record :: buildFrom (MyDB_RecordPtr left, MyDB_RecordPtr right) {
                 newValues.push_back (v);
         }
         values = newValues;
+	resetTypes ();
+	bufferOld = true;
 }
 
 MyDB_Record :: ~MyDB_Record () {
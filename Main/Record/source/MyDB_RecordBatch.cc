@@ -0,0 +1,178 @@
+
+#ifndef RECORD_BATCH_C
+#define RECORD_BATCH_C
+
+#include "MyDB_RecordBatch.h"
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+// the size of each of the chunks that the serialized records are stored in
+#define BATCH_CHUNK_SIZE 65536
+
+MyDB_RecordBatch :: MyDB_RecordBatch (MyDB_SchemaPtr mySchemaIn, size_t capacityIn) {
+	mySchema = mySchemaIn;
+	capacity = capacityIn;
+	vector <bool> projected (mySchema->getAtts ().size (), true);
+	makeColumns (projected);
+}
+
+MyDB_RecordBatch :: MyDB_RecordBatch (MyDB_SchemaPtr mySchemaIn, vector <string> projection, size_t capacityIn) {
+	mySchema = mySchemaIn;
+	capacity = capacityIn;
+	vector <bool> projected (mySchema->getAtts ().size (), false);
+	for (string &att : projection) {
+		int whichAtt = mySchema->getAttByName (att).first;
+		if (whichAtt == -1) {
+			cout << "Could not find attribute " << att << " to project.\n";
+			exit (1);
+		}
+		projected[whichAtt] = true;
+	}
+	makeColumns (projected);
+}
+
+void MyDB_RecordBatch :: makeColumns (vector <bool> &projected) {
+	numRows = 0;
+	curChunk = 0;
+	curUsed = 0;
+
+	// set up a column for each attribute
+	int whichAtt = 0;
+	for (auto &att : mySchema->getAtts ()) {
+		MyDB_Column temp;
+		temp.type = att.second->createAtt ()->getValueType ();
+		temp.projected = projected[whichAtt++];
+		if (!temp.projected) {
+			columns.push_back (temp);
+			continue;
+		}
+		switch (temp.type) {
+			case MyDB_ValueType :: IntVal: temp.ints.resize (capacity); break;
+			case MyDB_ValueType :: DoubleVal: temp.doubles.resize (capacity); break;
+			case MyDB_ValueType :: BoolVal: temp.bools.resize (capacity); break;
+			default: temp.strings.resize (capacity);
+		}
+		columns.push_back (temp);
+	}
+	rows.resize (capacity);
+}
+
+void MyDB_RecordBatch :: clear () {
+	numRows = 0;
+	curChunk = 0;
+	curUsed = 0;
+}
+
+char *MyDB_RecordBatch :: allocate (size_t len) {
+
+	// move on to the next chunk, if this one is full
+	if (curChunk < chunks.size () && curUsed + len > chunks[curChunk].size ()) {
+		curChunk++;
+		curUsed = 0;
+	}
+
+	// and make sure that the chunk is there (and is big enough)
+	if (curChunk == chunks.size ()) {
+		chunks.emplace_back (len > BATCH_CHUNK_SIZE ? len : BATCH_CHUNK_SIZE);
+	} else if (chunks[curChunk].size () < len) {
+		chunks[curChunk].resize (len);
+	}
+
+	char *returnVal = chunks[curChunk].data () + curUsed;
+	curUsed += len;
+	return returnVal;
+}
+
+void MyDB_RecordBatch :: append (MyDB_RecordPtr appendMe) {
+	if (numRows == capacity) {
+		cout << "Tried to append to a full batch.\n";
+		exit (1);
+	}
+	char *where = allocate (appendMe->getBinarySize ());
+	appendMe->toBinary (where);
+	decodeRow (where);
+}
+
+void *MyDB_RecordBatch :: appendBinary (void *fromHere) {
+	if (numRows == capacity) {
+		cout << "Tried to append to a full batch.\n";
+		exit (1);
+	}
+	size_t recSize = *((unsigned short *) fromHere);
+	char *where = allocate (recSize);
+	memcpy (where, fromHere, recSize);
+	decodeRow (where);
+	return ((char *) fromHere) + recSize;
+}
+
+void MyDB_RecordBatch :: decodeRow (char *fromHere) {
+	rows[numRows] = fromHere;
+	char *recLoc = fromHere + sizeof (short);
+	for (MyDB_Column &col : columns) {
+		if (!col.projected) {
+			recLoc += *((short *) recLoc);
+			continue;
+		}
+		MyDB_Value temp = MyDB_Value :: fromBinary (col.type, recLoc);
+		switch (col.type) {
+			case MyDB_ValueType :: IntVal: col.ints[numRows] = temp.intVal; break;
+			case MyDB_ValueType :: DoubleVal: col.doubles[numRows] = temp.doubleVal; break;
+			case MyDB_ValueType :: BoolVal: col.bools[numRows] = temp.boolVal; break;
+			default: col.strings[numRows] = temp;
+		}
+		recLoc += *((short *) recLoc);
+	}
+	numRows++;
+}
+
+void MyDB_RecordBatch :: getRecord (size_t whichRow, MyDB_RecordPtr intoMe) {
+	intoMe->fromBinary (rows[whichRow]);
+}
+
+void *MyDB_RecordBatch :: getBinary (size_t whichRow) {
+	return rows[whichRow];
+}
+
+size_t MyDB_RecordBatch :: size () {
+	return numRows;
+}
+
+size_t MyDB_RecordBatch :: getCapacity () {
+	return capacity;
+}
+
+bool MyDB_RecordBatch :: isFull () {
+	return numRows == capacity;
+}
+
+MyDB_SchemaPtr MyDB_RecordBatch :: getSchema () {
+	return mySchema;
+}
+
+bool MyDB_RecordBatch :: isProjected (int whichAtt) {
+	return columns[whichAtt].projected;
+}
+
+MyDB_ValueType MyDB_RecordBatch :: getType (int whichAtt) {
+	return columns[whichAtt].type;
+}
+
+const int64_t *MyDB_RecordBatch :: getInts (int whichAtt) {
+	return columns[whichAtt].ints.data ();
+}
+
+const double *MyDB_RecordBatch :: getDoubles (int whichAtt) {
+	return columns[whichAtt].doubles.data ();
+}
+
+const char *MyDB_RecordBatch :: getBools (int whichAtt) {
+	return columns[whichAtt].bools.data ();
+}
+
+const MyDB_Value *MyDB_RecordBatch :: getStrings (int whichAtt) {
+	return columns[whichAtt].strings.data ();
+}
+
+#endif
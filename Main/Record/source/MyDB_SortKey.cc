@@ -0,0 +1,234 @@
+
+#ifndef SORT_KEY_C
+#define SORT_KEY_C
+
+#include "MyDB_AttType.h"
+#include "MyDB_SortKey.h"
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+
+using namespace std;
+
+// below this many records, std :: sort beats the radix sort (which makes up to 8 passes over
+// the records, no matter how many there are)
+#define RADIX_CUTOFF 2048
+
+MyDB_SortKey :: MyDB_SortKey (MyDB_SchemaPtr forMe, vector <pair <string, bool>> attsIn) {
+
+	vector <MyDB_SortAtt> res;
+	for (auto &att : attsIn) {
+		auto whichAtt = forMe->getAttByName (att.first);
+		if (whichAtt.first < 0) {
+			cout << "Could not find attribute " << att.first << " to sort on.\n";
+			exit (1);
+		}
+		res.push_back (MyDB_SortAtt {whichAtt.first, whichAtt.second->createAtt ()->getValueType (), att.second});
+	}
+	*this = MyDB_SortKey (res);
+}
+
+MyDB_SortKey :: MyDB_SortKey (vector <MyDB_SortAtt> attsIn) {
+
+	atts = attsIn;
+	useRadix = true;
+	maxAtt = -1;
+	size_t keyLen = 0;
+	fixedKey = true;
+	for (auto &att : atts) {
+		if (att.whichAtt > maxAtt)
+			maxAtt = att.whichAtt;
+		if (att.type == MyDB_ValueType :: StringVal)
+			fixedKey = false;
+		else
+			keyLen += (att.type == MyDB_ValueType :: BoolVal) ? 1 : 8;
+	}
+	if (keyLen > 8)
+		fixedKey = false;
+	attLocs.resize (maxAtt + 1);
+}
+
+// writes the integer to the string, most significant byte first
+static inline void appendBigEndian (uint64_t val, string &appendToMe) {
+	char bytes[8];
+	for (int i = 7; i >= 0; i--) {
+		bytes[i] = (char) (val & 0xFF);
+		val >>= 8;
+	}
+	appendToMe.append (bytes, 8);
+}
+
+void MyDB_SortKey :: encodeValue (const MyDB_Value &val, bool ascending, string &appendToMe) {
+
+	size_t start = appendToMe.size ();
+	switch (val.type) {
+
+		// flipping the sign bit makes the negative numbers come first
+		case MyDB_ValueType :: IntVal:
+			appendBigEndian (((uint64_t) val.intVal) ^ (((uint64_t) 1) << 63), appendToMe);
+			break;
+
+		// for a positive double, flipping the sign bit is enough; for a negative one, we need
+		// to flip all of the bits, so that the larger magnitudes come first.  -0 == 0, so make
+		// sure that they get the same key
+		case MyDB_ValueType :: DoubleVal: {
+			double d = (val.doubleVal == 0) ? 0.0 : val.doubleVal;
+			uint64_t bits;
+			memcpy (&bits, &d, sizeof (bits));
+			if (bits >> 63)
+				bits = ~bits;
+			else
+				bits ^= ((uint64_t) 1) << 63;
+			appendBigEndian (bits, appendToMe);
+			break;
+		}
+
+		case MyDB_ValueType :: BoolVal:
+			appendToMe.push_back ((char) val.boolVal);
+			break;
+
+		// strings cannot have a zero in them, so ending with a zero puts a string before
+		// all of the longer strings that start with it
+		default:
+			appendToMe.append (val.strVal, val.strLen);
+			appendToMe.push_back (0);
+	}
+
+	if (!ascending) {
+		for (size_t i = start; i < appendToMe.size (); i++)
+			appendToMe[i] = ~appendToMe[i];
+	}
+}
+
+void MyDB_SortKey :: encode (void *rec, string &appendToMe) {
+
+	// find each of the attributes
+	char *recLoc = ((char *) rec) + sizeof (short);
+	for (int i = 0; i <= maxAtt; i++) {
+		attLocs[i] = recLoc;
+		recLoc += *((short *) recLoc);
+	}
+
+	// and write out the key
+	for (auto &att : atts)
+		encodeValue (MyDB_Value :: fromBinary (att.type, attLocs[att.whichAtt]), att.ascending, appendToMe);
+}
+
+int MyDB_SortKey :: compare (void *lhs, void *rhs) {
+	lhsKey.clear ();
+	rhsKey.clear ();
+	encode (lhs, lhsKey);
+	encode (rhs, rhsKey);
+	return lhsKey.compare (rhsKey);
+}
+
+uint64_t MyDB_SortKey :: getPrefix (const char *key, size_t len) {
+	uint64_t returnVal = 0;
+	for (size_t i = 0; i < 8; i++) {
+		returnVal <<= 8;
+		if (i < len)
+			returnVal |= (unsigned char) key[i];
+	}
+	return returnVal;
+}
+
+void MyDB_SortKey :: sort (vector <void *> &recs) {
+
+	// get all of the keys
+	allKeys.clear ();
+	entries.resize (recs.size ());
+	for (size_t i = 0; i < recs.size (); i++) {
+		size_t start = allKeys.size ();
+		encode (recs[i], allKeys);
+		entries[i].offset = (uint32_t) start;
+		entries[i].len = (uint32_t) (allKeys.size () - start);
+		entries[i].rec = recs[i];
+	}
+	const char *keys = allKeys.data ();
+	for (auto &entry : entries)
+		entry.prefix = getPrefix (keys + entry.offset, entry.len);
+
+	// and sort them; we only have to look at the rest of the key when the prefixes are the same
+	if (useRadix && entries.size () >= RADIX_CUTOFF) {
+		radixSort ();
+
+		// now fix up each group of records with the same prefix
+		if (!fixedKey) {
+			for (size_t i = 0; i < entries.size ();) {
+				size_t j = i + 1;
+				while (j < entries.size () && entries[j].prefix == entries[i].prefix)
+					j++;
+				if (j - i > 1) {
+					std :: sort (entries.begin () + i, entries.begin () + j, [keys] (const MyDB_KeyEntry &lhs, const MyDB_KeyEntry &rhs) {
+						int res = memcmp (keys + lhs.offset, keys + rhs.offset, min (lhs.len, rhs.len));
+						return res < 0 || (res == 0 && lhs.len < rhs.len);
+					});
+				}
+				i = j;
+			}
+		}
+	} else if (fixedKey) {
+		std :: sort (entries.begin (), entries.end (), [] (const MyDB_KeyEntry &lhs, const MyDB_KeyEntry &rhs) {
+			return lhs.prefix < rhs.prefix;
+		});
+	} else {
+		std :: sort (entries.begin (), entries.end (), [keys] (const MyDB_KeyEntry &lhs, const MyDB_KeyEntry &rhs) {
+			if (lhs.prefix != rhs.prefix)
+				return lhs.prefix < rhs.prefix;
+			int res = memcmp (keys + lhs.offset, keys + rhs.offset, min (lhs.len, rhs.len));
+			return res < 0 || (res == 0 && lhs.len < rhs.len);
+		});
+	}
+
+	for (size_t i = 0; i < recs.size (); i++)
+		recs[i] = entries[i].rec;
+}
+
+void MyDB_SortKey :: radixSort () {
+
+	// count up how many times each value of each byte of the prefix appears
+	size_t n = entries.size ();
+	vector <size_t> counts (8 * 256, 0);
+	for (auto &entry : entries) {
+		uint64_t prefix = entry.prefix;
+		for (int b = 0; b < 8; b++)
+			counts[b * 256 + ((prefix >> (b * 8)) & 0xFF)]++;
+	}
+
+	// and do one pass for each byte, starting at the least significant one
+	radixTemp.resize (n);
+	for (int b = 0; b < 8; b++) {
+
+		// if every record has the same value in this byte, there is nothing to do
+		size_t *count = &counts[b * 256];
+		if (count[(entries[0].prefix >> (b * 8)) & 0xFF] == n)
+			continue;
+
+		// figure out where each value starts
+		size_t total = 0;
+		for (int i = 0; i < 256; i++) {
+			size_t temp = count[i];
+			count[i] = total;
+			total += temp;
+		}
+
+		// and scatter
+		for (auto &entry : entries)
+			radixTemp[count[(entry.prefix >> (b * 8)) & 0xFF]++] = entry;
+		entries.swap (radixTemp);
+	}
+}
+
+void MyDB_SortKey :: setRadixSort (bool useIt) {
+	useRadix = useIt;
+}
+
+bool MyDB_SortKey :: prefixIsKey () {
+	return fixedKey;
+}
+
+vector <MyDB_SortAtt> &MyDB_SortKey :: getAtts () {
+	return atts;
+}
+
+#endif
@@ -3,17 +3,24 @@
 #define RECORD_TEST_H
 
 #include "MyDB_AttType.h"  
+#include "MyDB_BatchComputation.h"
+#include "MyDB_BatchPredicate.h"
 #include "MyDB_BufferManager.h"
+#include "MyDB_ByteCode.h"
 #include "MyDB_Catalog.h"  
 #include "MyDB_Page.h"
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_Record.h"
+#include "MyDB_RecordBatch.h"
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Schema.h"
 #include "QUnit.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <time.h>
 #include <unistd.h>
 #include <vector>
@@ -50,6 +57,18 @@ void initialize() {
 	cout << "finish initialization..." << flush;
 }
 
+// the shapes of the predicates in Test.sql, written over the supplier table
+vector <string> getTestPredicates() {
+	return {
+		"&& (&& (== ([nationkey], int[3]), || (> ([phone], string[20]), == ([phone], string[20]))), ! (< ([phone], string[25])))",
+		"> (* ([acctbal], - (int[1], double[0.05])), double[4000.0])",
+		"== (+ (int[1200], / ([suppkey], + (double[300.0], int[34]))), int[1210])",
+		"&& (== (+ (string[1204], [name]), [address]), > (+ (+ ([acctbal], [nationkey]), [suppkey]), double[3.27]))",
+		"|| (> (+ (+ ([acctbal], [nationkey]), [suppkey]), double[5000.0]), > (+ ([nationkey], [acctbal]), string[327]))",
+		"|| (> (+ (string[this is a string], string[this is another string]), string[here is another]), < ([suppkey], int[100]))",
+		"+ (* ([acctbal], - (int[1], [nationkey])), um ([suppkey]))"};
+}
+
 int main(int argc, char *argv[]) {
 	int start = 1;
 	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
@@ -463,6 +482,703 @@ int main(int argc, char *argv[]) {
 		QUNIT_IS_FALSE(result);
 	}
 	FALLTHROUGH_INTENDED;
+	case 10:
+	{
+		// compiled computations over the typed values in a record
+		cout << "TEST 10..." << flush;
+		initialize();
+		string result = "";
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+
+			cout << "create TableReaderWriter..." << flush;
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+			MyDB_RecordPtr temp2 = supplierTable.getEmptyRecord();
+
+			cout << "compile..." << flush;
+			func sum = temp->compileComputation("+ ([suppkey], [nationkey])");
+			func pred = temp->compileComputation("&& (> ([acctbal], double[4000.5]), == ([name], string[Supplier#000000002]))");
+			func concat = temp->compileComputation("+ ([name], [suppkey])");
+			function <bool ()> comp = buildRecordComparator(temp, temp2, "[name]");
+			function <bool ()> compReversed = buildRecordComparator(temp2, temp, "[name]");
+
+			cout << "load 1st and 2nd records..." << flush;
+			char copy[1024];
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			myIter->getNext();
+			temp->toBinary(copy);
+			temp2->fromBinary(copy);
+			myIter->getNext();
+
+			cout << "evaluate..." << flush;
+			stringstream ss;
+			ss << sum()->toInt() << "|" << pred()->toBool() << "|" << concat()->toString() << "|" 
+				<< comp() << "|" << compReversed() << "|" 
+				<< (temp->getAtt(1)->hash() == temp->getAtt(1)->getCopy()->hash());
+			result = ss.str();
+
+			cout << "shutdown manager..." << flush;
+		}
+		const string answer = "7|1|Supplier#0000000022|0|1|1";
+		if (result == answer) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_EQUAL(result, answer);
+	}
+	FALLTHROUGH_INTENDED;
+	case 11:
+	{
+		// bytecode vs. lambdas, on the shapes of the predicates in Test.sql (written over supplier)
+		cout << "TEST 11..." << flush;
+		initialize();
+		bool allMatch = true;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+
+			// copy the table into RAM, so that we are just timing the computations
+			cout << "load records..." << flush;
+			vector <char> allRecs;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				size_t at = allRecs.size();
+				allRecs.resize(at + temp->getBinarySize());
+				temp->toBinary(&allRecs[at]);
+			}
+			cout << endl;
+
+			vector <string> preds = getTestPredicates();
+
+			for (string &pred : preds) {
+				func lambda = temp->compileComputation(pred);
+				MyDB_ByteCode byteCode(temp, pred);
+				func byteCodeFunc = byteCode.getFunc();
+
+				// first, make sure we get the same answer on every record
+				for (char *pos = allRecs.data(); pos < allRecs.data() + allRecs.size();) {
+					pos = (char *) temp->fromBinary(pos);
+					if (lambda()->toString() != byteCodeFunc()->toString())
+						allMatch = false;
+				}
+
+				// now time them; we sum up the hashes of the answers so that nothing is optimized away,
+				// and we take out the time needed to just load the records
+				double lambdaSum = 0, byteCodeSum = 0;
+				clock_t t1 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (char *pos = allRecs.data(); pos < allRecs.data() + allRecs.size();) {
+						pos = (char *) temp->fromBinary(pos);
+					}
+				}
+				clock_t t2 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (char *pos = allRecs.data(); pos < allRecs.data() + allRecs.size();) {
+						pos = (char *) temp->fromBinary(pos);
+						lambdaSum += lambda()->hash();
+					}
+				}
+				clock_t t3 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (char *pos = allRecs.data(); pos < allRecs.data() + allRecs.size();) {
+						pos = (char *) temp->fromBinary(pos);
+						byteCodeSum += byteCode.run().hash();
+					}
+				}
+				clock_t t4 = clock();
+				if (lambdaSum != byteCodeSum)
+					allMatch = false;
+				cout << "\t" << pred.substr(0, 40) << "...\n\t\tlambdas: " << (double) ((t3 - t2) - (t2 - t1)) / CLOCKS_PER_SEC
+					<< "s, bytecode: " << (double) ((t4 - t3) - (t2 - t1)) / CLOCKS_PER_SEC << "s\n" << flush;
+			}
+			cout << "shutdown manager..." << flush;
+		}
+		if (allMatch) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(allMatch);
+	}
+	FALLTHROUGH_INTENDED;
+	case 12:
+	{
+		// batch-at-a-time computations vs. bytecode
+		cout << "TEST 12..." << flush;
+		initialize();
+		bool allMatch = true;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+			MyDB_SchemaPtr mySchema = temp->getSchema();
+
+			// copy the table into batches
+			cout << "load batches..." << flush;
+			vector <MyDB_RecordBatchPtr> batches;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(temp);
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				if (batches.empty() || batches.back()->isFull())
+					batches.push_back(make_shared <MyDB_RecordBatch>(mySchema));
+				batches.back()->append(temp);
+			}
+			cout << endl;
+
+			for (string &pred : getTestPredicates()) {
+				MyDB_BatchComputation batchComp(mySchema, pred);
+				MyDB_ByteCode byteCode(temp, pred);
+				bool isFilter = batchComp.getType()->isBool();
+
+				// make sure that we get the same answers
+				vector <uint32_t> selection;
+				for (MyDB_RecordBatchPtr batch : batches) {
+					if (isFilter) {
+						batchComp.filter(*batch, selection);
+						size_t next = 0;
+						for (size_t i = 0; i < batch->size(); i++) {
+							batch->getRecord(i, temp);
+							bool selected = next < selection.size() && selection[next] == i;
+							if (selected)
+								next++;
+							if (selected != byteCode.run().boolVal)
+								allMatch = false;
+						}
+					} else {
+						batchComp.run(*batch);
+						for (size_t i = 0; i < batch->size(); i++) {
+							batch->getRecord(i, temp);
+							if (batchComp.getResult(i).toString() != byteCode.run().toString())
+								allMatch = false;
+						}
+					}
+				}
+
+				// and time them; for the bytecode, we take out the time needed to just load the records
+				size_t byteCodeCount = 0, batchCount = 0;
+				clock_t t1 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (MyDB_RecordBatchPtr batch : batches) {
+						for (size_t j = 0; j < batch->size(); j++)
+							batch->getRecord(j, temp);
+					}
+				}
+				clock_t t2 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (MyDB_RecordBatchPtr batch : batches) {
+						for (size_t j = 0; j < batch->size(); j++) {
+							batch->getRecord(j, temp);
+							if (isFilter)
+								byteCodeCount += byteCode.run().boolVal;
+							else
+								byteCodeCount += byteCode.run().hash() & 1;
+						}
+					}
+				}
+				clock_t t3 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (MyDB_RecordBatchPtr batch : batches) {
+						if (isFilter) {
+							batchComp.filter(*batch, selection);
+							batchCount += selection.size();
+						} else {
+							batchComp.run(*batch);
+							for (size_t j = 0; j < batch->size(); j++)
+								batchCount += batchComp.getResult(j).hash() & 1;
+						}
+					}
+				}
+				clock_t t4 = clock();
+				if (byteCodeCount != batchCount)
+					allMatch = false;
+				cout << "\t" << pred.substr(0, 40) << "...\n\t\tbytecode: " << (double) ((t3 - t2) - (t2 - t1)) / CLOCKS_PER_SEC
+					<< "s, batch: " << (double) (t4 - t3) / CLOCKS_PER_SEC << "s\n" << flush;
+			}
+			cout << "shutdown manager..." << flush;
+		}
+		if (allMatch) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(allMatch);
+	}
+	FALLTHROUGH_INTENDED;
+	case 13:
+	{
+		// reading the table a batch at a time vs. a record at a time
+		cout << "TEST 13..." << flush;
+		initialize();
+		bool allMatch = true;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+			MyDB_SchemaPtr mySchema = temp->getSchema();
+			auto recString = [] (MyDB_RecordPtr rec) {
+				ostringstream out;
+				out << rec;
+				return out.str();
+			};
+
+			// get the records one at a time
+			vector <string> allRecs;
+			MyDB_RecordIteratorAltPtr myIter = supplierTable.getIteratorAlt();
+			while (myIter->advance()) {
+				myIter->getCurrent(temp);
+				allRecs.push_back(recString(temp));
+			}
+
+			// and then a batch at a time, with a projection
+			MyDB_RecordBatch batch(mySchema, {"suppkey", "name", "acctbal"}, 1000);
+			size_t counter = 0;
+			myIter = supplierTable.getIteratorAlt();
+			while (myIter->getNextBatch(batch)) {
+				const int64_t *keys = batch.getInts(0);
+				const MyDB_Value *names = batch.getStrings(1);
+				const double *bals = batch.getDoubles(5);
+				for (size_t i = 0; i < batch.size(); i++, counter++) {
+					batch.getRecord(i, temp);
+					if (counter >= allRecs.size() || recString(temp) != allRecs[counter] ||
+						keys[i] != temp->getAtt(0)->toInt() || names[i].toString() != temp->getAtt(1)->toString() ||
+						bals[i] != temp->getAtt(5)->toDouble())
+						allMatch = false;
+				}
+			}
+			if (counter != allRecs.size() || batch.isProjected(2))
+				allMatch = false;
+
+			// mix batches with advance (); the batches should pick up right where advance () left off
+			MyDB_RecordBatch smallBatch(mySchema, 7);
+			counter = 0;
+			myIter = supplierTable.getIteratorAlt();
+			while (true) {
+				bool more = false;
+				for (int i = 0; i < 5 && (more = myIter->advance()); i++) {
+					myIter->getCurrent(temp);
+					if (counter >= allRecs.size() || recString(temp) != allRecs[counter++])
+						allMatch = false;
+				}
+				if (more)
+					more = myIter->getNextBatch(smallBatch);
+				for (size_t i = 0; more && i < smallBatch.size(); i++) {
+					smallBatch.getRecord(i, temp);
+					if (counter >= allRecs.size() || recString(temp) != allRecs[counter++])
+						allMatch = false;
+				}
+				if (!more)
+					break;
+			}
+			if (counter != allRecs.size())
+				allMatch = false;
+
+			// and a list of pages
+			vector <MyDB_PageReaderWriter> pages;
+			for (int i = 0; i < 5; i++)
+				pages.push_back(supplierTable[i]);
+			size_t numOnPages = 0;
+			myIter = getIteratorAlt(pages);
+			while (myIter->advance()) {
+				myIter->getCurrent(temp);
+				numOnPages++;
+			}
+			counter = 0;
+			myIter = getIteratorAlt(pages);
+			while (myIter->getNextBatch(smallBatch)) {
+				for (size_t i = 0; i < smallBatch.size(); i++, counter++) {
+					smallBatch.getRecord(i, temp);
+					if (recString(temp) != allRecs[counter])
+						allMatch = false;
+				}
+			}
+			if (counter != numOnPages)
+				allMatch = false;
+
+			// time a scan that adds up the account balances
+			double total1 = 0, total2 = 0;
+			clock_t t1 = clock();
+			for (int i = 0; i < 20; i++) {
+				myIter = supplierTable.getIteratorAlt();
+				while (myIter->advance()) {
+					myIter->getCurrent(temp);
+					total1 += temp->getAtt(5)->toDouble();
+				}
+			}
+			clock_t t2 = clock();
+			MyDB_RecordBatch balBatch(mySchema, {"acctbal"});
+			for (int i = 0; i < 20; i++) {
+				myIter = supplierTable.getIteratorAlt();
+				while (myIter->getNextBatch(balBatch)) {
+					const double *bals = balBatch.getDoubles(5);
+					for (size_t j = 0; j < balBatch.size(); j++)
+						total2 += bals[j];
+				}
+			}
+			clock_t t3 = clock();
+			if (total1 != total2)
+				allMatch = false;
+			cout << "\n\trecord at a time: " << (double) (t2 - t1) / CLOCKS_PER_SEC << "s, batch at a time: "
+				<< (double) (t3 - t2) / CLOCKS_PER_SEC << "s\n" << flush;
+			cout << "shutdown manager..." << flush;
+		}
+		if (allMatch) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(allMatch);
+	}
+	FALLTHROUGH_INTENDED;
+	case 14:
+	{
+		// vectorized predicate kernels vs. the lambdas from compileComputation
+		cout << "TEST 14..." << flush;
+		initialize();
+		bool allMatch = true;
+		{
+			// first, check the kernels at each level against a plain loop, over random columns
+			// whose length is not a multiple of 64
+			srand48(14);
+			size_t n = 1000;
+			vector <int32_t> ints(n);
+			vector <int64_t> longs(n);
+			vector <double> doubles(n);
+			for (size_t i = 0; i < n; i++) {
+				ints[i] = lrand48() % 100 - 50;
+				longs[i] = (lrand48() % 100 - 50) * 10000000000LL;
+				doubles[i] = (i % 97 == 0) ? NAN : drand48() * 100 - 50;
+			}
+			vector <uint64_t> bits(MyDB_PredicateKernels::numWords(n)), expected(bits.size());
+			vector <MyDB_CompareOp> ops = {MyDB_CompareOp::Equal, MyDB_CompareOp::NotEqual, MyDB_CompareOp::LessThan,
+				MyDB_CompareOp::GreaterThan, MyDB_CompareOp::Between};
+			for (int level = 0; level <= (int) MyDB_PredicateKernels::getBestLevel(); level++) {
+				MyDB_PredicateKernels::setLevel((MyDB_KernelLevel) level);
+				for (MyDB_CompareOp op : ops) {
+					for (int t = 0; t < 3; t++) {
+						double lo = (t == 2) ? 10.5 : 10, hi = (t == 2) ? 30.5 : 30;
+						if (t == 0)
+							MyDB_PredicateKernels::compare(ints.data(), n, op, (int32_t) lo, (int32_t) hi, bits.data());
+						else if (t == 1)
+							MyDB_PredicateKernels::compare(longs.data(), n, op, (int64_t) lo * 10000000000LL,
+								(int64_t) hi * 10000000000LL, bits.data());
+						else
+							MyDB_PredicateKernels::compare(doubles.data(), n, op, lo, hi, bits.data());
+						fill(expected.begin(), expected.end(), 0);
+						for (size_t i = 0; i < n; i++) {
+							double v = (t == 0) ? ints[i] : (t == 1) ? longs[i] / 10000000000LL : doubles[i];
+							bool res;
+							switch (op) {
+								case MyDB_CompareOp::Equal: res = v == lo; break;
+								case MyDB_CompareOp::NotEqual: res = v != lo; break;
+								case MyDB_CompareOp::LessThan: res = v < lo; break;
+								case MyDB_CompareOp::GreaterThan: res = v > lo; break;
+								default: res = v >= lo && v <= hi;
+							}
+							expected[i / 64] |= ((uint64_t) res) << (i % 64);
+						}
+						if (bits != expected)
+							allMatch = false;
+					}
+				}
+			}
+			MyDB_PredicateKernels::setLevel(MyDB_PredicateKernels::getBestLevel());
+
+			// and the combinators
+			vector <uint64_t> other(bits.size()), both(bits.size());
+			MyDB_PredicateKernels::compare(ints.data(), n, MyDB_CompareOp::GreaterThan, 0, 0, bits.data());
+			MyDB_PredicateKernels::compare(doubles.data(), n, MyDB_CompareOp::LessThan, 25.0, 0, other.data());
+			both = bits;
+			MyDB_PredicateKernels::andBits(both.data(), other.data(), n);
+			MyDB_PredicateKernels::notBits(other.data(), n);
+			MyDB_PredicateKernels::orBits(other.data(), both.data(), n);
+			vector <uint32_t> sel(n);
+			sel.resize(MyDB_PredicateKernels::toSelection(other.data(), n, sel.data()));
+			size_t numExpected = 0;
+			for (size_t i = 0; i < n; i++)
+				numExpected += !(doubles[i] < 25.0) || (ints[i] > 0 && doubles[i] < 25.0);
+			if (sel.size() != numExpected || MyDB_PredicateKernels::countBits(other.data(), n) != numExpected)
+				allMatch = false;
+			MyDB_PredicateKernels::fromSelection(sel.data(), sel.size(), n, both.data());
+			if (both != other)
+				allMatch = false;
+
+			// now, run whole predicates over the supplier table
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr temp = supplierTable.getEmptyRecord();
+			MyDB_SchemaPtr mySchema = temp->getSchema();
+
+			vector <MyDB_RecordBatchPtr> batches;
+			MyDB_RecordIteratorAltPtr myIter = supplierTable.getIteratorAlt();
+			while (true) {
+				batches.push_back(make_shared <MyDB_RecordBatch>(mySchema));
+				if (!myIter->getNextBatch(*batches.back())) {
+					batches.pop_back();
+					break;
+				}
+			}
+			cout << endl;
+
+			vector <vector <string>> allCNFs = {
+				{"> ([acctbal], double[1000.0])", "< ([acctbal], double[5000.0])"},
+				{"> ([suppkey], int[100])", "< ([suppkey], int[9000])", "|| (== ([nationkey], int[3]), == ([nationkey], int[7]))"},
+				{"!= ([nationkey], int[4])", "! (< ([acctbal], int[0]))", "< (int[5000], [suppkey])"},
+				{"< (int[50], [suppkey])", "> ([phone], string[20])"},
+				{"&& (> ([acctbal], double[0.0]), < ([nationkey], int[10]))", "== ([suppkey], double[3.0])"},
+				{"bool[true]"}};
+			vector <size_t> numClauses = {1, 2, 3, 2, 2, 1};
+			vector <size_t> numKernelClauses = {1, 2, 3, 1, 1, 0};
+
+			for (size_t c = 0; c < allCNFs.size(); c++) {
+				vector <string> &cnf = allCNFs[c];
+				MyDB_BatchPredicate pred(mySchema, cnf);
+				vector <func> lambdas;
+				for (string &clause : cnf)
+					lambdas.push_back(temp->compileComputation(clause));
+				if (pred.getNumClauses() != numClauses[c] || pred.getNumKernelClauses() != numKernelClauses[c])
+					allMatch = false;
+
+				// make sure that we get the same answers
+				for (MyDB_RecordBatchPtr batch : batches) {
+					vector <uint32_t> selection;
+					pred.filter(*batch, selection);
+					size_t next = 0;
+					for (size_t i = 0; i < batch->size(); i++) {
+						batch->getRecord(i, temp);
+						bool res = true;
+						for (func &f : lambdas)
+							res = res && f()->toBool();
+						bool selected = next < selection.size() && selection[next] == i;
+						if (selected)
+							next++;
+						if (selected != res)
+							allMatch = false;
+					}
+				}
+
+				// and time them; for the lambdas, we take out the time needed to just load the records
+				size_t lambdaCount = 0;
+				clock_t t1 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (MyDB_RecordBatchPtr batch : batches) {
+						for (size_t j = 0; j < batch->size(); j++)
+							batch->getRecord(j, temp);
+					}
+				}
+				clock_t t2 = clock();
+				for (int i = 0; i < 50; i++) {
+					for (MyDB_RecordBatchPtr batch : batches) {
+						for (size_t j = 0; j < batch->size(); j++) {
+							batch->getRecord(j, temp);
+							bool res = true;
+							for (func &f : lambdas)
+								res = res && f()->toBool();
+							lambdaCount += res;
+						}
+					}
+				}
+				clock_t t3 = clock();
+				cout << "\t" << cnf[0].substr(0, 40) << "...\n\t\tlambdas: " << (double) ((t3 - t2) - (t2 - t1)) / CLOCKS_PER_SEC << "s";
+				for (int level = 0; level <= (int) MyDB_PredicateKernels::getBestLevel(); level++) {
+					MyDB_PredicateKernels::setLevel((MyDB_KernelLevel) level);
+					size_t kernelCount = 0;
+					vector <uint32_t> selection;
+					clock_t t4 = clock();
+					for (int i = 0; i < 50; i++) {
+						for (MyDB_RecordBatchPtr batch : batches) {
+							pred.filter(*batch, selection);
+							kernelCount += selection.size();
+						}
+					}
+					clock_t t5 = clock();
+					if (kernelCount != lambdaCount)
+						allMatch = false;
+					cout << ", " << MyDB_PredicateKernels::getLevelName((MyDB_KernelLevel) level) << ": "
+						<< (double) (t5 - t4) / CLOCKS_PER_SEC << "s";
+				}
+				cout << "\n" << flush;
+				MyDB_PredicateKernels::setLevel(MyDB_PredicateKernels::getBestLevel());
+			}
+			cout << "shutdown manager..." << flush;
+		}
+		if (allMatch) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(allMatch);
+	}
+	FALLTHROUGH_INTENDED;
+	case 15:
+	{
+		// multi-key comparators, vs. checking the order by hand and vs. putting together single-key ones
+		cout << "TEST 15..." << flush;
+		initialize();
+		bool allMatch = true;
+		{
+			cout << "create manager..." << flush;
+			MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog>("catFile");
+			map <string, MyDB_TablePtr> allTables = MyDB_Table::getAllTables(myCatalog);
+			MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager>(1024, 16, "tempFile");
+			MyDB_TableReaderWriter supplierTable(allTables["supplier"], myMgr);
+			MyDB_RecordPtr lhs = supplierTable.getEmptyRecord();
+			MyDB_RecordPtr rhs = supplierTable.getEmptyRecord();
+			MyDB_SchemaPtr mySchema = lhs->getSchema();
+			int nationAtt = mySchema->getAttByName("nationkey").first;
+			int balAtt = mySchema->getAttByName("acctbal").first;
+			int nameAtt = mySchema->getAttByName("name").first;
+
+			cout << "load records..." << flush;
+			vector <vector <char>> storage;
+			MyDB_RecordIteratorPtr myIter = supplierTable.getIterator(lhs);
+			while (myIter->hasNext()) {
+				myIter->getNext();
+				storage.push_back(vector <char>(lhs->getBinarySize()));
+				lhs->toBinary(storage.back().data());
+			}
+			vector <void *> positions;
+			for (auto &rec : storage)
+				positions.push_back(rec.data());
+
+			// nationkey descending, then acctbal ascending, then name
+			cout << "sort..." << flush;
+			function <bool ()> comp = buildRecordComparator(lhs, rhs, {{"[nationkey]", false}, {"[acctbal]", true}, {"[name]", true}});
+			function <int ()> compare = buildRecordCompare(lhs, rhs, {{"[nationkey]", false}, {"[acctbal]", true}, {"[name]", true}});
+			auto sortWith = [&] (function <bool ()> &withMe) {
+				std::sort(positions.begin(), positions.end(), [&] (void *l, void *r) {
+					lhs->fromBinary(l);
+					rhs->fromBinary(r);
+					return withMe();
+				});
+			};
+			sortWith(comp);
+			for (size_t i = 0; i + 1 < positions.size(); i++) {
+				lhs->fromBinary(positions[i]);
+				rhs->fromBinary(positions[i + 1]);
+				int64_t ln = lhs->getValue(nationAtt).intVal, rn = rhs->getValue(nationAtt).intVal;
+				double lb = lhs->getValue(balAtt).doubleVal, rb = rhs->getValue(balAtt).doubleVal;
+				int names = lhs->getValue(nameAtt).compareString(rhs->getValue(nameAtt));
+				bool ordered = ln > rn || (ln == rn && (lb < rb || (lb == rb && names <= 0)));
+				int expected = (ln == rn && lb == rb && names == 0) ? 0 : -1;
+				int res = compare();
+				if (!ordered || (res < 0) != (expected < 0) || (res == 0) != (expected == 0))
+					allMatch = false;
+				rhs->fromBinary(positions[i]);
+				if (compare() != 0)
+					allMatch = false;
+			}
+
+			// a computation that is NaN when nationkey is 3 (and 0 otherwise) puts those records first or
+			// last, whichever way the key goes
+			string nanKey = "/ (- ([acctbal], [acctbal]), - ([nationkey], int[3]))";
+			for (int t = 0; t < 4; t++) {
+				bool ascending = (t & 1), nullsFirst = (t & 2);
+				function <bool ()> nanComp = buildRecordComparator(lhs, rhs, {{nanKey, ascending, nullsFirst}, {"[suppkey]", true}});
+				sortWith(nanComp);
+				size_t numThrees = 0;
+				for (size_t i = 0; i < positions.size(); i++) {
+					lhs->fromBinary(positions[i]);
+					numThrees += (lhs->getValue(nationAtt).intVal == 3);
+				}
+				for (size_t i = 0; i < positions.size(); i++) {
+					lhs->fromBinary(positions[i]);
+					bool isThree = (lhs->getValue(nationAtt).intVal == 3);
+					bool shouldBe = nullsFirst ? i < numThrees : i >= positions.size() - numThrees;
+					if (isThree != shouldBe)
+						allMatch = false;
+				}
+				if (numThrees == 0)
+					allMatch = false;
+			}
+
+			// and time it against the same order built out of single-key comparators
+			cout << endl;
+			function <bool ()> natGT = buildRecordComparator(rhs, lhs, "[nationkey]");
+			function <bool ()> natLT = buildRecordComparator(lhs, rhs, "[nationkey]");
+			function <bool ()> balLT = buildRecordComparator(lhs, rhs, "[acctbal]");
+			function <bool ()> balGT = buildRecordComparator(rhs, lhs, "[acctbal]");
+			function <bool ()> nameLT = buildRecordComparator(lhs, rhs, "[name]");
+			function <bool ()> nested = [&] {
+				if (natGT()) return true;
+				if (natLT()) return false;
+				if (balLT()) return true;
+				if (balGT()) return false;
+				return nameLT();
+			};
+			vector <void *> original = positions;
+			clock_t t1 = clock();
+			for (int i = 0; i < 5; i++) {
+				positions = original;
+				sortWith(nested);
+			}
+			vector <void *> nestedOrder = positions;
+			clock_t t2 = clock();
+			for (int i = 0; i < 5; i++) {
+				positions = original;
+				sortWith(comp);
+			}
+			clock_t t3 = clock();
+			for (size_t i = 0; i < positions.size(); i++) {
+				lhs->fromBinary(positions[i]);
+				rhs->fromBinary(nestedOrder[i]);
+				if (compare() != 0)
+					allMatch = false;
+			}
+			cout << "\tsorting " << positions.size() << " records: nested " << (double) (t2 - t1) / CLOCKS_PER_SEC
+				<< "s, multi-key " << (double) (t3 - t2) / CLOCKS_PER_SEC << "s\n" << flush;
+			cout << "shutdown manager..." << flush;
+		}
+		if (allMatch) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_TRUE(allMatch);
+	}
+	FALLTHROUGH_INTENDED;
+	case 16:
+	{
+		// computations over a record built out of two others see the changes made to the other two
+		cout << "TEST 16..." << flush;
+		string result = "";
+		{
+			MyDB_SchemaPtr leftSchema = make_shared <MyDB_Schema>();
+			leftSchema->appendAtt(make_pair("a", make_shared <MyDB_IntAttType>()));
+			MyDB_SchemaPtr rightSchema = make_shared <MyDB_Schema>();
+			rightSchema->appendAtt(make_pair("b", make_shared <MyDB_IntAttType>()));
+			MyDB_SchemaPtr bothSchema = make_shared <MyDB_Schema>();
+			bothSchema->appendAtt(make_pair("a", make_shared <MyDB_IntAttType>()));
+			bothSchema->appendAtt(make_pair("b", make_shared <MyDB_IntAttType>()));
+			MyDB_RecordPtr l = make_shared <MyDB_Record>(leftSchema);
+			MyDB_RecordPtr r = make_shared <MyDB_Record>(rightSchema);
+			MyDB_RecordPtr c = make_shared <MyDB_Record>(bothSchema);
+
+			char ten[64];
+			l->fromString("10|");
+			l->toBinary(ten);
+			l->fromString("1|");
+			r->fromString("2|");
+			c->buildFrom(l, r);
+			func sum = c->compileComputation("+ ([a], [b])");
+			func justA = l->compileComputation("[a]");
+
+			stringstream ss;
+			ss << sum()->toInt() << "|";
+			l->fromBinary(ten);
+			ss << sum()->toInt() << "|";
+			r->getAtt(0)->fromInt(5);
+			ss << sum()->toInt() << "|" << justA()->toInt() << "|";
+			l->getAtt(0)->fromInt(7);
+			ss << sum()->toInt() << "|" << justA()->toInt();
+			result = ss.str();
+		}
+		const string answer = "3|12|15|10|12|7";
+		if (result == answer) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+		QUNIT_IS_EQUAL(result, answer);
+	}
+	FALLTHROUGH_INTENDED;
 	default:
 		break;
 	}
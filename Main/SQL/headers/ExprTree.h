@@ -3,6 +3,8 @@
 #define SQL_EXPRESSIONS
 
 #include "MyDB_AttType.h"
+#include "MyDB_BatchPredicate.h"
+#include "MyDB_ByteCode.h"
 #include <string>
 #include <vector>
 #include <MyDB_Catalog.h>
@@ -212,7 +214,6 @@ public:
 	}
 
 	string toString () {
-        cout<< "MinusOp is validating..." <<endl;
 		return "- (" + lhs->toString () + ", " + rhs->toString () + ")";
 	}	
 
@@ -669,4 +670,20 @@ public:
     }
 };
 
+// compiles an expression into bytecode that runs over the given record.  toString () produces
+// exactly the syntax that MyDB_ByteCode accepts, so the record's schema just needs to name its
+// attributes the way that toString () does (that is, [tableAlias_attName])
+inline MyDB_ByteCodePtr compileExprTree (ExprTreePtr compileMe, MyDB_RecordPtr overMe) {
+	return make_shared <MyDB_ByteCode> (overMe, compileMe->toString ());
+}
+
+// compiles a list of disjunctions that are all and-ed together (such as SFWQuery's allDisjunctions)
+// into a predicate that is run over batches of records with the given schema
+inline MyDB_BatchPredicatePtr compileCNF (vector <ExprTreePtr> &allDisjunctions, MyDB_SchemaPtr overMe) {
+	vector <string> clauses;
+	for (auto &disjunction : allDisjunctions)
+		clauses.push_back (disjunction->toString ());
+	return make_shared <MyDB_BatchPredicate> (overMe, clauses);
+}
+
 #endif
@@ -22,6 +22,10 @@ struct Value;
 // in a GROUP BY or a SELECT clause
 struct ValueList;
 
+// an "OrderList" is a list of values to sort on, each ascending or descending... used to hold
+// everything in an ORDER BY clause
+struct OrderList;
+
 // a "CNF" is a list of boolean clauses
 struct CNF;
 
@@ -50,6 +54,10 @@ struct SFWQuery *makeQueryWithGroupBy (struct ValueList *selectClause, struct Fr
 struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fromClause, struct CNF *cnf);
 struct SFWQuery *makeQueryNoWhere (struct ValueList *selectClause, struct FromList *fromClause);
 
+// adds an ORDER BY or a LIMIT to a select query
+struct SFWQuery *addOrderBy (struct SFWQuery *toMe, struct OrderList *orderBy);
+struct SFWQuery *addLimit (struct SFWQuery *toMe, int limit);
+
 // builds an SQL statement out of a select query
 struct SQLStatement *makeSelectQuery (struct SFWQuery *fromMe);
 
@@ -109,6 +117,12 @@ struct ValueList *pushBackValue (struct ValueList *addToMe, struct Value *addMe)
 // makes a new value list from a value
 struct ValueList *makeValueList (struct Value *addMe);
 
+// makes a new order list from a value (sorted ascending if ascending is not zero)
+struct OrderList *makeOrderList (struct Value *addMe, int ascending);
+
+// this adds a new value to an order list
+struct OrderList *pushBackOrder (struct OrderList *addToMe, struct Value *addMe, int ascending);
+
 // makes a new CNF from a expression (hopefully a boolean!!)
 struct CNF *makeCNF (struct Value *fromMe);
 
@@ -39,6 +39,7 @@ public:
 	
 	friend struct CNF;
 	friend struct ValueList;
+	friend struct OrderList;
 	friend struct SFWQuery;
 	#include "FriendDecls.h"
 };
@@ -85,6 +86,27 @@ public:
 	#include "FriendDecls.h"
 };
 
+// structure that encapsulates a parsed ORDER BY list: each value is paired with true if it is
+// sorted ascending, and false if it is sorted descending
+struct OrderList {
+
+private:
+
+        vector <pair <ExprTreePtr, bool>> valuesToSortOn;
+
+public:
+        ~OrderList () {}
+
+        OrderList (struct Value *useMe, bool ascending) {
+              	valuesToSortOn.push_back (make_pair (useMe->myVal, ascending)); 
+        }
+
+        OrderList () {}
+
+	friend struct SFWQuery;
+	#include "FriendDecls.h"
+};
+
 
 // structure to encapsulate a create table
 struct CreateTable {
@@ -203,6 +225,10 @@ private:
 	vector <ExprTreePtr> allDisjunctions;
 	vector <ExprTreePtr> groupingClauses;
 
+	// the ORDER BY (each paired with true if it is ascending) and the LIMIT (-1 if there is none)
+	vector <pair <ExprTreePtr, bool>> orderingClauses;
+	int limit = -1;
+
 public:
 	SFWQuery () {}
 
@@ -246,6 +272,15 @@ public:
 		for (auto a : groupingClauses) {
 			cout << "\t" << a->toString () << "\n";
 		}
+		if (!orderingClauses.empty ()) {
+			cout << "Order by:\n";
+			for (auto a : orderingClauses) {
+				cout << "\t" << a.first->toString () << (a.second ? " ASC" : " DESC") << "\n";
+			}
+		}
+		if (limit >= 0) {
+			cout << "Limit to " << limit << " records\n";
+		}
 	}
 
     bool tableInCatalog(string tableName, MyDB_CatalogPtr mycatalog){
@@ -316,6 +351,21 @@ public:
 
 		}
 
+		//validate ordering
+		cout<<"validating order...."<<orderingClauses.size()<<" clauses"<<endl;
+		for(auto order:orderingClauses){
+			if(!order.first->validateTree(mycatalog)){
+				cout<<"Error: Order By Clause is not valid"<<endl;
+				res = false;
+				break;
+			}
+			if(order.first->checkType(mycatalog).compare("none") == 0) {
+				cout << "Type Error: Order By Type is not valid." << endl;
+				res = false;
+				break;
+			}
+		}
+
 		//check select clause
 		if(groupingClauses.size()!=0)
 		{
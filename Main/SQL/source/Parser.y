@@ -18,6 +18,7 @@
 	struct AttList *myAttList;
 	struct Value *myValue;
 	struct ValueList *allValues;
+	struct OrderList *myOrderList;
 	struct CNF *myCNF;	
 	int myInt;
 	char *myChar;
@@ -44,6 +45,10 @@
 %token SUM
 %token AVG
 %token GROUP
+%token ORDER
+%token LIMIT
+%token ASC
+%token DESC
 %token INT
 %token BOOL
 %token BPLUSTREE
@@ -60,12 +65,14 @@
 %type <myValue> Disjunction
 %type <myValue> Comparison
 %type <allValues> ValueList
+%type <myOrderList> OrderList
 %type <myStatement> SQLStatement
 %type <myCreateTable> CreateTable
 %type <myAttList> AttList
 %type <myAttList> Att
 %type <myFromList> FromList
 %type <mySelectQuery> SelectQuery 
+%type <mySelectQuery> SFWQuery 
 
 %start SQLStatement
 
@@ -135,9 +142,30 @@ Att : IDENTIFIER INT
 	$$ = makeAttList ($1, BOOL);
 }
 
-//********* SELECT-FROM-WHERE Query
+//********* SELECT-FROM-WHERE Query, with an optional ORDER BY and LIMIT
 
-SelectQuery: SELECT ValueList
+SelectQuery: SFWQuery
+{
+	$$ = $1;
+}
+
+| SFWQuery ORDER BY OrderList
+{
+	$$ = addOrderBy ($1, $4);
+}
+
+| SFWQuery LIMIT INTEGER
+{
+	$$ = addLimit ($1, $3);
+}
+
+| SFWQuery ORDER BY OrderList LIMIT INTEGER
+{
+	$$ = addLimit (addOrderBy ($1, $4), $6);
+}
+;
+
+SFWQuery: SELECT ValueList
              FROM FromList
 	     WHERE CNF
 	     GROUP BY ValueList
@@ -159,6 +187,37 @@ SelectQuery: SELECT ValueList
 }
 ;
 
+OrderList: OrderList ',' Value
+{
+	$$ = pushBackOrder ($1, $3, 1);
+}
+
+| OrderList ',' Value ASC
+{
+	$$ = pushBackOrder ($1, $3, 1);
+}
+
+| OrderList ',' Value DESC
+{
+	$$ = pushBackOrder ($1, $3, 0);
+}
+
+| Value
+{
+	$$ = makeOrderList ($1, 1);
+}
+
+| Value ASC
+{
+	$$ = makeOrderList ($1, 1);
+}
+
+| Value DESC
+{
+	$$ = makeOrderList ($1, 0);
+}
+;
+
 FromList: IDENTIFIER AS IDENTIFIER ',' FromList
 {
 	$$ = appendFromList ($5, $1, $3);
@@ -67,6 +67,18 @@ struct ValueList *pushBackValue (struct ValueList *ontoMe, struct Value *withMe)
 	return ontoMe;
 }
 
+struct OrderList *makeOrderList (struct Value *fromMe, int ascending) {
+	auto returnVal = new OrderList (fromMe, ascending != 0);
+	delete fromMe;
+	return returnVal;
+}
+
+struct OrderList *pushBackOrder (struct OrderList *ontoMe, struct Value *withMe, int ascending) {
+	ontoMe->valuesToSortOn.push_back (make_pair (withMe->myVal, ascending != 0));
+	delete withMe;
+	return ontoMe;
+}
+
 struct CNF *pushBackDisjunction (struct CNF *ontoMe, struct Value *withMe) {
 	ontoMe->disjunctions.push_back (withMe->myVal);
 	delete withMe;
@@ -207,6 +219,17 @@ struct SFWQuery *makeQuery (struct ValueList *selectClause, struct FromList *fro
 	return returnVal;
 }
 
+struct SFWQuery *addOrderBy (struct SFWQuery *toMe, struct OrderList *orderBy) {
+	toMe->orderingClauses = orderBy->valuesToSortOn;
+	delete orderBy;
+	return toMe;
+}
+
+struct SFWQuery *addLimit (struct SFWQuery *toMe, int limit) {
+	toMe->limit = limit;
+	return toMe;
+}
+
 struct CreateTable *makeTableRegular (char *tableName, struct AttList *fromMe) {
 	auto returnVal = new CreateTable (string (tableName), fromMe->atts);
 	free (tableName);
@@ -11,9 +11,13 @@
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Schema.h"
+#include "LoserTree.h"
 #include "QUnit.h"
 #include "Sorting.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <time.h>
 
 int main () {
 
@@ -148,6 +152,458 @@ int main () {
 		outTable->putInCatalog (myCatalog);
 	}
 
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSorted"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+
+		// sort using a normalized key
+		MyDB_TablePtr keyTable = make_shared <MyDB_Table> ("supplierKeySorted", "supplierKeySorted.bin", mySchema);
+		MyDB_TableReaderWriter keySortedTable (keyTable, myMgr);
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+		clock_t start = clock ();
+		sort (64, supplierTable, keySortedTable, key);
+		cout << "sort using a normalized key: " << (double) (clock () - start) / CLOCKS_PER_SEC << "s\n";
+
+		// we should get the same order as with the comparator
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+		MyDB_RecordIteratorAltPtr myIterOne = keySortedTable.getIteratorAlt ();
+		MyDB_RecordIteratorAltPtr myIterTwo = sortedTable.getIteratorAlt ();
+		int matches = 0;
+		while (myIterOne->advance ()) {
+			myIterTwo->advance ();
+			myIterOne->getCurrent (rec1);
+			myIterTwo->getCurrent (rec2);
+			if (rec1->getAtt (5)->toDouble () == rec2->getAtt (5)->toDouble ())
+				matches++;
+		}
+		QUNIT_IS_EQUAL (matches, 320000);
+
+		// and now sort on several attributes, some of them descending
+		MyDB_TablePtr multiTable = make_shared <MyDB_Table> ("supplierMultiSorted", "supplierMultiSorted.bin", mySchema);
+		MyDB_TableReaderWriter multiSortedTable (multiTable, myMgr);
+		MyDB_SortKeyPtr multiKey = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> 
+			{{"nationkey", true}, {"name", false}, {"acctbal", false}});
+		sort (16, supplierTable, multiSortedTable, multiKey);
+
+		int counter = 0, inOrder = 0;
+		myIterOne = multiSortedTable.getIteratorAlt ();
+		while (myIterOne->advance ()) {
+			myIterOne->getCurrent (rec1);
+			if (counter > 0) {
+				int nation1 = rec2->getAtt (3)->toInt (), nation2 = rec1->getAtt (3)->toInt ();
+				string name1 = rec2->getAtt (1)->toString (), name2 = rec1->getAtt (1)->toString ();
+				double bal1 = rec2->getAtt (5)->toDouble (), bal2 = rec1->getAtt (5)->toDouble ();
+				if (nation1 < nation2 || (nation1 == nation2 && (name1 > name2 || (name1 == name2 && bal1 >= bal2))))
+					inOrder++;
+			}
+			myIterOne->getCurrent (rec2);
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 320000);
+		QUNIT_IS_EQUAL (inOrder, 319999);
+	}
+
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+
+		// sort the table with the radix sort and with std :: sort, on a double, on an int, and on a
+		// string (where lots of the prefixes tie), and make sure that we get the same order
+		vector <pair <string, int>> sortOn {{"acctbal", 5}, {"suppkey", 0}, {"name", 1}};
+		for (auto &att : sortOn) {
+			MyDB_SortKeyPtr radixKey = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{att.first, true}});
+			MyDB_SortKeyPtr stdKey = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{att.first, true}});
+			stdKey->setRadixSort (false);
+
+			MyDB_TableReaderWriter radixTable (make_shared <MyDB_Table> ("radix" + att.first, "radix" + att.first + ".bin", mySchema), myMgr);
+			MyDB_TableReaderWriter stdTable (make_shared <MyDB_Table> ("std" + att.first, "std" + att.first + ".bin", mySchema), myMgr);
+			clock_t start = clock ();
+			sort (64, supplierTable, radixTable, radixKey);
+			double radixTime = (double) (clock () - start) / CLOCKS_PER_SEC;
+			start = clock ();
+			sort (64, supplierTable, stdTable, stdKey);
+			double stdTime = (double) (clock () - start) / CLOCKS_PER_SEC;
+			cout << "sort on " << att.first << ": radix " << radixTime << "s, std :: sort " << stdTime << "s\n";
+
+			int counter = 0, matches = 0;
+			MyDB_RecordIteratorAltPtr myIterOne = radixTable.getIteratorAlt ();
+			MyDB_RecordIteratorAltPtr myIterTwo = stdTable.getIteratorAlt ();
+			while (myIterOne->advance () && myIterTwo->advance ()) {
+				myIterOne->getCurrent (rec1);
+				myIterTwo->getCurrent (rec2);
+				if (rec1->getAtt (att.second)->toString () == rec2->getAtt (att.second)->toString ())
+					matches++;
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, 320000);
+			QUNIT_IS_EQUAL (matches, 320000);
+		}
+	}
+
+	{
+		// merge lists of numbers using a loser tree, with different numbers of lists (some of
+		// them empty), and make sure that everything comes out in order
+		int inOrder = 0, total = 0, expected = 0;
+		for (size_t numRuns = 1; numRuns <= 9; numRuns++) {
+			vector <vector <int>> runs (numRuns);
+			for (size_t i = 0; i < numRuns; i++) {
+				for (size_t j = 0; j < (i * 7) % 5 * 10; j++)
+					runs[i].push_back ((j * 37 + i * 11) % 100);
+				std :: sort (runs[i].begin (), runs[i].end ());
+				expected += runs[i].size ();
+			}
+			vector <size_t> pos (numRuns, 0);
+			auto lessThan = [&] (size_t i, size_t j) {
+				if (pos[i] == runs[i].size () || pos[j] == runs[j].size ())
+					return pos[i] != runs[i].size ();
+				return runs[i][pos[i]] < runs[j][pos[j]];
+			};
+			LoserTree <decltype (lessThan)> tree (numRuns, lessThan);
+			int last = -1;
+			while (pos[tree.top ()] != runs[tree.top ()].size ()) {
+				int next = runs[tree.top ()][pos[tree.top ()]++];
+				inOrder += (next >= last);
+				last = next;
+				total++;
+				tree.replay ();
+			}
+		}
+		QUNIT_IS_EQUAL (total, expected);
+		QUNIT_IS_EQUAL (inOrder, expected);
+	}
+
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSorted"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+
+		// sort using four threads; this should match the sort using the comparator
+		MyDB_TableReaderWriter parallelTable (make_shared <MyDB_Table> ("supplierParallel", "supplierParallel.bin", mySchema), myMgr);
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+		auto start = chrono :: steady_clock :: now ();
+		sort (16, supplierTable, parallelTable, key, 4);
+		cout << "sort using four threads: " << chrono :: duration <double> (chrono :: steady_clock :: now () - start).count () << "s\n";
+
+		int counter = 0, matches = 0;
+		MyDB_RecordIteratorAltPtr myIterOne = parallelTable.getIteratorAlt ();
+		MyDB_RecordIteratorAltPtr myIterTwo = sortedTable.getIteratorAlt ();
+		while (myIterOne->advance () && myIterTwo->advance ()) {
+			myIterOne->getCurrent (rec1);
+			myIterTwo->getCurrent (rec2);
+			if (rec1->getAtt (5)->toDouble () == rec2->getAtt (5)->toDouble ())
+				matches++;
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 320000);
+		QUNIT_IS_EQUAL (matches, 320000);
+
+		// each thread writes its part straight into the table, so only a thread's last pages can be
+		// partly empty; and records appended after the sort go at the end
+		QUNIT_IS_TRUE (parallelTable.getNumPages () <= sortedTable.getNumPages () + 4);
+		MyDB_RecordIteratorAltPtr lastIter = sortedTable.getIteratorAlt (0, 0);
+		lastIter->advance ();
+		lastIter->getCurrent (rec2);
+		parallelTable.append (rec2);
+		counter = 0;
+		myIterOne = parallelTable.getIteratorAlt ();
+		while (myIterOne->advance ()) {
+			myIterOne->getCurrent (rec1);
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 320001);
+		QUNIT_IS_EQUAL (rec1->getAtt (5)->toDouble (), rec2->getAtt (5)->toDouble ());
+
+		// and on several attributes, with a lot of threads, so that some of the threads get nothing
+		MyDB_TableReaderWriter multiTable (make_shared <MyDB_Table> ("supplierParallelMulti", "supplierParallelMulti.bin", mySchema), myMgr);
+		MyDB_SortKeyPtr multiKey = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> 
+			{{"nationkey", true}, {"name", false}, {"acctbal", false}});
+		sort (8, supplierTable, multiTable, multiKey, 64);
+
+		// the records are checked using the key, holding on to a copy of the last one
+		int inOrder = 0;
+		counter = 0;
+		string lastRec;
+		myIterOne = multiTable.getIteratorAlt ();
+		while (myIterOne->advance ()) {
+			if (counter > 0 && multiKey->compare (&lastRec[0], myIterOne->getCurrentPointer ()) <= 0)
+				inOrder++;
+			char *bytes = (char *) myIterOne->getCurrentPointer ();
+			lastRec.assign (bytes, *((short *) bytes));
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 320000);
+		QUNIT_IS_EQUAL (inOrder, 319999);
+	}
+
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSorted"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+
+		// replacement selection should give runs that are bigger than the memory (about twice as many
+		// records as it can hold, but the memory also has to pay for the keys and the bookkeeping)
+		vector <vector <MyDB_PageReaderWriter>> runs = makeRuns (supplierTable, key, 16);
+		size_t numPages = 0;
+		for (auto &run : runs)
+			numPages += run.size ();
+		cout << "replacement selection with 13 pages of memory: " << runs.size () << " runs, " 
+			<< numPages / (double) runs.size () << " pages each\n";
+		QUNIT_IS_TRUE (numPages / (double) runs.size () > 13.0);
+
+		// and on sorted input, there should be only one run
+		runs = makeRuns (sortedTable, key, 16);
+		QUNIT_IS_EQUAL (runs.size (), 1);
+		runs.clear ();
+
+		// now sort with so little memory that the merge needs more than one pass
+		for (int numFrames : {4, 32}) {
+			MyDB_TableReaderWriter budgetTable (make_shared <MyDB_Table> ("supplierBudget" + to_string (numFrames), 
+				"supplierBudget" + to_string (numFrames) + ".bin", mySchema), myMgr);
+			sort (supplierTable, budgetTable, key, numFrames);
+
+			MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+			MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+			int counter = 0, matches = 0;
+			MyDB_RecordIteratorAltPtr myIterOne = budgetTable.getIteratorAlt ();
+			MyDB_RecordIteratorAltPtr myIterTwo = sortedTable.getIteratorAlt ();
+			while (myIterOne->advance () && myIterTwo->advance ()) {
+				myIterOne->getCurrent (rec1);
+				myIterTwo->getCurrent (rec2);
+				if (rec1->getAtt (5)->toDouble () == rec2->getAtt (5)->toDouble ())
+					matches++;
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, 320000);
+			QUNIT_IS_EQUAL (matches, 320000);
+		}
+	}
+
+	{
+		// with a small buffer, a sort has to stay within its frames, counting the pages that it reads
+		// ahead and the ones that it is writing back in the background; copy 10000 records into a table
+		// with small pages, so that there are lots of runs to merge
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_BufferManagerPtr bigMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (2048, 16, "tempFileSmall");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], bigMgr);
+		MyDB_TableReaderWriter tinyTable (make_shared <MyDB_Table> ("supplierTiny", "supplierTiny.bin", mySchema), myMgr);
+		MyDB_RecordIteratorAltPtr myIter = supplierTable.getIteratorAlt ();
+		for (int i = 0; i < 10000 && myIter->advance (); i++)
+			tinyTable.appendBinary (myIter->getCurrentPointer ());
+
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+		for (int numFrames : {4, 8, 16}) {
+			MyDB_TableReaderWriter budgetTable (make_shared <MyDB_Table> ("supplierTiny" + to_string (numFrames), 
+				"supplierTiny" + to_string (numFrames) + ".bin", mySchema), myMgr);
+			sort (tinyTable, budgetTable, key, numFrames);
+
+			int counter = 0, inOrder = 0;
+			string lastRec;
+			myIter = budgetTable.getIteratorAlt ();
+			while (myIter->advance ()) {
+				if (counter > 0 && key->compare (&lastRec[0], myIter->getCurrentPointer ()) <= 0)
+					inOrder++;
+				char *bytes = (char *) myIter->getCurrentPointer ();
+				lastRec.assign (bytes, *((short *) bytes));
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, 10000);
+			QUNIT_IS_EQUAL (inOrder, 9999);
+		}
+	}
+
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSorted"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+
+		// the top 1000 should be the first 1000 records of the sorted table
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+		MyDB_TableReaderWriter topTable (make_shared <MyDB_Table> ("supplierTop", "supplierTop.bin", mySchema), myMgr);
+		auto start = chrono :: steady_clock :: now ();
+		topK (1000, supplierTable.getIteratorAlt (), topTable, key);
+		cout << "top 1000 using a heap: " << chrono :: duration <double> (chrono :: steady_clock :: now () - start).count () << "s\n";
+
+		int counter = 0, matches = 0;
+		MyDB_RecordIteratorAltPtr myIterOne = topTable.getIteratorAlt ();
+		MyDB_RecordIteratorAltPtr myIterTwo = sortedTable.getIteratorAlt ();
+		while (myIterOne->advance () && myIterTwo->advance ()) {
+			myIterOne->getCurrent (rec1);
+			myIterTwo->getCurrent (rec2);
+			if (rec1->getAtt (5)->toDouble () == rec2->getAtt (5)->toDouble ())
+				matches++;
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 1000);
+		QUNIT_IS_EQUAL (matches, 1000);
+
+		// on several attributes, the top 10 should be in order, and the last of them should come
+		// after fewer than 10 records in the table (since there are ties, it can be fewer than 9)
+		// and at or after at least 10 of them
+		MyDB_SortKeyPtr multiKey = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> 
+			{{"nationkey", false}, {"name", true}});
+		MyDB_TableReaderWriter multiTable (make_shared <MyDB_Table> ("supplierTopMulti", "supplierTopMulti.bin", mySchema), myMgr);
+		topK (10, supplierTable.getIteratorAlt (), multiTable, multiKey);
+		int inOrder = 0;
+		counter = 0;
+		string lastRec;
+		myIterOne = multiTable.getIteratorAlt ();
+		while (myIterOne->advance ()) {
+			if (counter > 0 && multiKey->compare (&lastRec[0], myIterOne->getCurrentPointer ()) <= 0)
+				inOrder++;
+			char *bytes = (char *) myIterOne->getCurrentPointer ();
+			lastRec.assign (bytes, *((short *) bytes));
+			counter++;
+		}
+		QUNIT_IS_EQUAL (counter, 10);
+		QUNIT_IS_EQUAL (inOrder, 9);
+
+		int before = 0, atOrBefore = 0;
+		myIterOne = supplierTable.getIteratorAlt ();
+		while (myIterOne->advance ()) {
+			int res = multiKey->compare (myIterOne->getCurrentPointer (), &lastRec[0]);
+			before += (res < 0);
+			atOrBefore += (res <= 0);
+		}
+		QUNIT_IS_TRUE (before < 10);
+		QUNIT_IS_TRUE (atOrBefore >= 10);
+
+		// and asking for nothing gives nothing
+		MyDB_TableReaderWriter emptyTable (make_shared <MyDB_Table> ("supplierTopNone", "supplierTopNone.bin", mySchema), myMgr);
+		topK (0, supplierTable.getIteratorAlt (), emptyTable, key);
+		QUNIT_IS_FALSE (emptyTable.getIteratorAlt ()->advance ());
+	}
+
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_TableReaderWriter sortedTable (allTables["supplierSorted"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+
+		// sort with and without the background I/O; the results should be the same, and the time
+		// spent waiting on the disk is reported
+		for (bool useAsync : {false, true}) {
+			myMgr->setAsyncIO (useAsync);
+			myMgr->resetIOStallTime ();
+			string name = useAsync ? "supplierAsync" : "supplierSync";
+			MyDB_TableReaderWriter outTable (make_shared <MyDB_Table> (name, name + ".bin", mySchema), myMgr);
+			auto start = chrono :: steady_clock :: now ();
+			sort (supplierTable, outTable, key, 32);
+			cout << "sort " << (useAsync ? "with" : "without") << " background I/O: " 
+				<< chrono :: duration <double> (chrono :: steady_clock :: now () - start).count () << "s, "
+				<< myMgr->getIOStallTime () << "s waiting on the disk\n";
+
+			MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+			MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+			int counter = 0, matches = 0;
+			MyDB_RecordIteratorAltPtr myIterOne = outTable.getIteratorAlt ();
+			MyDB_RecordIteratorAltPtr myIterTwo = sortedTable.getIteratorAlt ();
+			while (myIterOne->advance () && myIterTwo->advance ()) {
+				myIterOne->getCurrent (rec1);
+				myIterTwo->getCurrent (rec2);
+				if (rec1->getAtt (5)->toDouble () == rec2->getAtt (5)->toDouble ())
+					matches++;
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, 320000);
+			QUNIT_IS_EQUAL (matches, 320000);
+		}
+
+		// with 16 frames, the merge takes more than one pass, and every pass should read ahead: so each page
+		// of the input, of the final merge, and of the passes before it, is prefetched
+		myMgr->setAsyncIO (true);
+		size_t numPrefetched = myMgr->getNumPrefetched ();
+		MyDB_TableReaderWriter passTable (make_shared <MyDB_Table> ("supplierPasses", "supplierPasses.bin", mySchema), myMgr);
+		sort (supplierTable, passTable, key, 16);
+		QUNIT_IS_TRUE (myMgr->getNumPrefetched () - numPrefetched > 2 * (size_t) supplierTable.getNumPages ());
+	}
+
+	{
+		// load up the table supplier table from the catalog
+		MyDB_CatalogPtr myCatalog = make_shared <MyDB_Catalog> ("catFile");
+		map <string, MyDB_TablePtr> allTables = MyDB_Table :: getAllTables (myCatalog);
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+		MyDB_TableReaderWriter supplierTable (allTables["supplier"], myMgr);
+		MyDB_SchemaPtr mySchema = allTables["supplier"]->getSchema ();
+		MyDB_RecordPtr rec1 = supplierTable.getEmptyRecord ();
+		MyDB_RecordPtr rec2 = supplierTable.getEmptyRecord ();
+
+		// make a table that fits in the buffer
+		MyDB_TableReaderWriter smallTable (make_shared <MyDB_Table> ("supplierSmall", "supplierSmall.bin", mySchema), myMgr);
+		MyDB_RecordIteratorAltPtr myIter = supplierTable.getIteratorAlt (0, 59);
+		int numRecs = 0;
+		while (myIter->advance ()) {
+			smallTable.appendBinary (myIter->getCurrentPointer ());
+			numRecs++;
+		}
+
+		// sort it every which way; all but the last should be done in RAM
+		MyDB_SortKeyPtr key = make_shared <MyDB_SortKey> (mySchema, vector <pair <string, bool>> {{"acctbal", true}});
+		function <bool ()> myComp = buildRecordComparator (rec1, rec2, "[acctbal]");
+		for (int which = 0; which < 4; which++) {
+			string name = "supplierSmall" + to_string (which);
+			MyDB_TableReaderWriter outTable (make_shared <MyDB_Table> (name, name + ".bin", mySchema), myMgr);
+			auto start = chrono :: steady_clock :: now ();
+			if (which == 0)
+				sort (8, smallTable, outTable, myComp, rec1, rec2);
+			else if (which == 1)
+				sort (8, smallTable, outTable, key);
+			else
+				sort (smallTable, outTable, key, which == 2 ? 128 : 16);
+			cout << "sorting 60 pages " << (which == 3 ? "using runs" : "in RAM") << ": " 
+				<< chrono :: duration <double> (chrono :: steady_clock :: now () - start).count () << "s\n";
+
+			int counter = 0, inOrder = 0;
+			double last = 0;
+			MyDB_RecordIteratorAltPtr outIter = outTable.getIteratorAlt ();
+			while (outIter->advance ()) {
+				outIter->getCurrent (rec1);
+				double cur = rec1->getAtt (5)->toDouble ();
+				if (counter > 0 && last <= cur)
+					inOrder++;
+				last = cur;
+				counter++;
+			}
+			QUNIT_IS_EQUAL (counter, numRecs);
+			QUNIT_IS_EQUAL (inOrder, numRecs - 1);
+		}
+	}
+
 	{
 
 		// load up the two tables from the catalog